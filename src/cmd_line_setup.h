@@ -32,6 +32,14 @@ struct CmdLineSetup_t
     std::string testLevel;
     //! Replay file to run
     std::string testReplay;
+    //! Directory of replay files to run in parallel headless workers
+    std::string replayBatchDir;
+    //! Summary output for the replay batch (CSV, or JSON if it ends with .json)
+    std::string replayBatchOutput;
+    //! Number of parallel replay workers (0 = number of CPU cores)
+    int replayBatchJobs = 0;
+    //! Run the spatial table benchmark over the levels at this path (or "synthetic") instead of the game
+    std::string benchTables;
     //! Number of players for level test
     int testNumPlayers = 1;
     //! Save slot to use for world test
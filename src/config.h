@@ -453,6 +453,12 @@ public:
     opt<bool> record_gameplay_data{this, defaults(false), {}, Scope::Config,
         "record-gameplay-data", "Record gameplay", nullptr};
 
+    opt<bool> record_gameplay_binary{this, defaults(false), {}, Scope::Config,
+        "record-gameplay-binary", "Binary recordings", "Write compact, seekable binary gameplay recordings"};
+
+    opt<bool> record_state_hash{this, defaults(false), {}, Scope::Config,
+        "record-state-hash", "State hash stream", "Write a hash of the gameplay state for every frame next to recordings and replays"};
+
     opt_enum<int> log_level{this,
         {
             {PGE_LogLevel::NoLog, "none", "None", nullptr},
@@ -506,6 +512,7 @@ public:
         RENDER_ACCELERATED_OPENGL_ES,
         RENDER_ACCELERATED_OPENGL_LEGACY,
         RENDER_ACCELERATED_OPENGL_ES_LEGACY,
+        RENDER_SOFTWARE_CPU,
         RENDER_END
     };
     setup_enum_t render_mode{this,
@@ -525,6 +532,7 @@ public:
 #ifdef THEXTECH_BUILD_GL_ES_LEGACY
             {RENDER_ACCELERATED_OPENGL_ES_LEGACY, "opengles11", "OpenGL ES 1.1", "Legacy mobile API with full accuracy to SMBX64"},
 #endif
+            {RENDER_SOFTWARE_CPU, "cpu", "CPU", "Built-in rasterizer, same picture on every machine"},
             {RENDER_SOFTWARE, "0"},
             {RENDER_ACCELERATED_SDL, "1"},
         },
@@ -549,6 +557,12 @@ public:
         },
         defaults(SCALE_DOWN_SAFE), {}, Scope::Config,
         "scale-down-textures", "Scale down images", "Store images as 1x to save memory"};
+
+    opt<bool> texture_cache{this, defaults(false), {}, Scope::Config,
+        "texture-cache", "Cache decoded images", "Faster loading, uses disk space"};
+
+    opt<bool> texture_atlas{this, defaults(false), {}, Scope::Config,
+        "texture-atlas", "Pack images together", "Faster drawing, slower loading"};
 #endif
 
 #ifndef PGE_MIN_PORT
@@ -919,6 +933,8 @@ public:
         "new-conveyor-belts", "New conveyor belts", "Update belts to faster and more stable logic"};
     opt<bool> optimize_coins{this, defaults(true), {CompatClass::critical_update, false}, Scope::Creator,
         "optimize-coins", "Optimize coins", "Speed up the game when many coins are onscreen"};
+    opt<bool> extended_effect_limit{this, defaults(true), {CompatClass::critical_update, false}, Scope::Creator,
+        "extended-effect-limit", "Extended effect limit", "Allow more than 1000 effects at once instead of dropping new ones"};
 
     /* ---- Compatibility - Speedrun ----*/
 
@@ -21,6 +21,10 @@
 #include <SDL2/SDL_thread.h>
 #include <SDL2/SDL_power.h>
 #include <SDL2/SDL_rwops.h>
+#ifndef PGE_NO_THREADING
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_cpuinfo.h>
+#endif
 
 #define USE_SDL_POWER
 #ifdef THEXTECH_BIG_ENDIAN
@@ -39,13 +43,27 @@
 #include <Utils/files_ini.h>
 #include <fmt_time_ne.h>
 #include <fmt_format_ne.h>
+#include <md5tools.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <ctime>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <process.h> // _getpid
+#else
+#include <unistd.h> // getpid
+#endif
+#ifndef PGE_NO_THREADING
+#include <deque>
+#include <map>
+#endif
 
 #include "core/base/render_base.h"
 #include "core/render.h"
 
 #include "main/cheat_code.h"
+#include "main/worker_pool.h"
 
 #include "config.h"
 #include "globals.h"
@@ -78,6 +96,10 @@ int    AbstractRender_t::ScaleHeight = 0;
 bool   AbstractRender_t::m_blockRender = false;
 #endif
 
+#ifndef PGE_NO_THREADING
+static void s_decodeQuitThreads();
+#endif
+
 
 #ifdef USE_SCREENSHOTS_AND_RECS
 
@@ -155,6 +177,10 @@ bool AbstractRender_t::init()
 
 void AbstractRender_t::close()
 {
+#ifndef PGE_NO_THREADING
+    s_decodeQuitThreads();
+#endif
+
 #ifdef PGE_ENABLE_VIDEO_REC
     m_gif->quit();
 #endif
@@ -501,12 +527,410 @@ void AbstractRender_t::loadTexture(StdPicture &target, uint32_t width, uint32_t
     loadTextureInternal(target, width, height, RGBApixels, pitch, 0, 0);
 }
 
-void AbstractRender_t::lazyLoad(StdPicture &target)
+//! inputs of the lazy picture decode that are not part of the compressed data
+struct LazyDecodeParams_t
 {
-    if(!target.inited || !target.l.lazyLoaded || target.d.hasTexture())
+    bool     isMaskPng = false;
+    bool     colorKey = false;
+    uint8_t  keyRgb[3] = {0, 0, 0};
+    int      target_w = 0;
+    int      target_h = 0;
+    int      scale_down = Config_t::SCALE_DOWN_NONE;
+    //! merge the mask into the image even when a bitmask is required
+    bool     force_merge = false;
+    bool     depth_test = false;
+    int      max_w = 0;
+    int      max_h = 0;
+    //! look up and store the decoded image at the texture cache (doesn't affect the result)
+    bool     use_cache = false;
+
+    bool operator==(const LazyDecodeParams_t& o) const
+    {
+        return isMaskPng == o.isMaskPng && colorKey == o.colorKey
+            && (!colorKey || (keyRgb[0] == o.keyRgb[0] && keyRgb[1] == o.keyRgb[1] && keyRgb[2] == o.keyRgb[2]))
+            && target_w == o.target_w && target_h == o.target_h
+            && scale_down == o.scale_down && force_merge == o.force_merge
+            && depth_test == o.depth_test && max_w == o.max_w && max_h == o.max_h;
+    }
+};
+
+//! result of the lazy picture decode, ready to be uploaded by the renderer
+struct LazyDecoded_t
+{
+    FIBITMAP *image = nullptr;
+    FIBITMAP *mask = nullptr;
+    uint32_t w = 0;
+    uint32_t h = 0;
+    uint32_t pitch = 0;
+    //! value added to the lazy loaded bytes counter
+    size_t   loaded_bytes = 0;
+    bool     bitmask_required = false;
+    bool     depth_test_invalid = false;
+    RGBQUAD  upperColor = {0, 0, 0, 0};
+    RGBQUAD  lowerColor = {0, 0, 0, 0};
+
+    void close()
+    {
+        if(mask)
+            GraphicsHelps::closeImage(mask);
+        if(image)
+            GraphicsHelps::closeImage(image);
+
+        mask = nullptr;
+        image = nullptr;
+    }
+};
+
+/*
+ * Texture cache: stores the result of the lazy picture decode on disk, so that the next load of the same
+ * picture data with the same decode parameters only has to read the decoded image. Each entry is a file named
+ * by the MD5 of the compressed data and the parameters, holding a header followed by the raw 32-bit image rows
+ * and the mask rows (if any).
+ */
+
+//! bump when the decode or the cache format changes
+static constexpr uint32_t c_textureCacheVersion = 1;
+
+struct TextureCacheHeader_t
+{
+    char     magic[4];
+    //! c_textureCacheVersion in native byte order
+    uint32_t version;
+    uint32_t w;
+    uint32_t h;
+    uint32_t mask_w;
+    uint32_t mask_h;
+    uint32_t loaded_bytes;
+    uint8_t  bitmask_required;
+    uint8_t  depth_test_invalid;
+    uint8_t  reserved[2];
+    RGBQUAD  upperColor;
+    RGBQUAD  lowerColor;
+};
+
+static const char c_textureCacheMagic[4] = {'T', 'X', 'C', 'H'};
+
+//! set at the main thread before any decode uses it
+static std::string s_textureCacheDir;
+static bool s_textureCacheFailed = false;
+
+//! the cache is trimmed (once per run, at its first use) when it grows beyond this size
+static constexpr uint64_t c_textureCacheMaxBytes = 256 * 1024 * 1024;
+//! a trim removes the least recently used entries until the cache fits into this size, so that it isn't trimmed at every run
+static constexpr uint64_t c_textureCacheTrimBytes = c_textureCacheMaxBytes / 4 * 3;
+//! temporary files left by an interrupted write are deleted once they are this old (in seconds)
+static constexpr time_t c_textureCacheStaleTemp = 60 * 60;
+
+struct TextureCacheEntry_t
+{
+    std::string path;
+    uint64_t size;
+    time_t used;
+};
+
+static void s_textureCacheTrim(const std::string &dir)
+{
+    std::vector<std::string> names;
+    DirMan(dir).getListOfFiles(names, {});
+
+    std::vector<TextureCacheEntry_t> entries;
+    uint64_t total = 0;
+    time_t now = std::time(nullptr);
+
+    for(const std::string &name : names)
+    {
+        TextureCacheEntry_t e;
+        e.path = dir + name;
+
+        FILE *f = Files::utf8_fopen(e.path.c_str(), "rb");
+        if(!f)
+            continue;
+
+        struct stat st;
+        bool got_stat = fstat(fileno(f), &st) == 0;
+        fclose(f);
+
+        if(!got_stat)
+            continue;
+
+        if(Files::hasSuffix(name, ".tmp"))
+        {
+            if(now - st.st_mtime > c_textureCacheStaleTemp)
+                Files::deleteFile(e.path);
+
+            continue;
+        }
+
+        // entries are read without being rewritten, so the access time (where the file system keeps it) tells the last use
+        e.size = (uint64_t)st.st_size;
+        e.used = std::max(st.st_atime, st.st_mtime);
+
+        total += e.size;
+        entries.push_back(std::move(e));
+    }
+
+    if(total <= c_textureCacheMaxBytes)
         return;
 
-    FIBITMAP *sourceImage = GraphicsHelps::loadImage(target.l.raw);
+    std::sort(entries.begin(), entries.end(),
+    [](const TextureCacheEntry_t &a, const TextureCacheEntry_t &b)
+    {
+        return a.used < b.used;
+    });
+
+    size_t removed = 0;
+
+    for(const TextureCacheEntry_t &e : entries)
+    {
+        if(total <= c_textureCacheTrimBytes)
+            break;
+
+        // an entry that is open at another instance can't be deleted on some systems, it will be retried at the next run
+        if(Files::deleteFile(e.path))
+        {
+            total -= e.size;
+            removed++;
+        }
+    }
+
+    pLogDebug("Texture cache: removed %d least recently used entries, %d MiB remain", (int)removed, (int)(total / (1024 * 1024)));
+}
+
+static bool s_textureCacheInit()
+{
+    if(!s_textureCacheDir.empty())
+        return true;
+
+    if(s_textureCacheFailed)
+        return false;
+
+    std::string dir = AppPathManager::userAppDirSTD() + "texture-cache/";
+
+    if(!DirMan::exists(dir) && !DirMan::mkAbsPath(dir))
+    {
+        pLogWarning("Texture cache: can't create the directory %s, the cache is disabled", dir.c_str());
+        s_textureCacheFailed = true;
+        return false;
+    }
+
+    s_textureCacheTrim(dir);
+
+    s_textureCacheDir = dir;
+
+    return true;
+}
+
+static std::string s_textureCacheKey(const Files::Data &raw, const Files::Data &rawMask, const LazyDecodeParams_t &p)
+{
+    md5::md5_t hash;
+
+    int32_t params[] =
+    {
+        (int32_t)c_textureCacheVersion,
+        (int32_t)raw.size(),
+        (int32_t)rawMask.size(),
+        p.isMaskPng,
+        p.colorKey,
+        p.colorKey ? p.keyRgb[0] : 0,
+        p.colorKey ? p.keyRgb[1] : 0,
+        p.colorKey ? p.keyRgb[2] : 0,
+        p.target_w,
+        p.target_h,
+        p.scale_down,
+        p.force_merge,
+        p.depth_test,
+        p.max_w,
+        p.max_h,
+    };
+
+    hash.process(params, sizeof(params));
+
+    if(!raw.empty())
+        hash.process(raw.begin(), (unsigned int)raw.size());
+
+    if(!rawMask.empty())
+        hash.process(rawMask.begin(), (unsigned int)rawMask.size());
+
+    hash.finish();
+
+    char str[MD5_STRING_SIZE];
+    hash.get_string(str);
+
+    return s_textureCacheDir + str;
+}
+
+static FIBITMAP *s_textureCacheReadImage(FILE *f, uint32_t w, uint32_t h)
+{
+    if(w == 0 || h == 0)
+        return nullptr;
+
+    FIBITMAP *image = FreeImage_Allocate(int(w), int(h), 32);
+    if(!image)
+        return nullptr;
+
+    uint8_t *bits = reinterpret_cast<uint8_t *>(FreeImage_GetBits(image));
+    uint32_t pitch = FreeImage_GetPitch(image);
+
+    for(uint32_t y = 0; y < h; y++)
+    {
+        if(fread(bits + y * pitch, 4, w, f) != w)
+        {
+            GraphicsHelps::closeImage(image);
+            return nullptr;
+        }
+    }
+
+    return image;
+}
+
+static bool s_textureCacheWriteImage(FILE *f, FIBITMAP *image)
+{
+    uint32_t w = FreeImage_GetWidth(image);
+    uint32_t h = FreeImage_GetHeight(image);
+    uint32_t pitch = FreeImage_GetPitch(image);
+    const uint8_t *bits = reinterpret_cast<const uint8_t *>(FreeImage_GetBits(image));
+
+    for(uint32_t y = 0; y < h; y++)
+    {
+        if(fwrite(bits + y * pitch, 4, w, f) != w)
+            return false;
+    }
+
+    return true;
+}
+
+static bool s_textureCacheLoad(LazyDecoded_t &out, const std::string &path)
+{
+    FILE *f = Files::utf8_fopen(path.c_str(), "rb");
+    if(!f)
+        return false;
+
+    TextureCacheHeader_t head;
+
+    bool valid = fread(&head, sizeof(head), 1, f) == 1
+        && SDL_memcmp(head.magic, c_textureCacheMagic, 4) == 0
+        && head.version == c_textureCacheVersion;
+
+    if(valid)
+    {
+        out.image = s_textureCacheReadImage(f, head.w, head.h);
+
+        if(out.image && head.mask_w)
+        {
+            out.mask = s_textureCacheReadImage(f, head.mask_w, head.mask_h);
+
+            if(!out.mask)
+                out.close();
+        }
+    }
+
+    fclose(f);
+
+    if(!out.image)
+    {
+        pLogWarning("Texture cache: the entry %s is damaged, decoding the picture again", path.c_str());
+        return false;
+    }
+
+    out.w = head.w;
+    out.h = head.h;
+    out.pitch = FreeImage_GetPitch(out.image);
+    out.loaded_bytes = head.loaded_bytes;
+    out.bitmask_required = head.bitmask_required;
+    out.depth_test_invalid = head.depth_test_invalid;
+    out.upperColor = head.upperColor;
+    out.lowerColor = head.lowerColor;
+
+    return true;
+}
+
+static void s_textureCacheSave(const LazyDecoded_t &out, const std::string &path)
+{
+    if(FreeImage_GetBPP(out.image) != 32 || (out.mask && FreeImage_GetBPP(out.mask) != 32))
+        return;
+
+    TextureCacheHeader_t head;
+    SDL_memset(&head, 0, sizeof(head));
+    SDL_memcpy(head.magic, c_textureCacheMagic, 4);
+    head.version = c_textureCacheVersion;
+    head.w = FreeImage_GetWidth(out.image);
+    head.h = FreeImage_GetHeight(out.image);
+    head.mask_w = out.mask ? FreeImage_GetWidth(out.mask) : 0;
+    head.mask_h = out.mask ? FreeImage_GetHeight(out.mask) : 0;
+    head.loaded_bytes = (uint32_t)out.loaded_bytes;
+    head.bitmask_required = out.bitmask_required;
+    head.depth_test_invalid = out.depth_test_invalid;
+    head.upperColor = out.upperColor;
+    head.lowerColor = out.lowerColor;
+
+    // write to a file unique to this process and thread, so that a reader (or a decode of the same data) never sees a partial entry
+#ifdef _WIN32
+    long pid = (long)_getpid();
+#else
+    long pid = (long)getpid();
+#endif
+    std::string temp_path = fmt::format_ne("{0}.{1}-{2}.tmp", path, pid, (unsigned long)SDL_ThreadID());
+
+    FILE *f = Files::utf8_fopen(temp_path.c_str(), "wb");
+    if(!f)
+        return;
+
+    bool ok = fwrite(&head, sizeof(head), 1, f) == 1
+        && s_textureCacheWriteImage(f, out.image)
+        && (!out.mask || s_textureCacheWriteImage(f, out.mask));
+
+    ok &= (fclose(f) == 0);
+
+    if(!ok || !Files::moveFile(path, temp_path, true))
+    {
+        pLogWarning("Texture cache: failed to write the entry %s", path.c_str());
+        Files::deleteFile(temp_path);
+    }
+}
+
+static LazyDecodeParams_t s_lazyDecodeParams(const StdPicture &target, int max_w, int max_h)
+{
+    LazyDecodeParams_t p;
+
+    p.isMaskPng = target.l.isMaskPng;
+    p.colorKey = target.l.colorKey;
+    p.keyRgb[0] = target.l.keyRgb[0];
+    p.keyRgb[1] = target.l.keyRgb[1];
+    p.keyRgb[2] = target.l.keyRgb[2];
+    p.target_w = target.w;
+    p.target_h = target.h;
+    p.scale_down = g_config.scale_down_textures;
+    p.force_merge = g_ForceBitmaskMerge || !g_render->textureMaskSupported();
+    p.depth_test = g_render->depthTestSupported();
+    p.max_w = max_w;
+    p.max_h = max_h;
+    p.use_cache = g_config.texture_cache && s_textureCacheInit();
+
+    return p;
+}
+
+/*!
+ * \brief Decodes the compressed picture data into the RGBA image (and the mask, if it can't be merged)
+ *
+ * Doesn't touch the renderer or any global state, so that it may be called at a decode thread
+ */
+static void s_lazyDecode(LazyDecoded_t &out,
+                         const Files::Data &raw,
+                         const Files::Data &rawMask,
+                         const LazyDecodeParams_t &p,
+                         const std::string &origPath)
+{
+    std::string cachePath;
+
+    if(p.use_cache)
+    {
+        cachePath = s_textureCacheKey(raw, rawMask, p);
+
+        if(s_textureCacheLoad(out, cachePath))
+            return;
+    }
+
+    FIBITMAP *sourceImage = GraphicsHelps::loadImage(raw);
     if(!sourceImage)
     {
         pLogCritical("Lazy-decompress has failed: invalid image data");
@@ -514,25 +938,23 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
     }
 
     FIBITMAP *maskImage = nullptr;
-    if(!target.l.rawMask.empty())
+    if(!rawMask.empty())
     {
         // load mask
-        maskImage = GraphicsHelps::loadMask(target.l.rawMask, target.l.isMaskPng);
+        maskImage = GraphicsHelps::loadMask(rawMask, p.isMaskPng);
 
         if(!maskImage)
-            pLogWarning("lazyLoad: failed to load mask image for texture at address %p [%s]", &target, StdPictureGetOrigPath(target).c_str());
+            pLogWarning("lazyLoad: failed to load mask image for texture [%s]", origPath.c_str());
     }
 
     // check if bitmask required / possible and possibly merge
     if(maskImage)
     {
         // check if bitmask cannot be properly represented with RGBA
-        bool bitmask_required = GraphicsHelps::validateBitmaskRequired(sourceImage, maskImage, StdPictureGetOrigPath(target));
-
-        XRender::g_BitmaskTexturePresent |= bitmask_required;
+        out.bitmask_required = GraphicsHelps::validateBitmaskRequired(sourceImage, maskImage, origPath);
 
         // merge it with image masks are unsupported, merge is forced, or the mask could be properly represented with RGBA
-        if(maskImage && (g_ForceBitmaskMerge || !g_render->textureMaskSupported() || !bitmask_required))
+        if(p.force_merge || !out.bitmask_required)
         {
             GraphicsHelps::mergeWithMask(sourceImage, maskImage);
             GraphicsHelps::closeImage(maskImage);
@@ -546,6 +968,8 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
 
     if((w == 0) || (h == 0))
     {
+        if(maskImage)
+            GraphicsHelps::closeImage(maskImage);
         GraphicsHelps::closeImage(sourceImage);
         pLogWarning("Error lazy-decompressing of image file:\n"
                     "Reason: %s."
@@ -554,32 +978,21 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
         return;
     }
 
-    m_lazyLoadedBytes += (w * h * 4);
-    if(!target.l.rawMask.empty())
-        m_lazyLoadedBytes += (w * h * 4);
+    out.loaded_bytes = (w * h * 4);
+    if(!rawMask.empty())
+        out.loaded_bytes += (w * h * 4);
 
-    RGBQUAD upperColor;
-    FreeImage_GetPixelColor(sourceImage, 0, static_cast<unsigned int>(h - 1), &upperColor);
-    target.ColorUpper.r = upperColor.rgbRed;
-    target.ColorUpper.b = upperColor.rgbBlue;
-    target.ColorUpper.g = upperColor.rgbGreen;
-    target.ColorUpper.a = 255;
+    FreeImage_GetPixelColor(sourceImage, 0, static_cast<unsigned int>(h - 1), &out.upperColor);
+    FreeImage_GetPixelColor(sourceImage, 0, 0, &out.lowerColor);
 
-    RGBQUAD lowerColor;
-    FreeImage_GetPixelColor(sourceImage, 0, 0, &lowerColor);
-    target.ColorLower.r = lowerColor.rgbRed;
-    target.ColorLower.b = lowerColor.rgbBlue;
-    target.ColorLower.g = lowerColor.rgbGreen;
-    target.ColorLower.a = 255;
-
-    if(target.l.colorKey) // Apply transparent color for key pixels
+    if(p.colorKey) // Apply transparent color for key pixels
     {
-        PGE_Pix colSrc = {target.l.keyRgb[0],
-                          target.l.keyRgb[1],
-                          target.l.keyRgb[2], 0xFF};
-        PGE_Pix colDst = {target.l.keyRgb[0],
-                          target.l.keyRgb[1],
-                          target.l.keyRgb[2], 0x00};
+        PGE_Pix colSrc = {p.keyRgb[0],
+                          p.keyRgb[1],
+                          p.keyRgb[2], 0xFF};
+        PGE_Pix colDst = {p.keyRgb[0],
+                          p.keyRgb[1],
+                          p.keyRgb[2], 0x00};
         GraphicsHelps::replaceColor(sourceImage, colSrc, colDst);
     }
 
@@ -592,16 +1005,16 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
     // target.h = static_cast<int>(h);
 
     bool shrink2x;
-    switch(g_config.scale_down_textures)
+    switch(p.scale_down)
     {
     case Config_t::SCALE_DOWN_ALL:
         // only do it if the texture isn't already downscaled
-        shrink2x = (w >= Uint32(target.w) && h >= Uint32(target.h));
+        shrink2x = (w >= Uint32(p.target_w) && h >= Uint32(p.target_h));
         break;
     case Config_t::SCALE_DOWN_SAFE:
-        shrink2x = GraphicsHelps::validateFor2xScaleDown(sourceImage, StdPictureGetOrigPath(target));
+        shrink2x = GraphicsHelps::validateFor2xScaleDown(sourceImage, origPath);
         if(maskImage)
-            shrink2x &= GraphicsHelps::validateFor2xScaleDown(maskImage, StdPictureGetOrigPath(target));
+            shrink2x &= GraphicsHelps::validateFor2xScaleDown(maskImage, origPath);
         break;
     case Config_t::SCALE_DOWN_NONE:
     default:
@@ -615,22 +1028,22 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
         h /= 2;
     }
 
-    bool wLimitExcited = m_maxTextureWidth > 0 && w > Uint32(m_maxTextureWidth);
-    bool hLimitExcited = m_maxTextureHeight > 0 && h > Uint32(m_maxTextureHeight);
+    bool wLimitExcited = p.max_w > 0 && w > Uint32(p.max_w);
+    bool hLimitExcited = p.max_h > 0 && h > Uint32(p.max_h);
 
     if(wLimitExcited || hLimitExcited || shrink2x)
     {
         // WORKAROUND: down-scale too big textures
         if(wLimitExcited)
-            w = Uint32(m_maxTextureWidth);
+            w = Uint32(p.max_w);
         if(hLimitExcited)
-            h = Uint32(m_maxTextureHeight);
+            h = Uint32(p.max_h);
 
         if(wLimitExcited || hLimitExcited)
         {
             pLogWarning("Texture is too big for a given hardware limit (%dx%d). "
                         "Shrinking texture to %dx%d, quality may be distorted!",
-                        m_maxTextureWidth, m_maxTextureHeight,
+                        p.max_w, p.max_h,
                         w, h);
         }
 
@@ -653,30 +1066,335 @@ void AbstractRender_t::lazyLoad(StdPicture &target)
         }
     }
 
-    if(!g_render->depthTestSupported() || maskImage || !GraphicsHelps::validateForDepthTest(sourceImage, StdPictureGetOrigPath(target)))
+    out.depth_test_invalid = (!p.depth_test || maskImage || !GraphicsHelps::validateForDepthTest(sourceImage, origPath));
+
+    out.image = sourceImage;
+    out.mask = maskImage;
+    out.w = w;
+    out.h = h;
+    out.pitch = pitch;
+
+    if(p.use_cache)
+        s_textureCacheSave(out, cachePath);
+}
+
+
+#ifndef PGE_NO_THREADING
+
+/*
+ * Lazy picture prefetch: the decode of pictures that are likely to be drawn soon runs at background threads,
+ * so that the first draw of the picture only has to upload the decoded image. The picture's data is copied,
+ * and the decode is only used if the picture's data and decode parameters haven't changed since the prefetch.
+ */
+
+//! number of the background decode threads
+static constexpr int c_numDecodeThreads = 2;
+//! limit on the (estimated) size of the decoded images that have not yet been uploaded
+static constexpr size_t c_maxPrefetchBytes = 64 * 1024 * 1024;
+
+struct LazyDecodeJob_t
+{
+    Files::Data raw;
+    Files::Data rawMask;
+    LazyDecodeParams_t params;
+    std::string origPath;
+    size_t reserved_bytes = 0;
+
+    LazyDecoded_t result;
+
+    // protected by s_decodeMutex
+    bool started = false;
+    bool done = false;
+    //! set if the job was cancelled while running; the decode thread frees it
+    bool abandoned = false;
+};
+
+static SDL_Thread* s_decodeThreads[c_numDecodeThreads] = {nullptr};
+static int s_numDecodeThreads = 0;
+static bool s_decodeStartFailed = false;
+
+static SDL_mutex* s_decodeMutex = nullptr;
+static SDL_cond* s_decodeQueuedCond = nullptr;
+static SDL_cond* s_decodeDoneCond = nullptr;
+
+// protected by s_decodeMutex
+static bool s_decodeQuit = false;
+static std::deque<LazyDecodeJob_t*> s_decodeQueue;
+static std::map<const StdPicture*, LazyDecodeJob_t*> s_decodeJobs;
+static size_t s_decodeReservedBytes = 0;
+
+static void s_copyData(Files::Data &dst, const Files::Data &src)
+{
+    if(src.empty())
+        return;
+
+    unsigned char* mem = (unsigned char*)malloc(src.size());
+    if(!mem)
+        return;
+
+    SDL_memcpy(mem, src.begin(), src.size());
+    dst.take_ownership_of_mem(mem, src.size());
+}
+
+static bool s_sameData(const Files::Data &a, const Files::Data &b)
+{
+    return a.size() == b.size() && (a.empty() || SDL_memcmp(a.begin(), b.begin(), a.size()) == 0);
+}
+
+static void s_freeDecodeJob(LazyDecodeJob_t* job)
+{
+    job->result.close();
+    delete job;
+}
+
+static int s_decodeThreadMain(void*)
+{
+    SDL_LockMutex(s_decodeMutex);
+
+    while(true)
+    {
+        while(!s_decodeQuit && s_decodeQueue.empty())
+            SDL_CondWait(s_decodeQueuedCond, s_decodeMutex);
+
+        if(s_decodeQuit)
+            break;
+
+        LazyDecodeJob_t* job = s_decodeQueue.front();
+        s_decodeQueue.pop_front();
+        job->started = true;
+
+        SDL_UnlockMutex(s_decodeMutex);
+        s_lazyDecode(job->result, job->raw, job->rawMask, job->params, job->origPath);
+        SDL_LockMutex(s_decodeMutex);
+
+        job->done = true;
+
+        if(job->abandoned)
+            s_freeDecodeJob(job);
+        else
+            SDL_CondBroadcast(s_decodeDoneCond);
+    }
+
+    SDL_UnlockMutex(s_decodeMutex);
+
+    return 0;
+}
+
+static bool s_decodeStart()
+{
+    if(s_decodeStartFailed)
+        return false;
+
+    // would only compete with the main thread
+    if(SDL_GetCPUCount() < 2)
+    {
+        s_decodeStartFailed = true;
+        return false;
+    }
+
+    s_decodeMutex = SDL_CreateMutex();
+    s_decodeQueuedCond = SDL_CreateCond();
+    s_decodeDoneCond = SDL_CreateCond();
+
+    if(s_decodeMutex && s_decodeQueuedCond && s_decodeDoneCond)
+    {
+        s_decodeQuit = false;
+
+        for(; s_numDecodeThreads < c_numDecodeThreads; s_numDecodeThreads++)
+        {
+            s_decodeThreads[s_numDecodeThreads] = SDL_CreateThread(s_decodeThreadMain, "TextureDecode", nullptr);
+
+            if(!s_decodeThreads[s_numDecodeThreads])
+                break;
+        }
+    }
+
+    // one thread is enough to work
+    if(s_numDecodeThreads == 0)
+    {
+        pLogWarning("lazyPrefetch: failed to start the decode threads (%s), pictures will be decoded when drawn", SDL_GetError());
+        s_decodeStartFailed = true;
+
+        if(s_decodeDoneCond)
+            SDL_DestroyCond(s_decodeDoneCond);
+        if(s_decodeQueuedCond)
+            SDL_DestroyCond(s_decodeQueuedCond);
+        if(s_decodeMutex)
+            SDL_DestroyMutex(s_decodeMutex);
+
+        s_decodeDoneCond = nullptr;
+        s_decodeQueuedCond = nullptr;
+        s_decodeMutex = nullptr;
+
+        return false;
+    }
+
+    return true;
+}
+
+//! drops all prefetch jobs, must be called with s_decodeMutex locked
+static void s_decodeCancelAll()
+{
+    for(auto &it : s_decodeJobs)
+    {
+        LazyDecodeJob_t* job = it.second;
+
+        if(job->started && !job->done)
+            job->abandoned = true;
+        else
+            s_freeDecodeJob(job);
+    }
+
+    s_decodeJobs.clear();
+    s_decodeQueue.clear();
+    s_decodeReservedBytes = 0;
+}
+
+static void s_decodeQuitThreads()
+{
+    if(!s_decodeMutex)
+        return;
+
+    SDL_LockMutex(s_decodeMutex);
+    s_decodeCancelAll();
+    s_decodeQuit = true;
+    SDL_UnlockMutex(s_decodeMutex);
+    SDL_CondBroadcast(s_decodeQueuedCond);
+
+    for(int i = 0; i < s_numDecodeThreads; i++)
+        SDL_WaitThread(s_decodeThreads[i], nullptr);
+
+    s_numDecodeThreads = 0;
+
+    SDL_DestroyCond(s_decodeDoneCond);
+    SDL_DestroyCond(s_decodeQueuedCond);
+    SDL_DestroyMutex(s_decodeMutex);
+
+    s_decodeDoneCond = nullptr;
+    s_decodeQueuedCond = nullptr;
+    s_decodeMutex = nullptr;
+}
+
+/*!
+ * \brief Takes the finished prefetch decode of the target (waiting for it if it is running)
+ * \return The decoded job (owned by caller), or nullptr if there was no usable prefetch
+ */
+static LazyDecodeJob_t* s_decodeClaim(const StdPicture &target, const LazyDecodeParams_t &params)
+{
+    if(!s_decodeMutex)
+        return nullptr;
+
+    SDL_LockMutex(s_decodeMutex);
+
+    auto it = s_decodeJobs.find(&target);
+    if(it == s_decodeJobs.end())
+    {
+        SDL_UnlockMutex(s_decodeMutex);
+        return nullptr;
+    }
+
+    LazyDecodeJob_t* job = it->second;
+    s_decodeJobs.erase(it);
+    s_decodeReservedBytes -= job->reserved_bytes;
+
+    if(!job->started)
+    {
+        // not worth waiting for: decode it here instead
+        s_decodeQueue.erase(std::find(s_decodeQueue.begin(), s_decodeQueue.end(), job));
+        SDL_UnlockMutex(s_decodeMutex);
+
+        s_freeDecodeJob(job);
+        return nullptr;
+    }
+
+    while(!job->done)
+        SDL_CondWait(s_decodeDoneCond, s_decodeMutex);
+
+    SDL_UnlockMutex(s_decodeMutex);
+
+    // the picture may have been reset or reloaded since the prefetch
+    if(!(job->params == params) || !s_sameData(job->raw, target.l.raw) || !s_sameData(job->rawMask, target.l.rawMask))
+    {
+        s_freeDecodeJob(job);
+        return nullptr;
+    }
+
+    return job;
+}
+
+#endif // #ifndef PGE_NO_THREADING
+
+void AbstractRender_t::lazyLoad(StdPicture &target)
+{
+    if(!target.inited || !target.l.lazyLoaded || target.d.hasTexture())
+        return;
+
+    LazyDecodeParams_t params = s_lazyDecodeParams(target, m_maxTextureWidth, m_maxTextureHeight);
+    LazyDecoded_t decoded;
+
+#ifndef PGE_NO_THREADING
+    LazyDecodeJob_t* job = s_decodeClaim(target, params);
+
+    if(job)
+    {
+        decoded = job->result;
+        job->result = LazyDecoded_t();
+        delete job;
+    }
+    else
+#endif
+        s_lazyDecode(decoded, target.l.raw, target.l.rawMask, params, StdPictureGetOrigPath(target));
+
+    lazyLoadDecoded(target, decoded);
+}
+
+//! sets the picture info that comes from the decoded image
+static void s_lazyApplyInfo(StdPicture &target, const LazyDecoded_t &decoded)
+{
+    target.ColorUpper.r = decoded.upperColor.rgbRed;
+    target.ColorUpper.b = decoded.upperColor.rgbBlue;
+    target.ColorUpper.g = decoded.upperColor.rgbGreen;
+    target.ColorUpper.a = 255;
+
+    target.ColorLower.r = decoded.lowerColor.rgbRed;
+    target.ColorLower.b = decoded.lowerColor.rgbBlue;
+    target.ColorLower.g = decoded.lowerColor.rgbGreen;
+    target.ColorLower.a = 255;
+
+    if(decoded.depth_test_invalid)
         target.d.invalidateDepthTest();
+}
+
+void AbstractRender_t::lazyLoadDecoded(StdPicture &target, LazyDecoded_t &decoded)
+{
+    XRender::g_BitmaskTexturePresent |= decoded.bitmask_required;
+
+    if(!decoded.image)
+        return;
+
+    m_lazyLoadedBytes += decoded.loaded_bytes;
+
+    s_lazyApplyInfo(target, decoded);
 
     uint32_t w_mask = 0;
     uint32_t h_mask = 0;
 
-    if(maskImage)
+    if(decoded.mask)
     {
-        w_mask = static_cast<uint32_t>(FreeImage_GetWidth(maskImage));
-        h_mask = static_cast<uint32_t>(FreeImage_GetHeight(maskImage));
-        uint32_t pitch_mask = static_cast<uint32_t>(FreeImage_GetPitch(maskImage));
-
-        uint8_t* textura = reinterpret_cast<uint8_t *>(FreeImage_GetBits(maskImage));
+        w_mask = static_cast<uint32_t>(FreeImage_GetWidth(decoded.mask));
+        h_mask = static_cast<uint32_t>(FreeImage_GetHeight(decoded.mask));
+        uint32_t pitch_mask = static_cast<uint32_t>(FreeImage_GetPitch(decoded.mask));
 
-        g_render->loadTextureMask(target, w_mask, h_mask, textura, pitch_mask, w, h);
+        uint8_t* textura = reinterpret_cast<uint8_t *>(FreeImage_GetBits(decoded.mask));
 
-        GraphicsHelps::closeImage(maskImage);
+        g_render->loadTextureMask(target, w_mask, h_mask, textura, pitch_mask, decoded.w, decoded.h);
     }
 
-    uint8_t *textura = reinterpret_cast<uint8_t *>(FreeImage_GetBits(sourceImage));
+    uint8_t *textura = reinterpret_cast<uint8_t *>(FreeImage_GetBits(decoded.image));
 
-    g_render->loadTextureInternal(target, w, h, textura, pitch, w_mask, h_mask);
+    g_render->loadTextureInternal(target, decoded.w, decoded.h, textura, decoded.pitch, w_mask, h_mask);
 
-    GraphicsHelps::closeImage(sourceImage);
+    decoded.close();
 
 #ifdef THEXTECH_BUILD_GL_MODERN
     if(g_render->userShadersSupported() && (!target.l.particleVertexShaderSource.empty() || !target.l.fragmentShaderSource.empty()))
@@ -690,6 +1408,344 @@ void AbstractRender_t::lazyPreLoad(StdPicture &target)
         lazyLoad(target);
 }
 
+void AbstractRender_t::lazyPrefetch(StdPicture &target)
+{
+#ifndef PGE_NO_THREADING
+    if(!target.inited || !target.l.lazyLoaded || target.d.hasTexture() || target.l.raw.empty())
+        return;
+
+    if(!s_decodeMutex && !s_decodeStart())
+        return;
+
+    // the decoded image is w * h * 4 bytes, with the same again for a mask
+    size_t reserve = size_t(target.w) * size_t(target.h) * (target.l.rawMask.empty() ? 4 : 8);
+
+    SDL_LockMutex(s_decodeMutex);
+
+    bool skip = s_decodeJobs.find(&target) != s_decodeJobs.end()
+        || s_decodeReservedBytes + reserve > c_maxPrefetchBytes;
+
+    SDL_UnlockMutex(s_decodeMutex);
+
+    if(skip)
+        return;
+
+    LazyDecodeJob_t* job = new LazyDecodeJob_t();
+    s_copyData(job->raw, target.l.raw);
+    s_copyData(job->rawMask, target.l.rawMask);
+    job->params = s_lazyDecodeParams(target, m_maxTextureWidth, m_maxTextureHeight);
+    job->origPath = StdPictureGetOrigPath(target);
+    job->reserved_bytes = reserve;
+
+    // copy failed, don't bother
+    if(job->raw.empty() || job->rawMask.size() != target.l.rawMask.size())
+    {
+        delete job;
+        return;
+    }
+
+    SDL_LockMutex(s_decodeMutex);
+    s_decodeJobs[&target] = job;
+    s_decodeQueue.push_back(job);
+    s_decodeReservedBytes += reserve;
+    SDL_UnlockMutex(s_decodeMutex);
+    SDL_CondSignal(s_decodeQueuedCond);
+#else
+    UNUSED(target);
+#endif
+}
+
+void AbstractRender_t::lazyPrefetchCancel()
+{
+#ifndef PGE_NO_THREADING
+    if(!s_decodeMutex)
+        return;
+
+    SDL_LockMutex(s_decodeMutex);
+    s_decodeCancelAll();
+    SDL_UnlockMutex(s_decodeMutex);
+#endif
+}
+
+/*
+ * Texture atlas: small lazy-loaded pictures are decoded at once and packed into large shared textures,
+ * so that the renderer doesn't have to switch the texture for nearly every sprite. A packed picture keeps
+ * its own StdPicture, but its texture belongs to the atlas page, and its source rect is offset into the page.
+ */
+
+//! largest size of the atlas page
+static constexpr int c_atlasPageSize = 2048;
+//! largest size of a picture that may be packed (in decoded pixels)
+static constexpr uint32_t c_atlasMaxPicture = 512;
+//! transparent gap between the pictures of a page
+static constexpr uint32_t c_atlasGap = 2;
+
+struct AtlasPage_t
+{
+    StdPicture picture;
+    std::vector<StdPicture*> members;
+};
+
+static std::vector<AtlasPage_t*> s_atlasPages;
+
+struct AtlasEntry_t
+{
+    StdPicture *target = nullptr;
+    LazyDecodeParams_t params;
+    LazyDecoded_t decoded;
+
+    int page = -1;
+    uint32_t x = 0;
+    uint32_t y = 0;
+};
+
+struct AtlasDecodeBatch_t
+{
+    std::vector<AtlasEntry_t> *entries = nullptr;
+    int step = 1;
+};
+
+static void s_atlasDecodeJob(void *userdata, int index)
+{
+    AtlasDecodeBatch_t &batch = *reinterpret_cast<AtlasDecodeBatch_t *>(userdata);
+    std::vector<AtlasEntry_t> &entries = *batch.entries;
+
+    for(size_t i = index; i < entries.size(); i += batch.step)
+    {
+        AtlasEntry_t &e = entries[i];
+        s_lazyDecode(e.decoded, e.target->l.raw, e.target->l.rawMask, e.params, StdPictureGetOrigPath(*e.target));
+    }
+}
+
+void AbstractRender_t::packTextureAtlas(const std::vector<StdPicture*> &pictures)
+{
+    if(!g_config.texture_atlas || !g_render)
+        return;
+
+    int pageSize = c_atlasPageSize;
+    if(m_maxTextureWidth > 0 && m_maxTextureWidth < pageSize)
+        pageSize = m_maxTextureWidth;
+    if(m_maxTextureHeight > 0 && m_maxTextureHeight < pageSize)
+        pageSize = m_maxTextureHeight;
+
+    if(pageSize < int(c_atlasMaxPicture))
+        return;
+
+    // the pictures are decoded here, so any queued decodes of them would be wasted
+    lazyPrefetchCancel();
+
+    std::vector<AtlasEntry_t> entries;
+
+    for(StdPicture *p : pictures)
+    {
+        if(!p->inited || !p->l.lazyLoaded || p->d.hasTexture() || p->l.raw.empty())
+            continue;
+
+#ifdef THEXTECH_BUILD_GL_MODERN
+        // user shaders need a texture of their own
+        if(!p->l.fragmentShaderSource.empty() || !p->l.particleVertexShaderSource.empty() || p->l.light_info)
+            continue;
+#endif
+
+        entries.emplace_back();
+        entries.back().target = p;
+        entries.back().params = s_lazyDecodeParams(*p, m_maxTextureWidth, m_maxTextureHeight);
+    }
+
+    if(entries.empty())
+        return;
+
+    AtlasDecodeBatch_t batch;
+    batch.entries = &entries;
+    batch.step = WorkerPool::c_maxParallelJobs;
+    WorkerPool::Run(batch.step, s_atlasDecodeJob, &batch);
+
+    // shelf packing, tallest pictures first
+    std::vector<size_t> order;
+
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        const LazyDecoded_t &d = entries[i].decoded;
+
+        if(d.image && !d.mask && d.w <= c_atlasMaxPicture && d.h <= c_atlasMaxPicture)
+            order.push_back(i);
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+    [&entries](size_t a, size_t b)
+    {
+        return entries[a].decoded.h > entries[b].decoded.h;
+    });
+
+    int numPages = 0;
+    uint32_t shelf_x = 0, shelf_y = 0, shelf_h = 0;
+
+    for(size_t i : order)
+    {
+        AtlasEntry_t &e = entries[i];
+
+        if(numPages > 0 && shelf_x + e.decoded.w > uint32_t(pageSize))
+        {
+            shelf_x = 0;
+            shelf_y += shelf_h + c_atlasGap;
+            shelf_h = 0;
+        }
+
+        if(numPages == 0 || shelf_y + e.decoded.h > uint32_t(pageSize))
+        {
+            numPages++;
+            shelf_x = shelf_y = shelf_h = 0;
+        }
+
+        e.page = numPages - 1;
+        e.x = shelf_x;
+        e.y = shelf_y;
+
+        shelf_x += e.decoded.w + c_atlasGap;
+        if(e.decoded.h > shelf_h)
+            shelf_h = e.decoded.h;
+    }
+
+    std::vector<uint8_t> pixels;
+    int packed = 0;
+
+    for(int page_i = 0; page_i < numPages; page_i++)
+    {
+        pixels.assign(size_t(pageSize) * pageSize * 4, 0);
+        int count = 0;
+
+        for(size_t i : order)
+        {
+            AtlasEntry_t &e = entries[i];
+            if(e.page != page_i)
+                continue;
+
+            const uint8_t *src = reinterpret_cast<const uint8_t *>(FreeImage_GetBits(e.decoded.image));
+
+            for(uint32_t row = 0; row < e.decoded.h; row++)
+                SDL_memcpy(&pixels[((e.y + row) * pageSize + e.x) * 4], src + row * e.decoded.pitch, e.decoded.w * 4);
+
+            count++;
+        }
+
+        // not worth a page
+        if(count < 2)
+            continue;
+
+        AtlasPage_t *page = new AtlasPage_t();
+        page->picture.inited = true;
+        page->picture.w = pageSize;
+        page->picture.h = pageSize;
+
+        g_render->loadTextureInternal(page->picture, pageSize, pageSize, pixels.data(), pageSize * 4, 0, 0);
+
+        if(!page->picture.d.hasTexture())
+        {
+            pLogWarning("Texture atlas: failed to load a %dx%d page, loading the pictures separately", pageSize, pageSize);
+            delete page;
+            continue;
+        }
+
+        const StdPictureData &pd = page->picture.d;
+
+        for(size_t i : order)
+        {
+            AtlasEntry_t &e = entries[i];
+            if(e.page != page_i)
+                continue;
+
+            StdPicture &target = *e.target;
+
+            XRender::g_BitmaskTexturePresent |= e.decoded.bitmask_required;
+            m_lazyLoadedBytes += e.decoded.loaded_bytes;
+
+            s_lazyApplyInfo(target, e.decoded);
+
+            target.d.texture = pd.texture;
+            target.d.texture_id = pd.texture_id;
+            target.d.sw_pixels = pd.sw_pixels;
+            target.d.sw_w = pd.sw_w;
+            target.d.sw_h = pd.sw_h;
+            target.d.format = pd.format;
+            target.d.nOfColors = pd.nOfColors;
+
+            target.d.w_scale = static_cast<float>(e.decoded.w) / target.w * pd.w_scale;
+            target.d.h_scale = static_cast<float>(e.decoded.h) / target.h * pd.h_scale;
+
+            target.d.atlas = &page->picture;
+            target.d.atlas_x = e.x * pd.w_scale;
+            target.d.atlas_y = e.y * pd.h_scale;
+
+            page->members.push_back(&target);
+
+            e.decoded.close();
+        }
+
+        packed += (int)page->members.size();
+        s_atlasPages.push_back(page);
+    }
+
+    // everything that wasn't packed is loaded as usual, since it is decoded anyway
+    for(AtlasEntry_t &e : entries)
+    {
+        if(e.decoded.image)
+            lazyLoadDecoded(*e.target, e.decoded);
+        else
+            XRender::g_BitmaskTexturePresent |= e.decoded.bitmask_required;
+    }
+
+    pLogDebug("Texture atlas: packed %d of %d pictures, %d pages in use", packed, (int)entries.size(), (int)s_atlasPages.size());
+}
+
+void AbstractRender_t::unloadAtlasPicture(StdPicture &tx)
+{
+    StdPicture *page_picture = tx.d.atlas;
+
+    tx.d = StdPictureData();
+
+    if(!tx.l.canLoad())
+        static_cast<StdPicture_Sub&>(tx) = StdPicture_Sub();
+
+    for(auto it = s_atlasPages.begin(); it != s_atlasPages.end(); ++it)
+    {
+        AtlasPage_t *page = *it;
+        if(&page->picture != page_picture)
+            continue;
+
+        auto m = std::find(page->members.begin(), page->members.end(), &tx);
+        if(m != page->members.end())
+            page->members.erase(m);
+
+        if(page->members.empty())
+        {
+            g_render->unloadTexture(page->picture);
+            delete page;
+            s_atlasPages.erase(it);
+        }
+
+        break;
+    }
+}
+
+void AbstractRender_t::clearTextureAtlases()
+{
+    for(AtlasPage_t *page : s_atlasPages)
+    {
+        for(StdPicture *tx : page->members)
+        {
+            tx->d = StdPictureData();
+
+            if(!tx->l.canLoad())
+                static_cast<StdPicture_Sub&>(*tx) = StdPicture_Sub();
+        }
+
+        g_render->unloadTexture(page->picture);
+        delete page;
+    }
+
+    s_atlasPages.clear();
+}
+
 size_t AbstractRender_t::lazyLoadedBytes()
 {
     return m_lazyLoadedBytes;
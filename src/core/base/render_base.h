@@ -24,6 +24,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "std_picture.h"
 #include "render_types.h"
@@ -36,6 +37,7 @@ typedef struct SDL_Thread SDL_Thread;
 typedef struct SDL_mutex SDL_mutex;
 typedef struct SDL_Window SDL_Window;
 struct CmdLineSetup_t;
+struct LazyDecoded_t;
 
 class AbstractRender_t
 {
@@ -43,6 +45,9 @@ class AbstractRender_t
 
     static size_t m_lazyLoadedBytes;
 
+    // uploads a decoded lazy-loaded picture as its own texture
+    static void lazyLoadDecoded(StdPicture &target, LazyDecoded_t &decoded);
+
 protected:
     //! Maximum texture width
     static int    m_maxTextureWidth;
@@ -233,6 +238,12 @@ protected:
                              uint32_t image_width,
                              uint32_t image_height);
 
+    //! Unload a picture that was packed into an atlas page (and the page, once it has no pictures left)
+    static void unloadAtlasPicture(StdPicture &tx);
+
+    //! Unload all atlas pages and the pictures packed into them
+    static void clearTextureAtlases();
+
 public:
     virtual bool textureMaskSupported();
 
@@ -243,6 +254,24 @@ public:
     static void lazyLoad(StdPicture &target);
     static void lazyPreLoad(StdPicture &target);
 
+    /*!
+     * \brief Start decoding a lazy-loaded picture at a background thread, so that its lazyLoad only has to upload it
+     * \param target Picture that is likely to be drawn soon
+     *
+     * Does nothing without threading support, or when too many prefetched pictures are waiting for their upload
+     */
+    static void lazyPrefetch(StdPicture &target);
+    //! Drop all prefetched pictures that were not yet uploaded
+    static void lazyPrefetchCancel();
+
+    /*!
+     * \brief Decode lazy-loaded pictures now and pack the small ones into shared atlas textures
+     * \param pictures Candidate pictures (already loaded pictures and ones with masks or shaders are skipped)
+     *
+     * Does nothing unless enabled at the config. Decoded pictures that don't fit into an atlas are loaded as usual.
+     */
+    static void packTextureAtlas(const std::vector<StdPicture*> &pictures);
+
     static size_t lazyLoadedBytes();
     static void lazyLoadedBytesReset();
 
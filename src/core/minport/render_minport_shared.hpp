@@ -161,6 +161,22 @@ void splitFrame()
     /* empty */
 }
 
+// pictures are decoded on load, and there are no texture atlases
+void lazyPrefetch(StdPicture &target)
+{
+    UNUSED(target);
+}
+
+void lazyPrefetchCancel()
+{
+    /* empty */
+}
+
+void packTextureAtlas(const std::vector<StdPicture*> &pictures)
+{
+    UNUSED(pictures);
+}
+
 void setTransparentColor(StdPicture &target, uint32_t rgb)
 {
 #if defined(__WII__) || defined(__3DS__)
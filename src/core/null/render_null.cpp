@@ -258,6 +258,19 @@ void lazyPreLoad(StdPicture &target)
     lazyLoad(target);
 }
 
+void lazyPrefetch(StdPicture &target)
+{
+    UNUSED(target);
+}
+
+void lazyPrefetchCancel()
+{}
+
+void packTextureAtlas(const std::vector<StdPicture*> &pictures)
+{
+    UNUSED(pictures);
+}
+
 
 void loadTexture(StdPicture&, uint32_t, uint32_t, uint8_t*, uint32_t)
 {
@@ -548,6 +548,12 @@ private:
     // Selects efficient ordered vertex list for given context and depth pair. Batches across subsequent draws and masks.
     VertexList& getOrderedDrawVertexList(DrawContext_t context, int depth);
 
+    // Picture whose texture is bound to draw the given picture (its atlas page if it was packed into an atlas)
+    static inline StdPicture* drawTexture(StdPicture& tx)
+    {
+        return tx.d.atlas ? tx.d.atlas : &tx;
+    }
+
     // Adds vertices to a VertexList
     void addVertices(VertexList& list, const RectI& loc, const RectF& texcoord, GLshort depth, const Vertex_t::Tint& tint);
     void addVertices(VertexList& list, const QuadI& loc, const RectF& texcoord, GLshort depth, const Vertex_t::Tint& tint);
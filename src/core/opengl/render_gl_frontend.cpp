@@ -1099,6 +1099,12 @@ bool RenderGL::userShadersSupported()
 
 void RenderGL::unloadTexture(StdPicture &tx)
 {
+    if(tx.d.atlas)
+    {
+        unloadAtlasPicture(tx);
+        return;
+    }
+
     auto corpseIt = m_loadedPictures.find(&tx);
     if(corpseIt != m_loadedPictures.end())
         m_loadedPictures.erase(corpseIt);
@@ -1121,6 +1127,9 @@ void RenderGL::unloadTexture(StdPicture &tx)
 
 void RenderGL::unloadGifTextures()
 {
+    // atlas pages may hold GIF textures, and are rebuilt at the next load
+    clearTextureAtlases();
+
     // need to backup because unloadTexture modifies m_loadedPictures
     auto pictures_bak = m_loadedPictures;
 
@@ -1136,6 +1145,8 @@ void RenderGL::unloadGifTextures()
 
 void RenderGL::clearAllTextures()
 {
+    clearTextureAtlases();
+
     for(StdPicture *tx : m_loadedPictures)
     {
         D_pLogDebug("RenderGL: unloading texture at %p on clearAllTextures()", tx);
@@ -1487,6 +1498,7 @@ void RenderGL::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, do
 
     RectF draw_source_raw = RectF(xSrc, ySrc, xSrc + wSrc, ySrc + hSrc);
     RectF draw_source = draw_source_raw * PointF(tx.d.w_scale, tx.d.h_scale);
+    draw_source += PointF(tx.d.atlas_x, tx.d.atlas_y);
 
     if(flip & X_FLIP_HORIZONTAL)
         std::swap(draw_source.tl.x, draw_source.br.x);
@@ -1494,7 +1506,7 @@ void RenderGL::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, do
     if(flip & X_FLIP_VERTICAL)
         std::swap(draw_source.tl.y, draw_source.br.y);
 
-    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, &tx};
+    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, drawTexture(tx)};
 
     Vertex_t::Tint tint = F_TO_B(color);
 
@@ -1537,8 +1549,9 @@ void RenderGL::renderTextureScale(double xDst, double yDst, double wDst, double
 
     RectF draw_source_raw = RectF(0.0, 0.0, tx.w, tx.h);
     RectF draw_source = draw_source_raw * PointF(tx.d.w_scale, tx.d.h_scale);
+    draw_source += PointF(tx.d.atlas_x, tx.d.atlas_y);
 
-    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, &tx};
+    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, drawTexture(tx)};
 
     Vertex_t::Tint tint = F_TO_B(color);
 
@@ -1612,8 +1625,9 @@ void RenderGL::renderTexture(double xDstD, double yDstD, double wDstD, double hD
 
     RectF draw_source_raw = RectF(xSrc, ySrc, xSrc + wDst, ySrc + hDst);
     RectF draw_source = draw_source_raw * PointF(tx.d.w_scale, tx.d.h_scale);
+    draw_source += PointF(tx.d.atlas_x, tx.d.atlas_y);
 
-    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, &tx};
+    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, drawTexture(tx)};
 
     Vertex_t::Tint tint = F_TO_B(color);
 
@@ -1716,6 +1730,7 @@ void RenderGL::renderTextureFL(double xDstD, double yDstD, double wDstD, double
 
     RectF draw_source_raw = RectF(xSrc, ySrc, xSrc + wDst, ySrc + hDst);
     RectF draw_source = draw_source_raw * PointF(tx.d.w_scale, tx.d.h_scale);
+    draw_source += PointF(tx.d.atlas_x, tx.d.atlas_y);
 
     if(flip & X_FLIP_HORIZONTAL)
         std::swap(draw_source.tl.x, draw_source.br.x);
@@ -1723,7 +1738,7 @@ void RenderGL::renderTextureFL(double xDstD, double yDstD, double wDstD, double
     if(flip & X_FLIP_VERTICAL)
         std::swap(draw_source.tl.y, draw_source.br.y);
 
-    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, &tx};
+    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, drawTexture(tx)};
 
     Vertex_t::Tint tint = F_TO_B(color);
 
@@ -1766,8 +1781,9 @@ void RenderGL::renderTexture(float xDst, float yDst,
 
     RectF draw_source_raw = RectF(0.0, 0.0, tx.w, tx.h);
     RectF draw_source = draw_source_raw * PointF(tx.d.w_scale, tx.d.h_scale);
+    draw_source += PointF(tx.d.atlas_x, tx.d.atlas_y);
 
-    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, &tx};
+    DrawContext_t context = {tx.d.shader_program ? *tx.d.shader_program : m_standard_program, drawTexture(tx)};
 
     Vertex_t::Tint tint = F_TO_B(color);
 
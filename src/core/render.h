@@ -24,6 +24,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "sdl_proxy/sdl_stdinc.h"
 
@@ -425,6 +426,29 @@ E_INLINE void lazyPreLoad(StdPicture &target) TAIL
 }
 #endif
 
+// start decoding a picture that is likely to be drawn soon at a background thread
+E_INLINE void lazyPrefetch(StdPicture &target) TAIL
+#ifndef RENDER_CUSTOM
+{
+    AbstractRender_t::lazyPrefetch(target);
+}
+#endif
+
+E_INLINE void lazyPrefetchCancel() TAIL
+#ifndef RENDER_CUSTOM
+{
+    AbstractRender_t::lazyPrefetchCancel();
+}
+#endif
+
+// decode the given pictures now and pack the small ones into shared textures (if enabled)
+E_INLINE void packTextureAtlas(const std::vector<StdPicture*> &pictures) TAIL
+#ifndef RENDER_CUSTOM
+{
+    AbstractRender_t::packTextureAtlas(pictures);
+}
+#endif
+
 E_INLINE size_t lazyLoadedBytes() TAIL
 #ifndef RENDER_CUSTOM
 {
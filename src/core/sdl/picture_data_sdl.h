@@ -33,6 +33,7 @@ typedef int             GLint;
 typedef unsigned int    GLuint;
 
 struct SDL_Texture;
+struct StdPicture;
 
 /*!
  * \brief Platform specific picture data. Fields should not be used directly
@@ -41,8 +42,10 @@ struct StdPictureData
 {
 // Compatible backend is only can use these internals
 private:
+    friend class AbstractRender_t;
     friend class RenderSDL;
     friend class RenderGL;
+    friend class RenderSW;
 
     //! Texture instance pointer for SDL Render
     SDL_Texture *texture = nullptr;
@@ -69,6 +72,12 @@ private:
     //! mask texture ID for OpenGL and other render engines
     GLuint       mask_texture_id = 0;
 
+    //! Pixels for the software render (ARGB8888, rows are packed)
+    uint32_t    *sw_pixels = nullptr;
+    //! Size of the software render's pixels
+    int          sw_w = 0;
+    int          sw_h = 0;
+
     //! Texture format at OpenGL-renderer
     GLenum      format = 0;
     //! Number of colors
@@ -79,6 +88,12 @@ private:
     //! Height scale factor
     float h_scale = 1.0f;
 
+    //! Atlas page that owns the texture (if the picture was packed into an atlas)
+    StdPicture *atlas = nullptr;
+    //! Offset of the picture at the atlas page, in the units of the scaled source rect
+    float atlas_x = 0.0f;
+    float atlas_y = 0.0f;
+
     //! Cached color modifier
     uint8_t     modColor[4] = {255,255,255,255};
 
@@ -90,7 +105,7 @@ public:
 
     inline bool hasTexture() const
     {
-        return texture != nullptr || texture_id != 0;
+        return texture != nullptr || texture_id != 0 || sw_pixels != nullptr;
     }
 
     inline void invalidateDepthTest()
@@ -52,6 +52,17 @@
 #define SDL_RenderCopyExF SDL_RenderCopyEx
 #endif
 
+// SDL_RenderGeometry() is available since SDL 2.0.18
+#if SDL_COMPILEDVERSION < SDL_VERSIONNUM(2, 0, 18)
+#define XTECH_SDL_NO_GEOMETRY_SUPPORT
+#endif
+
+#ifndef XTECH_SDL_NO_GEOMETRY_SUPPORT
+// vertices and indices of the current texture batch
+static std::vector<SDL_Vertex> s_batchVertices;
+static std::vector<int> s_batchIndices;
+#endif
+
 
 
 RenderSDL::RenderSDL() :
@@ -130,6 +141,12 @@ bool RenderSDL::initRender(SDL_Window *window)
     m_maxTextureWidth = ri.max_texture_width;
     m_maxTextureHeight = ri.max_texture_height;
 
+#ifndef XTECH_SDL_NO_GEOMETRY_SUPPORT
+    // the software renderer copies rects faster than it rasterizes triangles
+    m_use_geometry = !(ri.flags & SDL_RENDERER_SOFTWARE);
+    pLogDebug("Render SDL: batching of textured draws is %s", m_use_geometry ? "on" : "off");
+#endif
+
     m_tBuffer = SDL_CreateTexture(m_gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, ScaleWidth, ScaleHeight);
     if(!m_tBuffer)
     {
@@ -496,6 +513,12 @@ void RenderSDL::loadTextureInternal(StdPicture &target, uint32_t width, uint32_t
 
 void RenderSDL::unloadTexture(StdPicture &tx)
 {
+    if(tx.d.atlas)
+    {
+        unloadAtlasPicture(tx);
+        return;
+    }
+
     auto corpseIt = m_loadedPictures.find(&tx);
     if(corpseIt != m_loadedPictures.end())
         m_loadedPictures.erase(corpseIt);
@@ -515,6 +538,8 @@ void RenderSDL::unloadTexture(StdPicture &tx)
 
 void RenderSDL::clearAllTextures()
 {
+    clearTextureAtlases();
+
     for(StdPicture *tx : m_loadedPictures)
     {
         D_pLogDebug("RenderSDL: unloading texture at %p on clearAllTextures()", tx);
@@ -549,12 +574,149 @@ void RenderSDL::flushRenderQueue()
 
     m_render_queue.sort();
 
-    for(uint32_t i : m_render_queue.indices)
-        execute(m_render_queue.ops[i & 0xFFFF]);
+    const size_t count = m_render_queue.indices.size();
+
+    for(size_t i = 0; i < count;)
+    {
+        const RenderOp &op = m_render_queue.ops[m_render_queue.indices[i] & 0xFFFF];
+
+#ifndef XTECH_SDL_NO_GEOMETRY_SUPPORT
+        // ops are already in their final order, so a run of draws from the same texture may go at once
+        SDL_Texture *texture = (m_use_geometry && op.type == RenderOp::Type::texture && op.texture && op.texture->inited)
+            ? op.texture->d.texture : nullptr;
+
+        if(texture)
+        {
+            size_t end = i + 1;
+
+            for(; end < count; end++)
+            {
+                const RenderOp &next = m_render_queue.ops[m_render_queue.indices[end] & 0xFFFF];
+
+                if(next.type != RenderOp::Type::texture || !next.texture || !next.texture->inited || next.texture->d.texture != texture)
+                    break;
+            }
+
+            if(end - i > 1 && executeBatch(i, end))
+            {
+                i = end;
+                continue;
+            }
+        }
+#endif
+
+        execute(op);
+        i++;
+    }
 
     m_render_queue.clear();
 }
 
+bool RenderSDL::executeBatch(size_t begin, size_t end)
+{
+#ifdef XTECH_SDL_NO_GEOMETRY_SUPPORT
+    UNUSED(begin);
+    UNUSED(end);
+    return false;
+#else
+    const RenderOp &first = m_render_queue.ops[m_render_queue.indices[begin] & 0xFFFF];
+    SDL_Texture *texture = first.texture->d.texture;
+
+    int tex_w, tex_h;
+    if(SDL_QueryTexture(texture, nullptr, nullptr, &tex_w, &tex_h) < 0 || tex_w <= 0 || tex_h <= 0)
+        return false;
+
+    const float inv_w = 1.0f / tex_w;
+    const float inv_h = 1.0f / tex_h;
+
+    // the colors go to the vertices, so the texture's own color modifier has to be neutral
+    txColorMod(first.texture->d.atlas ? first.texture->d.atlas->d : first.texture->d, XTColor());
+
+    s_batchVertices.clear();
+    s_batchIndices.clear();
+
+    for(size_t i = begin; i < end; i++)
+    {
+        const RenderOp &op = m_render_queue.ops[m_render_queue.indices[i] & 0xFFFF];
+        const StdPicture &tx = *op.texture;
+
+        // same source rect as in execute()
+        SDL_Rect sourceRect = {0, 0, tex_w, tex_h};
+
+        if(op.traits & RenderOp::Traits::src_rect)
+            sourceRect = {op.xSrc, op.ySrc, op.wSrc, op.hSrc};
+        else if(tx.d.atlas)
+            sourceRect = {0, 0, int(tx.d.w_scale * tx.w), int(tx.d.h_scale * tx.h)};
+
+        if(tx.d.atlas)
+        {
+            sourceRect.x += int(tx.d.atlas_x);
+            sourceRect.y += int(tx.d.atlas_y);
+        }
+
+        float u1 = sourceRect.x * inv_w;
+        float v1 = sourceRect.y * inv_h;
+        float u2 = (sourceRect.x + sourceRect.w) * inv_w;
+        float v2 = (sourceRect.y + sourceRect.h) * inv_h;
+
+        if(op.traits & RenderOp::Traits::flip_X)
+            std::swap(u1, u2);
+        if(op.traits & RenderOp::Traits::flip_Y)
+            std::swap(v1, v2);
+
+        SDL_FPoint corners[4] =
+        {
+            {float(op.xDst), float(op.yDst)},
+            {float(op.xDst + op.wDst), float(op.yDst)},
+            {float(op.xDst + op.wDst), float(op.yDst + op.hDst)},
+            {float(op.xDst), float(op.yDst + op.hDst)}
+        };
+
+        // clockwise around the center of the destination rect, the same as SDL_RenderCopyEx()
+        if((op.traits & RenderOp::Traits::rotation) && op.angle != 0)
+        {
+            const double theta = double(op.angle) * (2.0 * M_PI / 65536.0);
+            const float cos_t = float(std::cos(theta));
+            const float sin_t = float(std::sin(theta));
+
+            const float cx = op.xDst + op.wDst * 0.5f;
+            const float cy = op.yDst + op.hDst * 0.5f;
+
+            for(SDL_FPoint &p : corners)
+            {
+                const float dx = p.x - cx;
+                const float dy = p.y - cy;
+                p.x = cx + dx * cos_t - dy * sin_t;
+                p.y = cy + dx * sin_t + dy * cos_t;
+            }
+        }
+
+        const SDL_Color color = {op.color.r, op.color.g, op.color.b, op.color.a};
+        const SDL_FPoint tex_coords[4] = {{u1, v1}, {u2, v1}, {u2, v2}, {u1, v2}};
+
+        const int base = (int)s_batchVertices.size();
+
+        for(int c = 0; c < 4; c++)
+            s_batchVertices.push_back({corners[c], color, tex_coords[c]});
+
+        const int quad[6] = {0, 1, 2, 0, 2, 3};
+        for(int q : quad)
+            s_batchIndices.push_back(base + q);
+    }
+
+    if(SDL_RenderGeometry(m_gRenderer, texture,
+                          s_batchVertices.data(), (int)s_batchVertices.size(),
+                          s_batchIndices.data(), (int)s_batchIndices.size()) < 0)
+    {
+        pLogWarning("Render SDL: geometry isn't supported (%s), drawing textures one by one", SDL_GetError());
+        m_use_geometry = false;
+        return false;
+    }
+
+    return true;
+#endif
+}
+
 void RenderSDL::execute(const RenderOp& op)
 {
 #ifdef USE_RENDER_BLOCKING
@@ -678,8 +840,20 @@ void RenderSDL::execute(const RenderOp& op)
             sourceRect = {op.xSrc, op.ySrc, op.wSrc, op.hSrc};
             sourceRectPtr = &sourceRect;
         }
+        else if(tx.d.atlas)
+        {
+            sourceRect = {0, 0, int(tx.d.w_scale * tx.w), int(tx.d.h_scale * tx.h)};
+            sourceRectPtr = &sourceRect;
+        }
+
+        // the picture is a part of the atlas page's texture, which also holds the texture's color modifier
+        if(tx.d.atlas)
+        {
+            sourceRect.x += int(tx.d.atlas_x);
+            sourceRect.y += int(tx.d.atlas_y);
+        }
 
-        txColorMod(tx.d, op.color);
+        txColorMod(tx.d.atlas ? tx.d.atlas->d : tx.d, op.color);
 
         if(op.traits & RenderOp::Traits::rotoflip)
         {
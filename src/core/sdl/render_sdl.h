@@ -50,6 +50,9 @@ class RenderSDL final : public AbstractRender_t
     // current draw plane
     uint8_t m_recent_draw_plane = 0;
 
+    // draw runs of textured ops that share a texture with a single SDL_RenderGeometry() call
+    bool m_use_geometry = false;
+
     // Scale of virtual and window resolutuins
     float m_scale_x = 1.f;
     float m_scale_y = 1.f;
@@ -83,6 +86,9 @@ class RenderSDL final : public AbstractRender_t
 
     static void txColorMod(StdPictureData &tx, XTColor color);
 
+    // draws ops [begin, end) of the sorted render queue (all of them share a texture) as one geometry call
+    bool executeBatch(size_t begin, size_t end);
+
 public:
     RenderSDL();
     ~RenderSDL() override;
@@ -0,0 +1,1425 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define RENDER_SW_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#   include <arm_neon.h>
+#   define RENDER_SW_NEON
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <SDL2/SDL_video.h>
+#include <SDL2/SDL_surface.h>
+#include <SDL2/SDL_pixels.h>
+
+#include <FreeImageLite.h>
+#include <Logger/logger.h>
+#include <Utils/maths.h>
+#include <DirManager/dirman.h>
+#include <fmt_format_ne.h>
+
+#include "render_sw.h"
+#include "config.h"
+
+#include "core/window.h"
+#include "core/render.h"
+
+#include "main/cheat_code.h"
+#include "main/record.h"
+
+#include "graphics.h"
+#include "controls.h"
+#include "sound.h"
+
+#ifndef UNUSED
+#define UNUSED(x) (void)x
+#endif
+
+
+/*
+ * Pixel math. All buffers are ARGB8888 (B, G, R, A bytes in memory for the SIMD paths).
+ *
+ * Every path computes exactly the same values as s_blendPixel(), so the output doesn't depend on the instruction set.
+ */
+
+//! Rounded x / 255, exact for x in [0, 255 * 255]
+static inline uint32_t s_div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+//! Source pixel (multiplied by the color modifier) over the destination pixel, mod is in B, G, R, A order
+static inline uint32_t s_blendPixel(uint32_t dst, uint32_t src, const uint32_t mod[4])
+{
+    const uint32_t a = s_div255((src >> 24) * mod[3]);
+
+    if(a == 0)
+        return dst;
+
+    const uint32_t ia = 255 - a;
+    uint32_t ret = s_div255(a * 255 + (dst >> 24) * ia) << 24;
+
+    for(int c = 0; c < 24; c += 8)
+    {
+        uint32_t s = s_div255(((src >> c) & 0xFF) * mod[c >> 3]);
+        ret |= s_div255(s * a + ((dst >> c) & 0xFF) * ia) << c;
+    }
+
+    return ret;
+}
+
+#if defined(RENDER_SW_SSE2)
+static inline __m128i s_div255SSE2(__m128i x)
+{
+    const __m128i t = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// two pixels, unpacked into 16-bit lanes; the alpha lane is weighted by 255 so that it matches s_blendPixel()
+static inline __m128i s_blend2SSE2(__m128i s, __m128i d, __m128i mod)
+{
+    const __m128i v255 = _mm_set1_epi16(255);
+    const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+    s = s_div255SSE2(_mm_mullo_epi16(s, mod));
+
+    const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i w = _mm_or_si128(_mm_andnot_si128(alpha_lanes, a), _mm_and_si128(alpha_lanes, v255));
+
+    return s_div255SSE2(_mm_add_epi16(_mm_mullo_epi16(s, w), _mm_mullo_epi16(d, _mm_sub_epi16(v255, a))));
+}
+#elif defined(RENDER_SW_NEON)
+static inline uint16x8_t s_div255NEON(uint16x8_t x)
+{
+    const uint16x8_t t = vaddq_u16(x, vdupq_n_u16(128));
+    return vshrq_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+// two pixels; the alpha lane is weighted by 255 so that it matches s_blendPixel()
+static inline uint8x8_t s_blend2NEON(uint8x8_t s8, uint8x8_t d8, uint16x8_t mod)
+{
+    static const uint16_t c_alpha_lanes[8] = {0, 0, 0, 0xFFFF, 0, 0, 0, 0xFFFF};
+
+    const uint16x8_t v255 = vdupq_n_u16(255);
+
+    const uint16x8_t s = s_div255NEON(vmulq_u16(vmovl_u8(s8), mod));
+    const uint16x8_t a = vcombine_u16(vdup_lane_u16(vget_low_u16(s), 3), vdup_lane_u16(vget_high_u16(s), 3));
+    const uint16x8_t w = vbslq_u16(vld1q_u16(c_alpha_lanes), v255, a);
+
+    return vmovn_u16(s_div255NEON(vmlaq_u16(vmulq_u16(s, w), vmovl_u8(d8), vsubq_u16(v255, a))));
+}
+#endif
+
+static void s_blendRow(uint32_t *dst, const uint32_t *src, int n, XTColor color)
+{
+    const uint32_t mod[4] = {color.b, color.g, color.r, color.a};
+
+    int i = 0;
+
+#if defined(RENDER_SW_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vmod = _mm_set_epi16(color.a, color.r, color.g, color.b, color.a, color.r, color.g, color.b);
+
+    for(; i + 4 <= n; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+
+        const __m128i lo = s_blend2SSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), vmod);
+        const __m128i hi = s_blend2SSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), vmod);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(RENDER_SW_NEON)
+    const uint16_t mod16[8] = {color.b, color.g, color.r, color.a, color.b, color.g, color.r, color.a};
+    const uint16x8_t vmod = vld1q_u16(mod16);
+
+    for(; i + 4 <= n; i += 4)
+    {
+        const uint8x16_t s = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+        const uint8x16_t d = vld1q_u8(reinterpret_cast<const uint8_t*>(dst + i));
+
+        const uint8x8_t lo = s_blend2NEON(vget_low_u8(s), vget_low_u8(d), vmod);
+        const uint8x8_t hi = s_blend2NEON(vget_high_u8(s), vget_high_u8(d), vmod);
+
+        vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), vcombine_u8(lo, hi));
+    }
+#endif
+
+    for(; i < n; i++)
+        dst[i] = s_blendPixel(dst[i], src[i], mod);
+}
+
+static inline uint32_t s_packColor(XTColor color)
+{
+    return (uint32_t(color.a) << 24) | (uint32_t(color.r) << 16) | (uint32_t(color.g) << 8) | uint32_t(color.b);
+}
+
+//! Maps the destination pixel i of n ones onto a source range of len pixels (samples at the pixel centers)
+static inline int s_sample(int i, int n, int len)
+{
+    return int((int64_t(2 * i + 1) * len) / (2 * n));
+}
+
+static inline int s_clamp(int v, int max)
+{
+    return (v < 0) ? 0 : ((v > max) ? max : v);
+}
+
+//! sin(i * pi / 512) in 16.16 fixed point, for i from 0 to 256 (a quarter turn)
+static const int32_t s_sinTable[257] =
+{
+    0, 402, 804, 1206, 1608, 2010, 2412, 2814,
+    3216, 3617, 4019, 4420, 4821, 5222, 5623, 6023,
+    6424, 6824, 7224, 7623, 8022, 8421, 8820, 9218,
+    9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391,
+    12785, 13180, 13573, 13966, 14359, 14751, 15143, 15534,
+    15924, 16314, 16703, 17091, 17479, 17867, 18253, 18639,
+    19024, 19409, 19792, 20175, 20557, 20939, 21320, 21699,
+    22078, 22457, 22834, 23210, 23586, 23961, 24335, 24708,
+    25080, 25451, 25821, 26190, 26558, 26925, 27291, 27656,
+    28020, 28383, 28745, 29106, 29466, 29824, 30182, 30538,
+    30893, 31248, 31600, 31952, 32303, 32652, 33000, 33347,
+    33692, 34037, 34380, 34721, 35062, 35401, 35738, 36075,
+    36410, 36744, 37076, 37407, 37736, 38064, 38391, 38716,
+    39040, 39362, 39683, 40002, 40320, 40636, 40951, 41264,
+    41576, 41886, 42194, 42501, 42806, 43110, 43412, 43713,
+    44011, 44308, 44604, 44898, 45190, 45480, 45769, 46056,
+    46341, 46624, 46906, 47186, 47464, 47741, 48015, 48288,
+    48559, 48828, 49095, 49361, 49624, 49886, 50146, 50404,
+    50660, 50914, 51166, 51417, 51665, 51911, 52156, 52398,
+    52639, 52878, 53114, 53349, 53581, 53812, 54040, 54267,
+    54491, 54714, 54934, 55152, 55368, 55582, 55794, 56004,
+    56212, 56418, 56621, 56823, 57022, 57219, 57414, 57607,
+    57798, 57986, 58172, 58356, 58538, 58718, 58896, 59071,
+    59244, 59415, 59583, 59750, 59914, 60075, 60235, 60392,
+    60547, 60700, 60851, 60999, 61145, 61288, 61429, 61568,
+    61705, 61839, 61971, 62101, 62228, 62353, 62476, 62596,
+    62714, 62830, 62943, 63054, 63162, 63268, 63372, 63473,
+    63572, 63668, 63763, 63854, 63944, 64031, 64115, 64197,
+    64277, 64354, 64429, 64501, 64571, 64639, 64704, 64766,
+    64827, 64884, 64940, 64993, 65043, 65091, 65137, 65180,
+    65220, 65259, 65294, 65328, 65358, 65387, 65413, 65436,
+    65457, 65476, 65492, 65505, 65516, 65525, 65531, 65535,
+    65536
+};
+
+//! Sine of an angle (65536 is a full turn) in 16.16 fixed point, interpolated from the table
+//! (libm results differ between platforms, and rotated pixels must not)
+static inline int32_t s_sin16(uint16_t angle)
+{
+    uint32_t pos = angle & 0x3FFF;
+
+    // the second and the fourth quarters mirror the table
+    if(angle & 0x4000)
+        pos = 0x4000 - pos;
+
+    const uint32_t i = pos >> 6;
+    const int32_t f = int32_t(pos & 63);
+
+    int32_t v = s_sinTable[i];
+
+    if(i < 256)
+        v += ((s_sinTable[i + 1] - v) * f + 32) >> 6;
+
+    return (angle & 0x8000) ? -v : v;
+}
+
+static inline int32_t s_cos16(uint16_t angle)
+{
+    return s_sin16(uint16_t(angle + 0x4000));
+}
+
+
+
+RenderSW::RenderSW() :
+    AbstractRender_t()
+{}
+
+RenderSW::~RenderSW()
+{
+    if(m_window)
+        RenderSW::close();
+}
+
+unsigned int RenderSW::SDL_InitFlags()
+{
+    return 0;
+}
+
+bool RenderSW::isWorking()
+{
+    return m_window && !m_game_buffer.empty();
+}
+
+bool RenderSW::initRender(SDL_Window *window)
+{
+    pLogDebug("Init renderer settings...");
+
+    if(!AbstractRender_t::init())
+        return false;
+
+    m_window = window;
+
+    g_config.render_mode.obtained = Config_t::RENDER_SOFTWARE_CPU;
+    pLogDebug("Using CPU rendering");
+
+    if(!SDL_GetWindowSurface(window))
+    {
+        pLogCritical("Unable to get the window surface: %s", SDL_GetError());
+        m_window = nullptr;
+        return false;
+    }
+
+    // the pictures are plain memory, so only keep them reasonable
+    m_maxTextureWidth = 8192;
+    m_maxTextureHeight = 8192;
+
+    m_target_screen = false;
+
+    updateViewport();
+
+    // Clean-up the in-game screen
+    clearBuffer();
+
+    setTargetScreen();
+
+    clearBuffer();
+
+    repaint();
+
+    return true;
+}
+
+void RenderSW::close()
+{
+    RenderSW::clearAllTextures();
+    AbstractRender_t::close();
+
+    m_render_queue.clear();
+
+    m_game_buffer.clear();
+    m_screen_buffer.clear();
+    m_screen_w = 0;
+    m_screen_h = 0;
+    m_target = nullptr;
+
+    m_window = nullptr;
+}
+
+void RenderSW::repaint()
+{
+#ifdef USE_RENDER_BLOCKING
+    if(m_blockRender)
+        return;
+#endif
+
+    if(XRender::g_BitmaskTexturePresent)
+        SuperPrintScreenCenter("Bitmasks using GIFs2PNG in CPU render", 5, 2, XTColorF(1.0f, 0.7f, 0.5f));
+    else if(g_ForceBitmaskMerge)
+        SuperPrintScreenCenter("GIFs2PNG always simulated in CPU render", 5, 2, XTColorF(1.0f, 0.7f, 0.5f));
+
+#ifdef USE_SCREENSHOTS_AND_RECS
+    if(TakeScreen)
+    {
+        makeShot();
+        PlaySoundMenu(SFX_GotItem);
+        TakeScreen = false;
+    }
+#endif
+
+    setTargetScreen();
+
+#ifdef PGE_ENABLE_VIDEO_REC
+    processRecorder();
+#endif
+
+    updateScreenBuffer();
+
+    flushRenderQueue();
+
+    // the in-game screen doesn't depend on the window size, so its dumps can be compared between machines
+    int64_t dump_frame = Record::FrameDumpNumber();
+    if(dump_frame >= 0)
+        dumpFrame(dump_frame);
+
+    std::fill(m_screen_buffer.begin(), m_screen_buffer.end(), 0xFF000000);
+
+    // Calculate the size difference factor
+    int wDst = int(m_scale_x * ScaleWidth);
+    int hDst = int(m_scale_y * ScaleHeight);
+
+    // Align the rendering scene to the center of screen
+    int off_x = (m_screen_w - wDst) / 2;
+    int off_y = (m_screen_h - hDst) / 2;
+
+    int x1 = SDL_max(off_x, 0);
+    int x2 = SDL_min(off_x + wDst, m_screen_w);
+    int y1 = SDL_max(off_y, 0);
+    int y2 = SDL_min(off_y + hDst, m_screen_h);
+
+    if(x1 < x2 && y1 < y2 && !m_game_buffer.empty())
+    {
+        m_columns.resize(x2 - x1);
+        for(int x = x1; x < x2; x++)
+            m_columns[x - x1] = s_sample(x - off_x, wDst, ScaleWidth);
+
+        for(int y = y1; y < y2; y++)
+        {
+            const uint32_t *src = m_game_buffer.data() + size_t(s_sample(y - off_y, hDst, ScaleHeight)) * ScaleWidth;
+            uint32_t *dst = m_screen_buffer.data() + size_t(y) * m_screen_w;
+
+            for(int x = x1; x < x2; x++)
+                dst[x] = src[m_columns[x - x1]];
+        }
+    }
+
+    Controls::RenderTouchControls();
+
+    flushRenderQueue();
+
+    SDL_Surface *surface = SDL_GetWindowSurface(m_window);
+    if(surface)
+    {
+        int w = SDL_min(surface->w, m_screen_w);
+        int h = SDL_min(surface->h, m_screen_h);
+
+        if(SDL_MUSTLOCK(surface))
+            SDL_LockSurface(surface);
+
+        SDL_ConvertPixels(w, h,
+                          SDL_PIXELFORMAT_ARGB8888, m_screen_buffer.data(), m_screen_w * 4,
+                          surface->format->format, surface->pixels, surface->pitch);
+
+        if(SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+
+        SDL_UpdateWindowSurface(m_window);
+    }
+
+    m_recent_draw_plane = 0;
+}
+
+void RenderSW::dumpFrame(int64_t frame)
+{
+    if(m_game_buffer.empty())
+        return;
+
+    const std::string &dir = Record::replay_frame_dump_dir;
+
+    if(!DirMan::exists(dir) && !DirMan::mkAbsPath(dir))
+    {
+        pLogWarning("Render SW: can't create the frame dump directory %s", dir.c_str());
+        Record::replay_frame_dump_dir.clear();
+        return;
+    }
+
+    FIBITMAP *image = FreeImage_Allocate(ScaleWidth, ScaleHeight, 32,
+                                         FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+    if(!image)
+        return;
+
+    uint8_t *bits = reinterpret_cast<uint8_t *>(FreeImage_GetBits(image));
+    uint32_t pitch = FreeImage_GetPitch(image);
+    uint32_t format = SDL_MasksToPixelFormatEnum(32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, FI_RGBA_ALPHA_MASK);
+
+    // FreeImage stores the rows bottom-up
+    for(int y = 0; y < ScaleHeight; y++)
+    {
+        SDL_ConvertPixels(ScaleWidth, 1,
+                          SDL_PIXELFORMAT_ARGB8888, m_game_buffer.data() + size_t(y) * ScaleWidth, ScaleWidth * 4,
+                          format, bits + size_t(ScaleHeight - 1 - y) * pitch, int(pitch));
+    }
+
+    std::string path = fmt::format_ne("{0}/frame-{1:06}.png", dir, frame);
+
+    if(!FreeImage_Save(FIF_PNG, image, path.c_str(), PNG_Z_BEST_COMPRESSION))
+        pLogWarning("Render SW: failed to write the frame dump %s", path.c_str());
+
+    FreeImage_Unload(image);
+}
+
+void RenderSW::updateViewport()
+{
+    flushRenderQueue();
+
+    int   render_w, render_h;
+
+    getRenderSize(&render_w, &render_h);
+
+    D_pLogDebug("Updated render size: %d x %d", render_w, render_h);
+
+    float scale_x = (float)render_w / XRender::TargetW;
+    float scale_y = (float)render_h / XRender::TargetH;
+
+    float scale = SDL_min(scale_x, scale_y);
+
+    if(g_config.scale_mode == Config_t::SCALE_FIXED_05X && scale > 0.5f)
+        scale = 0.5f;
+    if(g_config.scale_mode == Config_t::SCALE_DYNAMIC_INTEGER && scale > 1.f)
+        scale = std::floor(scale);
+    if(g_config.scale_mode == Config_t::SCALE_FIXED_1X && scale > 1.f)
+        scale = 1.f;
+    if(g_config.scale_mode == Config_t::SCALE_FIXED_2X && scale > 2.f)
+        scale = 2.f;
+
+    int game_w = scale * XRender::TargetW;
+    int game_h = scale * XRender::TargetH;
+
+    m_scale_x = scale;
+    m_scale_y = scale;
+    m_viewport_scale_x = scale;
+    m_viewport_scale_y = scale;
+
+    m_viewport_offset_x = 0;
+    m_viewport_offset_y = 0;
+    m_viewport_offset_x_cur = 0;
+    m_viewport_offset_y_cur = 0;
+    m_viewport_offset_ignore = false;
+
+    m_offset_x = (render_w - game_w) / 2;
+    m_offset_y = (render_h - game_h) / 2;
+
+    m_viewport_x = 0;
+    m_viewport_y = 0;
+    m_viewport_w = XRender::TargetW;
+    m_viewport_h = XRender::TargetH;
+
+    // update the in-game screen (always scaled by the nearest pixel)
+    if(ScaleWidth != XRender::TargetW || ScaleHeight != XRender::TargetH || m_game_buffer.empty())
+    {
+#ifdef PGE_ENABLE_VIDEO_REC
+        // invalidates GIF recorder handle
+        if(recordInProcess())
+            toggleGifRecorder();
+#endif
+
+        ScaleWidth = XRender::TargetW;
+        ScaleHeight = XRender::TargetH;
+
+        m_game_buffer.assign(size_t(ScaleWidth) * ScaleHeight, 0xFF000000);
+    }
+
+    updateScreenBuffer();
+    bindTarget();
+}
+
+void RenderSW::resetViewport()
+{
+    if(m_viewport_x == 0 && m_viewport_y == 0 && m_viewport_w == XRender::TargetW && m_viewport_h == XRender::TargetH)
+        return;
+
+    flushRenderQueue();
+
+    m_viewport_x = 0;
+    m_viewport_y = 0;
+    m_viewport_w = XRender::TargetW;
+    m_viewport_h = XRender::TargetH;
+
+    updateClip();
+}
+
+void RenderSW::setViewport(int x, int y, int w, int h)
+{
+    if(m_viewport_x == x && m_viewport_y == y && m_viewport_w == w && m_viewport_h == h)
+        return;
+
+    flushRenderQueue();
+
+    m_viewport_x = x;
+    m_viewport_y = y;
+    m_viewport_w = w;
+    m_viewport_h = h;
+
+    updateClip();
+}
+
+void RenderSW::offsetViewport(int x, int y)
+{
+    if(m_viewport_offset_x != x || m_viewport_offset_y != y)
+    {
+        m_viewport_offset_x_cur = x;
+        m_viewport_offset_y_cur = y;
+        m_viewport_offset_x = m_viewport_offset_ignore ? 0 : m_viewport_offset_x_cur;
+        m_viewport_offset_y = m_viewport_offset_ignore ? 0 : m_viewport_offset_y_cur;
+    }
+}
+
+void RenderSW::offsetViewportIgnore(bool en)
+{
+    if(m_viewport_offset_ignore != en)
+    {
+        m_viewport_offset_x = en ? 0 : m_viewport_offset_x_cur;
+        m_viewport_offset_y = en ? 0 : m_viewport_offset_y_cur;
+    }
+    m_viewport_offset_ignore = en;
+}
+
+void RenderSW::getRenderSize(int* w, int* h)
+{
+    // the window surface has the size of the window
+    SDL_GetWindowSize(m_window, w, h);
+}
+
+void RenderSW::mapToScreen(int x, int y, int *dx, int *dy)
+{
+    *dx = static_cast<int>((static_cast<float>(x) - m_offset_x) / m_viewport_scale_x);
+    *dy = static_cast<int>((static_cast<float>(y) - m_offset_y) / m_viewport_scale_y);
+}
+
+void RenderSW::mapFromScreen(int scr_x, int scr_y, int *window_x, int *window_y)
+{
+    *window_x = (float)scr_x * m_viewport_scale_x + m_offset_x;
+    *window_y = (float)scr_y * m_viewport_scale_y + m_offset_y;
+}
+
+void RenderSW::setTargetTexture()
+{
+    if(!m_target_screen)
+        return;
+
+    flushRenderQueue();
+
+    m_target_screen = false;
+    bindTarget();
+}
+
+void RenderSW::setTargetScreen()
+{
+    if(m_target_screen)
+        return;
+
+    flushRenderQueue();
+
+    m_target_screen = true;
+    bindTarget();
+}
+
+void RenderSW::setDrawPlane(uint8_t plane)
+{
+    m_recent_draw_plane = plane;
+}
+
+void RenderSW::bindTarget()
+{
+    if(m_target_screen)
+    {
+        m_target = m_screen_buffer.data();
+        m_target_w = m_screen_w;
+        m_target_h = m_screen_h;
+    }
+    else
+    {
+        m_target = m_game_buffer.data();
+        m_target_w = m_game_buffer.empty() ? 0 : ScaleWidth;
+        m_target_h = m_game_buffer.empty() ? 0 : ScaleHeight;
+    }
+
+    updateClip();
+}
+
+void RenderSW::updateClip()
+{
+    // the viewport only belongs to the in-game screen (the same way as the SDL render target resets it)
+    if(m_target_screen)
+    {
+        m_origin_x = 0;
+        m_origin_y = 0;
+        m_clip_x1 = 0;
+        m_clip_y1 = 0;
+        m_clip_x2 = m_target_w;
+        m_clip_y2 = m_target_h;
+        return;
+    }
+
+    m_origin_x = m_viewport_x;
+    m_origin_y = m_viewport_y;
+    m_clip_x1 = SDL_max(m_viewport_x, 0);
+    m_clip_y1 = SDL_max(m_viewport_y, 0);
+    m_clip_x2 = SDL_min(m_viewport_x + m_viewport_w, m_target_w);
+    m_clip_y2 = SDL_min(m_viewport_y + m_viewport_h, m_target_h);
+}
+
+void RenderSW::updateScreenBuffer()
+{
+    int w, h;
+    getRenderSize(&w, &h);
+
+    if(w == m_screen_w && h == m_screen_h)
+        return;
+
+    flushRenderQueue();
+
+    m_screen_w = w;
+    m_screen_h = h;
+    m_screen_buffer.assign(size_t(w) * h, 0xFF000000);
+
+    bindTarget();
+}
+
+void RenderSW::loadTextureInternal(StdPicture &target, uint32_t width, uint32_t height, uint8_t *RGBApixels, uint32_t pitch, uint32_t mask_width, uint32_t mask_height)
+{
+    UNUSED(mask_width);
+    UNUSED(mask_height);
+
+    uint32_t *pixels = new uint32_t[size_t(width) * height];
+
+    int res = SDL_ConvertPixels(static_cast<int>(width),
+                                static_cast<int>(height),
+                                SDL_MasksToPixelFormatEnum(32,
+                                                           FI_RGBA_RED_MASK,
+                                                           FI_RGBA_GREEN_MASK,
+                                                           FI_RGBA_BLUE_MASK,
+                                                           FI_RGBA_ALPHA_MASK),
+                                RGBApixels,
+                                static_cast<int>(pitch),
+                                SDL_PIXELFORMAT_ARGB8888,
+                                pixels,
+                                static_cast<int>(width * 4));
+
+    if(res < 0)
+    {
+        pLogWarning("Render SW: Failed to load texture! (%s)", SDL_GetError());
+        delete[] pixels;
+        target.inited = false;
+        return;
+    }
+
+    target.d.sw_pixels = pixels;
+    target.d.sw_w = static_cast<int>(width);
+    target.d.sw_h = static_cast<int>(height);
+
+    target.d.w_scale = static_cast<float>(width) / target.w;
+    target.d.h_scale = static_cast<float>(height) / target.h;
+
+    m_loadedPictures.insert(&target);
+    D_pLogDebug("RenderSW: loading texture at %p, new texture count %d...", &target, (int)m_loadedPictures.size());
+
+    target.inited = true;
+}
+
+void RenderSW::unloadTexture(StdPicture &tx)
+{
+    if(tx.d.atlas)
+    {
+        unloadAtlasPicture(tx);
+        return;
+    }
+
+    auto corpseIt = m_loadedPictures.find(&tx);
+    if(corpseIt != m_loadedPictures.end())
+        m_loadedPictures.erase(corpseIt);
+
+    D_pLogDebug("RenderSW: unloading texture at %p, new texture count %d...", &tx, (int)m_loadedPictures.size());
+
+    delete[] tx.d.sw_pixels;
+
+    tx.d = StdPictureData();
+
+    if(!tx.l.canLoad())
+        static_cast<StdPicture_Sub&>(tx) = StdPicture_Sub();
+}
+
+void RenderSW::clearAllTextures()
+{
+    clearTextureAtlases();
+
+    for(StdPicture *tx : m_loadedPictures)
+    {
+        D_pLogDebug("RenderSW: unloading texture at %p on clearAllTextures()", tx);
+
+        delete[] tx->d.sw_pixels;
+
+        tx->d = StdPictureData();
+
+        if(!tx->l.canLoad())
+            static_cast<StdPicture_Sub&>(*tx) = StdPicture_Sub();
+    }
+
+    m_loadedPictures.clear();
+}
+
+void RenderSW::clearBuffer()
+{
+#ifdef USE_RENDER_BLOCKING
+    SDL_assert(!m_blockRender);
+#endif
+    if(m_target)
+        std::fill(m_target, m_target + size_t(m_target_w) * m_target_h, 0xFF000000);
+
+    m_render_queue.clear();
+}
+
+void RenderSW::flushRenderQueue()
+{
+    if(!m_render_queue.size)
+        return;
+
+    m_render_queue.sort();
+
+    for(uint32_t i : m_render_queue.indices)
+        execute(m_render_queue.ops[i & 0xFFFF]);
+
+    m_render_queue.clear();
+}
+
+void RenderSW::blendRow(int y, int x1, int x2, const uint32_t *span, XTColor color)
+{
+    s_blendRow(m_target + size_t(y) * m_target_w + x1, span, x2 - x1, color);
+}
+
+void RenderSW::fillRect(int x1, int y1, int x2, int y2, XTColor color)
+{
+    x1 = SDL_max(x1, m_clip_x1);
+    y1 = SDL_max(y1, m_clip_y1);
+    x2 = SDL_min(x2, m_clip_x2);
+    y2 = SDL_min(y2, m_clip_y2);
+
+    if(x1 >= x2 || y1 >= y2)
+        return;
+
+    const uint32_t px = s_packColor(color);
+
+    // gives the same result as blending
+    if(color.a == 255)
+    {
+        for(int y = y1; y < y2; y++)
+            std::fill(m_target + size_t(y) * m_target_w + x1, m_target + size_t(y) * m_target_w + x2, px);
+
+        return;
+    }
+
+    m_span.assign(size_t(x2 - x1), px);
+
+    for(int y = y1; y < y2; y++)
+        blendRow(y, x1, x2, m_span.data(), XTColor());
+}
+
+void RenderSW::drawLine(int x1, int x2, int y, XTColor color)
+{
+    if(x1 > x2)
+        std::swap(x1, x2);
+
+    fillRect(x1 + m_origin_x, y + m_origin_y, x2 + 1 + m_origin_x, y + 1 + m_origin_y, color);
+}
+
+void RenderSW::drawTexture(const RenderOp &op)
+{
+    const StdPicture &tx = *op.texture;
+
+    // the picture may be a part of the atlas page's pixels
+    const StdPictureData &page = tx.d.atlas ? tx.d.atlas->d : tx.d;
+
+    if(!page.sw_pixels)
+    {
+        D_pLogWarningNA("Attempt to render an empty texture!");
+        return;
+    }
+
+    int xSrc = 0, ySrc = 0;
+    int wSrc = page.sw_w, hSrc = page.sw_h;
+
+    if(op.traits & RenderOp::Traits::src_rect)
+    {
+        xSrc = op.xSrc;
+        ySrc = op.ySrc;
+        wSrc = op.wSrc;
+        hSrc = op.hSrc;
+    }
+    else if(tx.d.atlas)
+    {
+        wSrc = int(tx.d.w_scale * tx.w);
+        hSrc = int(tx.d.h_scale * tx.h);
+    }
+
+    if(tx.d.atlas)
+    {
+        xSrc += int(tx.d.atlas_x);
+        ySrc += int(tx.d.atlas_y);
+    }
+
+    const int xDst = op.xDst + m_origin_x;
+    const int yDst = op.yDst + m_origin_y;
+    const int wDst = op.wDst;
+    const int hDst = op.hDst;
+
+    if(wSrc <= 0 || hSrc <= 0 || wDst <= 0 || hDst <= 0)
+        return;
+
+    const bool flip_x = op.traits & RenderOp::Traits::flip_X;
+    const bool flip_y = op.traits & RenderOp::Traits::flip_Y;
+
+    const int max_x = page.sw_w - 1;
+    const int max_y = page.sw_h - 1;
+
+    if((op.traits & RenderOp::Traits::rotation) && op.angle != 0)
+    {
+        // rotates clockwise around the center of the destination rect, after the flip (the same as SDL_RenderCopyEx)
+        //   everything is exact 16.16 fixed point
+        const int64_t c = s_cos16(op.angle);
+        const int64_t s = s_sin16(op.angle);
+
+        const int64_t cx = int64_t(2 * xDst + wDst) << 15;
+        const int64_t cy = int64_t(2 * yDst + hDst) << 15;
+
+        const int64_t half_w = (std::abs(c) * wDst + std::abs(s) * hDst) >> 1;
+        const int64_t half_h = (std::abs(s) * wDst + std::abs(c) * hDst) >> 1;
+
+        const int x1 = SDL_max(int((cx - half_w) >> 16), m_clip_x1);
+        const int x2 = SDL_min(int(((cx + half_w) >> 16) + 1), m_clip_x2);
+        const int y1 = SDL_max(int((cy - half_h) >> 16), m_clip_y1);
+        const int y2 = SDL_min(int(((cy + half_h) >> 16) + 1), m_clip_y2);
+
+        if(x1 >= x2 || y1 >= y2)
+            return;
+
+        const int64_t lw = int64_t(wDst) << 16;
+        const int64_t lh = int64_t(hDst) << 16;
+
+        m_span.resize(x2 - x1);
+
+        for(int y = y1; y < y2; y++)
+        {
+            const int64_t dx = (int64_t(2 * x1 + 1) << 15) - cx;
+            const int64_t dy = (int64_t(2 * y + 1) << 15) - cy;
+
+            // position of the pixel center at the unrotated destination rect
+            int64_t u = ((c * dx + s * dy) >> 16) + (lw >> 1);
+            int64_t v = ((c * dy - s * dx) >> 16) + (lh >> 1);
+
+            for(int k = 0; k < x2 - x1; k++, u += c, v -= s)
+            {
+                if(u < 0 || u >= lw || v < 0 || v >= lh)
+                {
+                    m_span[k] = 0;
+                    continue;
+                }
+
+                int i = int(u >> 16);
+                int j = int(v >> 16);
+
+                if(flip_x)
+                    i = wDst - 1 - i;
+                if(flip_y)
+                    j = hDst - 1 - j;
+
+                const int col = s_clamp(xSrc + s_sample(i, wDst, wSrc), max_x);
+                const int row = s_clamp(ySrc + s_sample(j, hDst, hSrc), max_y);
+
+                m_span[k] = page.sw_pixels[size_t(row) * page.sw_w + col];
+            }
+
+            blendRow(y, x1, x2, m_span.data(), op.color);
+        }
+
+        return;
+    }
+
+    const int x1 = SDL_max(xDst, m_clip_x1);
+    const int x2 = SDL_min(xDst + wDst, m_clip_x2);
+    const int y1 = SDL_max(yDst, m_clip_y1);
+    const int y2 = SDL_min(yDst + hDst, m_clip_y2);
+
+    if(x1 >= x2 || y1 >= y2)
+        return;
+
+    // unscaled rows are blended straight from the picture (s_sample() is the identity for them)
+    const bool direct = !flip_x && wSrc == wDst
+                        && xSrc + (x1 - xDst) >= 0 && xSrc + (x2 - xDst) <= page.sw_w;
+
+    if(!direct)
+    {
+        m_columns.resize(x2 - x1);
+        m_span.resize(x2 - x1);
+
+        for(int x = x1; x < x2; x++)
+        {
+            int i = x - xDst;
+
+            if(flip_x)
+                i = wDst - 1 - i;
+
+            m_columns[x - x1] = s_clamp(xSrc + s_sample(i, wDst, wSrc), max_x);
+        }
+    }
+
+    for(int y = y1; y < y2; y++)
+    {
+        int j = y - yDst;
+
+        if(flip_y)
+            j = hDst - 1 - j;
+
+        const uint32_t *src = page.sw_pixels + size_t(s_clamp(ySrc + s_sample(j, hDst, hSrc), max_y)) * page.sw_w;
+
+        if(direct)
+        {
+            blendRow(y, x1, x2, src + xSrc + (x1 - xDst), op.color);
+            continue;
+        }
+
+        for(int k = 0; k < x2 - x1; k++)
+            m_span[k] = src[m_columns[k]];
+
+        blendRow(y, x1, x2, m_span.data(), op.color);
+    }
+}
+
+void RenderSW::execute(const RenderOp& op)
+{
+#ifdef USE_RENDER_BLOCKING
+    SDL_assert(!m_blockRender);
+#endif
+
+    if(!m_target)
+        return;
+
+    switch(op.type)
+    {
+    case RenderOp::Type::rect:
+    {
+        if(op.wDst <= 0 || op.hDst <= 0)
+            break;
+
+        const int x1 = op.xDst + m_origin_x;
+        const int y1 = op.yDst + m_origin_y;
+        const int x2 = x1 + op.wDst;
+        const int y2 = y1 + op.hDst;
+
+        if(op.traits & RenderOp::Traits::filled)
+        {
+            fillRect(x1, y1, x2, y2, op.color);
+            break;
+        }
+
+        fillRect(x1, y1, x2, y1 + 1, op.color);
+
+        if(op.hDst > 1)
+            fillRect(x1, y2 - 1, x2, y2, op.color);
+
+        if(op.hDst > 2)
+        {
+            fillRect(x1, y1 + 1, x1 + 1, y2 - 1, op.color);
+
+            if(op.wDst > 1)
+                fillRect(x2 - 1, y1 + 1, x2, y2 - 1, op.color);
+        }
+
+        break;
+    }
+
+    case RenderOp::Type::circle:
+    {
+        int radius = op.radius();
+
+        int dy = 1;
+        do //for(double dy = 1; dy <= radius; dy += 1.0)
+        {
+            int dx = std::floor(std::sqrt((2 * radius * dy) - (dy * dy)));
+            drawLine(op.xDst - dx, op.xDst + dx, op.yDst + dy - radius, op.color);
+
+            if(dy < radius) // Don't cross lines
+                drawLine(op.xDst - dx, op.xDst + dx, op.yDst - dy + radius, op.color);
+
+            dy += 1;
+        } while(dy <= radius);
+
+        break;
+    }
+
+    case RenderOp::Type::circle_hole:
+    {
+        int radius = op.radius();
+
+        int dy = 1;
+        do //for(double dy = 1; dy <= radius; dy += 1.0)
+        {
+            int dx = std::floor(std::sqrt((2 * radius * dy) - (dy * dy)));
+
+            drawLine(op.xDst - radius, op.xDst - dx, op.yDst + dy - radius, op.color);
+            drawLine(op.xDst + dx, op.xDst + radius, op.yDst + dy - radius, op.color);
+
+            if(dy < radius) // Don't cross lines
+            {
+                drawLine(op.xDst - radius, op.xDst - dx, op.yDst - dy + radius, op.color);
+                drawLine(op.xDst + dx, op.xDst + radius, op.yDst - dy + radius, op.color);
+            }
+
+            dy += 1;
+        } while(dy <= radius);
+
+        break;
+    }
+
+
+    case RenderOp::Type::texture:
+    {
+        if(!op.texture || !op.texture->inited)
+            break;
+
+        drawTexture(op);
+
+        break;
+    }
+
+    default:
+        SDL_assert_release(false); // illegal render op type!
+        break;
+    }
+}
+
+void RenderSW::renderRect(int x, int y, int w, int h, XTColor color, bool filled)
+{
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::rect;
+    op.xDst = x + m_viewport_offset_x;
+    op.yDst = y + m_viewport_offset_y;
+    op.wDst = w;
+    op.hDst = h;
+
+    op.color = color;
+
+    if(filled)
+        op.traits = RenderOp::Traits::filled;
+    else
+        op.traits = 0;
+}
+
+void RenderSW::renderRectBR(int _left, int _top, int _right, int _bottom, XTColor color)
+{
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::rect;
+    op.xDst = _left + m_viewport_offset_x;
+    op.yDst = _top + m_viewport_offset_y;
+    op.wDst = _right - _left;
+    op.hDst = _bottom - _top;
+
+    op.color = color;
+
+    op.traits = RenderOp::Traits::filled;
+}
+
+void RenderSW::renderCircle(int cx, int cy, int radius, XTColor color, bool filled)
+{
+    if(radius <= 0)
+        return; // Nothing to draw
+
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::circle;
+    op.xDst = cx + m_viewport_offset_x;
+    op.yDst = cy + m_viewport_offset_y;
+    op.radius() = radius;
+
+    op.color = color;
+
+    if(filled)
+        op.traits = RenderOp::Traits::filled;
+    else
+        op.traits = 0;
+}
+
+void RenderSW::renderCircleHole(int cx, int cy, int radius, XTColor color)
+{
+    if(radius <= 0)
+        return; // Nothing to draw
+
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::circle_hole;
+    op.xDst = cx + m_viewport_offset_x;
+    op.yDst = cy + m_viewport_offset_y;
+    op.radius() = radius;
+
+    op.color = color;
+}
+
+
+
+void RenderSW::renderTextureScaleEx(double xDstD, double yDstD, double wDstD, double hDstD,
+                                       StdPicture &tx,
+                                       int xSrc, int ySrc,
+                                       int wSrc, int hSrc,
+                                       double rotateAngle, FPoint_t *center, unsigned int flip,
+                                       XTColor color)
+{
+    if(!tx.inited)
+        return;
+
+    if(!tx.d.sw_pixels && tx.l.lazyLoaded)
+        lazyLoad(tx);
+
+    if(!tx.d.sw_pixels)
+    {
+        D_pLogWarningNA("Attempt to render an empty texture!");
+        return;
+    }
+
+    // Don't go more than size of texture
+    if(xSrc + wSrc > tx.w)
+    {
+        wSrc = tx.w - xSrc;
+        if(wSrc < 0)
+            return;
+    }
+    if(ySrc + hSrc > tx.h)
+    {
+        hSrc = tx.h - ySrc;
+        if(hSrc < 0)
+            return;
+    }
+
+
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::texture;
+    op.texture = &tx;
+
+    op.xDst = Maths::iRound(xDstD) + m_viewport_offset_x;
+    op.yDst = Maths::iRound(yDstD) + m_viewport_offset_y;
+    op.wDst = Maths::iRound(wDstD);
+    op.hDst = Maths::iRound(hDstD);
+
+    op.xSrc = tx.d.w_scale * xSrc;
+    op.ySrc = tx.d.h_scale * ySrc;
+    op.wSrc = tx.d.w_scale * wSrc;
+    op.hSrc = tx.d.h_scale * hSrc;
+
+    op.color = color;
+
+    op.traits = (flip & 3) | RenderOp::Traits::src_rect;
+    op.angle = 0;
+
+    if(rotateAngle != 0.)
+    {
+        op.traits |= RenderOp::Traits::rotation;
+        // negative angles wrap around (a negative double can't be converted to an unsigned integer directly)
+        op.angle = (uint16_t)(int32_t)(std::fmod(rotateAngle, 360.) * (65536. / 360.));
+
+        // calculate new offset now, in the same fixed point as the rotation itself
+        if(center)
+        {
+            const int64_t orig_offsetX = (int64_t)std::floor((wDstD / 2 - center->x) * 65536. + 0.5);
+            const int64_t orig_offsetY = (int64_t)std::floor((hDstD / 2 - center->y) * 65536. + 0.5);
+            const int64_t sin_theta = -s_sin16(op.angle);
+            const int64_t cos_theta = s_cos16(op.angle);
+
+            const int64_t rot_offsetX = (orig_offsetX * cos_theta - orig_offsetY * sin_theta) >> 16;
+            const int64_t rot_offsetY = (orig_offsetX * sin_theta + orig_offsetY * cos_theta) >> 16;
+
+            const double shiftX = double(rot_offsetX - orig_offsetX) / 65536.;
+            const double shiftY = double(rot_offsetY - orig_offsetY) / 65536.;
+
+            op.xDst = Maths::iRound(xDstD + shiftX) + m_viewport_offset_x;
+            op.yDst = Maths::iRound(yDstD + shiftY) + m_viewport_offset_y;
+        }
+    }
+}
+
+void RenderSW::renderTextureScale(double xDst, double yDst, double wDst, double hDst,
+                                     StdPicture &tx,
+                                     XTColor color)
+{
+    if(!tx.inited)
+        return;
+
+    if(!tx.d.sw_pixels && tx.l.lazyLoaded)
+        lazyLoad(tx);
+
+    if(!tx.d.sw_pixels)
+    {
+        D_pLogWarningNA("Attempt to render an empty texture!");
+        return;
+    }
+
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::texture;
+    op.traits = 0;
+
+    op.texture = &tx;
+
+    op.xDst = Maths::iRound(xDst) + m_viewport_offset_x;
+    op.yDst = Maths::iRound(yDst) + m_viewport_offset_y;
+    op.wDst = Maths::iRound(wDst);
+    op.hDst = Maths::iRound(hDst);
+
+    op.color = color;
+}
+
+void RenderSW::renderTexture(double xDstD, double yDstD, double wDstD, double hDstD,
+                                StdPicture &tx,
+                                int xSrc, int ySrc,
+                                XTColor color)
+{
+    if(!tx.inited)
+        return;
+
+    if(!tx.d.sw_pixels && tx.l.lazyLoaded)
+        lazyLoad(tx);
+
+    if(!tx.d.sw_pixels)
+    {
+        D_pLogWarningNA("Attempt to render an empty texture!");
+        return;
+    }
+
+    int wDst = Maths::iRound(wDstD);
+    int hDst = Maths::iRound(hDstD);
+
+    // Don't go more than size of texture
+    if(xSrc + wDst > tx.w)
+    {
+        wDst = tx.w - xSrc;
+        if(wDst < 0)
+            return;
+    }
+    if(ySrc + hDst > tx.h)
+    {
+        hDst = tx.h - ySrc;
+        if(hDst < 0)
+            return;
+    }
+
+
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::texture;
+    op.traits = RenderOp::Traits::src_rect;
+
+    op.texture = &tx;
+
+    op.xDst = Maths::iRound(xDstD) + m_viewport_offset_x;
+    op.yDst = Maths::iRound(yDstD) + m_viewport_offset_y;
+    op.wDst = wDst;
+    op.hDst = hDst;
+
+    op.xSrc = tx.d.w_scale * xSrc;
+    op.ySrc = tx.d.h_scale * ySrc;
+    op.wSrc = tx.d.w_scale * wDst;
+    op.hSrc = tx.d.h_scale * hDst;
+
+    op.color = color;
+}
+
+void RenderSW::renderTextureFL(double xDstD, double yDstD, double wDstD, double hDstD,
+                                  StdPicture &tx,
+                                  int xSrc, int ySrc,
+                                  double rotateAngle, FPoint_t *center, unsigned int flip,
+                                  XTColor color)
+{
+    renderTextureScaleEx(xDstD, yDstD, wDstD, hDstD,
+                         tx,
+                         xSrc, ySrc,
+                         Maths::iRound(wDstD), Maths::iRound(hDstD),
+                         rotateAngle, center, flip,
+                         color);
+}
+
+void RenderSW::renderTexture(float xDst, float yDst,
+                                StdPicture &tx,
+                                XTColor color)
+{
+#ifdef USE_RENDER_BLOCKING
+    SDL_assert(!m_blockRender);
+#endif
+
+    if(!tx.inited)
+        return;
+
+    if(!tx.d.sw_pixels && tx.l.lazyLoaded)
+        lazyLoad(tx);
+
+    if(!tx.d.sw_pixels)
+    {
+        D_pLogWarningNA("Attempt to render an empty texture!");
+        return;
+    }
+
+    RenderOp& op = m_render_queue.push(m_recent_draw_plane);
+
+    op.type = RenderOp::Type::texture;
+    op.traits = 0;
+
+    op.texture = &tx;
+
+    op.xDst = Maths::iRound(xDst) + m_viewport_offset_x;
+    op.yDst = Maths::iRound(yDst) + m_viewport_offset_y;
+    op.wDst = tx.w;
+    op.hDst = tx.h;
+
+    op.color = color;
+}
+
+void RenderSW::getScreenPixels(int x, int y, int w, int h, unsigned char *pixels)
+{
+    flushRenderQueue();
+
+    if(!m_target || x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > m_target_w || y + h > m_target_h)
+        return;
+
+    SDL_ConvertPixels(w, h,
+                      SDL_PIXELFORMAT_ARGB8888, m_target + size_t(y) * m_target_w + x, m_target_w * 4,
+                      SDL_PIXELFORMAT_BGR24, pixels, w * 3 + (w % 4));
+}
+
+void RenderSW::getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels)
+{
+    flushRenderQueue();
+
+    if(!m_target || x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > m_target_w || y + h > m_target_h)
+        return;
+
+    SDL_ConvertPixels(w, h,
+                      SDL_PIXELFORMAT_ARGB8888, m_target + size_t(y) * m_target_w + x, m_target_w * 4,
+                      SDL_PIXELFORMAT_ABGR8888, pixels, w * 4);
+}
+
+int RenderSW::getPixelDataSize(const StdPicture &tx)
+{
+    if(!tx.d.sw_pixels)
+        return 0;
+
+    return int(tx.d.w_scale * tx.w) * int(tx.d.h_scale * tx.h) * 4;
+}
+
+void RenderSW::getPixelData(const StdPicture &tx, unsigned char *pixelData)
+{
+    if(!tx.d.sw_pixels)
+        return;
+
+    const StdPictureData &page = tx.d.atlas ? tx.d.atlas->d : tx.d;
+
+    const int w = int(tx.d.w_scale * tx.w);
+    const int h = int(tx.d.h_scale * tx.h);
+    const int x = tx.d.atlas ? int(tx.d.atlas_x) : 0;
+    const int y = tx.d.atlas ? int(tx.d.atlas_y) : 0;
+
+    for(int row = 0; row < h; row++)
+        std::memcpy(pixelData + size_t(row) * w * 4, page.sw_pixels + size_t(y + row) * page.sw_w + x, size_t(w) * 4);
+}
@@ -0,0 +1,306 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef RENDERSW_T_H
+#define RENDERSW_T_H
+
+#include <set>
+#include <vector>
+
+#include "../base/render_base.h"
+#include "cmd_line_setup.h"
+#include "config.h"
+
+#include "core/sdl/render_op_sdl.h"
+
+struct SDL_Window;
+
+/*!
+ * \brief Render that rasterizes everything at the CPU into plain memory buffers
+ *
+ * Uses the same render op queue as the SDL render, and only shows the result at the window's surface.
+ * All math is integer (rotations use a fixed-point sine table instead of libm), so the same frame gives the same pixels
+ * on every machine, including headless ones (such as the SDL's dummy video driver).
+ */
+class RenderSW final : public AbstractRender_t
+{
+    SDL_Window   *m_window = nullptr;
+
+    // in-game screen (ARGB8888), plays the role of the render target texture
+    std::vector<uint32_t> m_game_buffer;
+    // window-sized screen (ARGB8888) which gets shown at the window surface
+    std::vector<uint32_t> m_screen_buffer;
+    int m_screen_w = 0;
+    int m_screen_h = 0;
+
+    // currently drawn buffer
+    bool      m_target_screen = true;
+    uint32_t *m_target = nullptr;
+    int       m_target_w = 0;
+    int       m_target_h = 0;
+
+    // clip rectangle (target pixels, right and bottom are exclusive) and origin of the current viewport
+    int m_clip_x1 = 0;
+    int m_clip_y1 = 0;
+    int m_clip_x2 = 0;
+    int m_clip_y2 = 0;
+    int m_origin_x = 0;
+    int m_origin_y = 0;
+
+    // scratch row of source pixels and of source columns
+    std::vector<uint32_t> m_span;
+    std::vector<int> m_columns;
+
+    std::set<StdPicture *> m_loadedPictures;
+
+    // queue of render ops
+    RenderQueue m_render_queue;
+
+    // current draw plane
+    uint8_t m_recent_draw_plane = 0;
+
+    // Scale of virtual and window resolutuins
+    float m_scale_x = 1.f;
+    float m_scale_y = 1.f;
+    // Side offsets to keep ratio
+    float m_offset_x = 0.f;
+    float m_offset_y = 0.f;
+    // Offset to shake screen
+    int m_viewport_offset_x = 0;
+    int m_viewport_offset_y = 0;
+    // Keep zero viewport offset while this flag is on
+    bool m_viewport_offset_ignore = false;
+    // Carried set value for viewport offset (used to preserve values while ignore option is on)
+    int m_viewport_offset_x_cur = 0;
+    int m_viewport_offset_y_cur = 0;
+
+    // Need to calculate relative viewport position when screen was scaled
+    float m_viewport_scale_x = 1.0f;
+    float m_viewport_scale_y = 1.0f;
+
+    int m_viewport_x = 0;
+    int m_viewport_y = 0;
+    int m_viewport_w = 0;
+    int m_viewport_h = 0;
+
+    // points m_target to the current buffer and updates the clip rectangle
+    void bindTarget();
+    void updateClip();
+
+    // resizes the window-sized screen to the current render size
+    void updateScreenBuffer();
+
+    // blends a row of source pixels (starting at x1 of the target) into the target
+    void blendRow(int y, int x1, int x2, const uint32_t *span, XTColor color);
+
+    // fills a rectangle of the target (right and bottom are exclusive)
+    void fillRect(int x1, int y1, int x2, int y2, XTColor color);
+
+    // draws a horizontal line at viewport coordinates (both ends are inclusive)
+    void drawLine(int x1, int x2, int y, XTColor color);
+
+    void drawTexture(const RenderOp &op);
+
+    // writes the in-game screen into a PNG file of the replay frame dump
+    void dumpFrame(int64_t frame);
+
+public:
+    RenderSW();
+    ~RenderSW() override;
+
+
+    unsigned int SDL_InitFlags() override;
+
+    bool isWorking() override;
+
+    bool initRender(SDL_Window *window) override;
+
+    /*!
+     * \brief Close the renderer
+     */
+    void close() override;
+
+    /*!
+     * \brief Call the repaint
+     */
+    void repaint() override;
+
+    /*!
+     * \brief Update viewport (mainly after screen resize)
+     */
+    void updateViewport() override;
+
+    /*!
+     * \brief Reset viewport into default state
+     */
+    void resetViewport() override;
+
+    /*!
+     * \brief Set the viewport area
+     * \param x X position
+     * \param y Y position
+     * \param w Viewport Width
+     * \param h Viewport Height
+     */
+    void setViewport(int x, int y, int w, int h) override;
+
+    /*!
+     * \brief Set the render offset
+     * \param x X offset
+     * \param y Y offset
+     *
+     * All drawing objects will be drawn with a small offset
+     */
+    void offsetViewport(int x, int y) override; // for screen-shaking
+
+    /*!
+     * \brief Set temporary ignore of render offset
+     * \param en Enable viewport offset ignore
+     *
+     * Use this to draw certain objects with ignorign of the GFX offset
+     */
+    void offsetViewportIgnore(bool en) override;
+
+    /*!
+     * \brief Maps from cursor coordinates to game screen coordinates
+     */
+    void mapToScreen(int x, int y, int *dx, int *dy) override;
+
+    /*!
+     * \brief Maps from game screen coordinates to cursor coordinates
+     */
+    void mapFromScreen(int x, int y, int *dx, int *dy) override;
+
+    /*!
+     * \brief Get the current size of the window in render pixels
+     * \param w Width
+     * \param h Height
+     */
+    void getRenderSize(int *w, int *h) override;
+
+    /*!
+     * \brief Set render target into the virtual in-game screen (use to render in-game world)
+     */
+    void setTargetTexture() override;
+
+    /*!
+     * \brief Set render target into the real window or screen (use to render on-screen buttons and other meta-info)
+     */
+    void setTargetScreen() override;
+
+    /*!
+     * \brief Sets draw plane for subsequent draws.
+     *
+     * \param plane Which draw plane should be used.
+     */
+    void setDrawPlane(uint8_t plane) override;
+
+
+    void loadTextureInternal(StdPicture &target,
+                     uint32_t width,
+                     uint32_t height,
+                     uint8_t *RGBApixels,
+                     uint32_t pitch,
+                     uint32_t mask_width,
+                     uint32_t mask_height) override;
+
+    void unloadTexture(StdPicture &tx) override;
+    void clearAllTextures() override;
+
+    void clearBuffer() override;
+
+
+
+    /*!
+     * \brief Immediately executes all render operations and clears render queue
+     */
+    void flushRenderQueue();
+
+    /*!
+     * \brief Immediately executes a single render operation
+     */
+    void execute(const RenderOp& op);
+
+    // Draw primitives
+
+    void renderRect(int x, int y, int w, int h,
+                    XTColor color = XTColor(),
+                    bool filled = true) override;
+
+    void renderRectBR(int _left, int _top, int _right,
+                      int _bottom, XTColor color) override;
+
+    void renderCircle(int cx, int cy,
+                      int radius,
+                      XTColor color = XTColor(),
+                      bool filled = true) override;
+
+    void renderCircleHole(int cx, int cy,
+                          int radius,
+                          XTColor color = XTColor()) override;
+
+
+
+
+    // Draw texture
+
+    void renderTextureScaleEx(double xDst, double yDst, double wDst, double hDst,
+                              StdPicture &tx,
+                              int xSrc, int ySrc,
+                              int wSrc, int hSrc,
+                              double rotateAngle =.0, FPoint_t *center = nullptr, unsigned int flip = X_FLIP_NONE,
+                              XTColor color = XTColor()) override;
+
+    void renderTextureScale(double xDst, double yDst, double wDst, double hDst,
+                            StdPicture &tx,
+                            XTColor color = XTColor()) override;
+
+    void renderTexture(double xDst, double yDst, double wDst, double hDst,
+                       StdPicture &tx,
+                       int xSrc, int ySrc,
+                       XTColor color = XTColor()) override;
+
+    void renderTextureFL(double xDst, double yDst, double wDst, double hDst,
+                         StdPicture &tx,
+                         int xSrc, int ySrc,
+                         double rotateAngle =.0, FPoint_t *center = nullptr, unsigned int flip = X_FLIP_NONE,
+                         XTColor color = XTColor()) override;
+
+    void renderTexture(float xDst, float yDst, StdPicture &tx,
+                       XTColor color = XTColor()) override;
+
+
+
+
+    // Retrieve raw pixel data
+
+    void getScreenPixels(int x, int y, int w, int h, unsigned char *pixels) override;
+
+    void getScreenPixelsRGBA(int x, int y, int w, int h, unsigned char *pixels) override;
+
+    int  getPixelDataSize(const StdPicture &tx) override;
+
+    void getPixelData(const StdPicture &tx, unsigned char *pixelData) override;
+
+};
+
+
+#endif // RENDERSW_T_H
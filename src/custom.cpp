@@ -26,6 +26,7 @@
 
 #include "custom.h"
 #include "config.h"
+#include "npc.h"
 #include "npc_traits.h"
 #include "npc_id.h"
 #include "blk_id.h"
@@ -191,6 +192,8 @@ void SaveNPCDefaults()
 
         s_NPCDefaults.NPCTraits[A] = NPCTraits[A];
     }
+
+    InvalidateNPCFrameTable();
 }
 
 void LoadNPCDefaults()
@@ -199,6 +202,8 @@ void LoadNPCDefaults()
     for(A = 1; A <= maxNPCType; A++)
         NPCTraits[A] = s_NPCDefaults.NPCTraits[A];
 
+    InvalidateNPCFrameTable();
+
     BlockWidth[BLKID_CONVEYOR_L_CONV] = 32;
     BlockWidth[BLKID_CONVEYOR_R_CONV] = 32;
     BlockHeight[BLKID_CONVEYOR_L_CONV] = 32;
@@ -357,6 +362,8 @@ void FindCustomNPCs(/*std::string cFilePath*/)
         if(!npcPathC.empty())
             LoadCustomNPC(A, npcPathC);
     }
+
+    InvalidateNPCFrameTable();
 }
 
 void LoadCustomNPC(int A, std::string cFileName)
@@ -865,7 +865,7 @@ void NewEffect(int A, const Location_t &Location, int Direction, int NewNpc, boo
     bool tempBool = false;
     double tempDoub = 0;
 
-    if(numEffects >= maxEffects - 4)
+    if(numEffects >= EffectLimit() - 4)
         return;
 
     if(A == 1 || A == 21 || A == 30 || A == 51 || A == 100 || A == 135) // Block break effect
@@ -1269,7 +1269,7 @@ void NewEffect(int A, const Location_t &Location, int Direction, int NewNpc, boo
     {
         for(B = 1; B <= 4; B++)
         {
-            if(numEffects < maxEffects)
+            if(numEffects < EffectLimit())
             {
                 numEffects++;
                 auto &ne = Effect[numEffects];
@@ -1299,7 +1299,7 @@ void NewEffect(int A, const Location_t &Location, int Direction, int NewNpc, boo
     {
         for(B = 1; B <= 4; B++)
         {
-            if(numEffects < maxEffects)
+            if(numEffects < EffectLimit())
             {
                 numEffects++;
                 auto &ne = Effect[numEffects];
@@ -1342,7 +1342,7 @@ void NewEffect(int A, const Location_t &Location, int Direction, int NewNpc, boo
     {
         for(B = 1; B <= 6; B++)
         {
-            if(numEffects < maxEffects)
+            if(numEffects < EffectLimit())
             {
                 numEffects++;
                 auto &ne = Effect[numEffects];
@@ -1393,7 +1393,7 @@ void NewEffect(int A, const Location_t &Location, int Direction, int NewNpc, boo
     {
         for(B = 1; B <= 6; B++)
         {
-            if(numEffects < maxEffects)
+            if(numEffects < EffectLimit())
             {
                 numEffects++;
                 auto &ne = Effect[numEffects];
@@ -1953,6 +1953,12 @@ void NewEffect(int A, const Location_t &Location, int Direction, int NewNpc, boo
     }
 }
 
+// Maximum number of effects (the extended limit is on by default, and off in compat mode)
+int EffectLimit()
+{
+    return g_config.extended_effect_limit ? maxEffects : maxEffectsClassic;
+}
+
 // Remove the effect
 void KillEffect(int A)
 {
@@ -34,6 +34,8 @@ void NewEffect(int A, const Location_t &Location_t, int Direction = 1, int NewNp
 // Public Sub KillEffect(A As Integer) 'Remove the effect
 // Remove the effect
 void KillEffect(int A);
+// NEW: current limit on the number of effects (maxEffectsClassic unless the extended-effect-limit compat option is set)
+int EffectLimit();
 
 
 #endif // EFFECT_H
@@ -33,6 +33,7 @@
 #include "core/events.h"
 
 #include "npc/npc_queues.h"
+#include "main/record.h"
 
 // heap info for min console ports
 #if defined(__16M__) || defined(__3DS__) // || defined(__WII__)
@@ -405,7 +406,7 @@ struct TimeStore
 };
 
 static TimeStore         s_overheadTimes;
-static const  nanotime_t c_frameRateNano = 1000000000.0 / 64.1025;
+static const  nanotime_t c_frameRateNano = 1000000000.0 / c_gameFramesPerSecond;
 static nanotime_t        s_oldTime = 0,
                          s_overhead = 0;
 #ifdef USE_NEW_FRAMESKIP
@@ -481,7 +482,7 @@ extern void CheckActive(); // game_main.cpp
 
 static inline bool canProcessFrameCond()
 {
-    bool ret = s_currentTicks >= s_gameTime + c_frameRate || s_currentTicks < s_gameTime || g_config.unlimited_framerate;
+    bool ret = s_currentTicks >= s_gameTime + c_frameRate || s_currentTicks < s_gameTime || g_config.unlimited_framerate || Record::FastForwarding();
 #ifdef USE_NEW_FRAMESKIP
     if(ret && s_doUpdate <= 0)
         s_startProcessing = getNanoTime();
@@ -578,7 +579,8 @@ static inline void computeFrameTime2Real_2()
         s_fpsCount = 0;
     }
 
-    if(!g_config.unlimited_framerate)
+    // fast-forwarded replays only wait after every Nth frame (or never)
+    if(!g_config.unlimited_framerate && !Record::FastForwardNoDelay())
     {
         nanotime_t start = getNanoTime();
         nanotime_t sleepTime = getSleepTime(s_oldTime, c_frameRateNano);
@@ -604,7 +606,9 @@ static inline void computeFrameTime2Real_2()
         }
     }
 
-    s_oldTime = getNanoTime();
+    // keep the time of the last delay, so that N fast-forwarded frames share one frame's time
+    if(!Record::FastForwardNoDelay())
+        s_oldTime = getNanoTime();
 }
 #endif
 
@@ -655,7 +659,7 @@ void runFrameLoop(LoopCall_t doLoopCallbackPre,
                 break;
         }
 
-        if(!g_config.unlimited_framerate)
+        if(!g_config.unlimited_framerate && !Record::FastForwarding())
             PGE_Delay(1);
 
         if(!GameIsActive)
@@ -124,6 +124,9 @@ struct PerformanceStats_t
     void print();
 };
 
+//! gameplay frames per second of real time
+static constexpr double c_gameFramesPerSecond = 64.1025;
+
 extern MicroStats g_microStats;
 extern PerformanceStats_t g_stats;
 
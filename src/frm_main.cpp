@@ -33,6 +33,7 @@
 #include "core/window.h"
 #include "core/msgbox.h"
 #include "core/events.h"
+#include "main/worker_pool.h"
 
 #ifndef THEXTECH_NO_SDL_CORE
 #   include "core/sdl/sdl_core.h"
@@ -41,6 +42,7 @@
 #ifdef CORE_EVERYTHING_SDL
 
 #   include "core/sdl/render_sdl.h"
+#   include "core/sdl/render_sw.h"
 #   include "core/opengl/render_gl.h"
 
 #   define USE_CORE_RENDER_SDL
@@ -118,6 +120,13 @@ bool FrmMain::initSystem(const CmdLineSetup_t &setup)
     else
 #   endif // #ifdef RENDERGL_SUPPORTED
 
+    if(g_config.render_mode == Config_t::RENDER_SOFTWARE_CPU)
+    {
+        RenderSW *render = new RenderSW();
+        m_render.reset(render);
+        g_render = m_render.get();
+    }
+    else
     {
         RenderSDL *render = new RenderSDL();
         m_render.reset(render);
@@ -240,6 +249,8 @@ bool FrmMain::initSystem(const CmdLineSetup_t &setup)
 
 void FrmMain::freeSystem()
 {
+    WorkerPool::Quit();
+
     FontManager::quit();
 
     GFX.unLoad();
@@ -334,6 +345,10 @@ bool FrmMain::restartRenderer()
         m_render.reset(new RenderGL());
         try_gl = true;
     }
+    else if(g_config.render_mode == Config_t::RENDER_SOFTWARE_CPU)
+    {
+        m_render.reset(new RenderSW());
+    }
     else
     {
         m_render.reset(new RenderSDL());
@@ -390,7 +405,10 @@ bool FrmMain::restartRenderer()
     m_render.reset();
     g_render = nullptr;
 
-    m_render.reset(new RenderSDL());
+    if(g_config.render_mode == Config_t::RENDER_SOFTWARE_CPU)
+        m_render.reset(new RenderSW());
+    else
+        m_render.reset(new RenderSDL());
 
     g_render = m_render.get();
 
@@ -83,6 +83,7 @@
 #include "main/game_strings.h"
 #include "main/translate.h"
 #include "main/record.h"
+#include "main/table_bench.h"
 #include "main/asset_pack.h"
 #include "core/render.h"
 #include "core/window.h"
@@ -561,7 +562,7 @@ int GameMain(const CmdLineSetup_t &setup)
     Integrator::initIntegrations();
 
     // want to go directly to game content
-    bool cmdline_content = (!setup.testLevel.empty() || !setup.testReplay.empty() || setup.interprocess);
+    bool cmdline_content = (!setup.testLevel.empty() || !setup.testReplay.empty() || setup.interprocess || !setup.benchTables.empty());
 
     // special case: go straight to asset pack menu
     if(g_config.pick_assets_on_start && !cmdline_content && setup.assetPack.empty() && GetAssetPacks().size() > 1)
@@ -579,6 +580,14 @@ int GameMain(const CmdLineSetup_t &setup)
 
     LoadingInProcess = false;
 
+    // run the spatial table benchmark instead of the game
+    if(!setup.benchTables.empty() && !init_failure)
+    {
+        int ret = TableBench::Run(setup.benchTables);
+        GracefulQuit();
+        return ret;
+    }
+
     // Clear the screen
     XRender::setTargetTexture();
     XRender::clearBuffer();
@@ -104,7 +104,13 @@ const int maxPlayers = 200;
 #endif
 
 //Public Const maxEffects As Integer = 1000    'Max # of effects
+#ifdef LOW_MEM
 const int maxEffects = 1000;
+#else
+const int maxEffects = 4000; // 1000
+#endif
+//! NEW: effect limit of the classic game, used unless the extended-effect-limit compat option is set
+const int maxEffectsClassic = 1000;
 //Public Const maxNPCs As Integer = 5000    'Max # of NPCs
 const int maxNPCs = 5000;
 //Public Const maxBackgrounds As Integer = 8000    'Max # of background objects
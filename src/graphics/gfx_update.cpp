@@ -43,17 +43,20 @@
 #include "../main/screen_quickreconnect.h"
 #include "../main/screen_textentry.h"
 #include "../main/cheat_code.h"
+#include "../main/record.h"
 #include "../config.h"
 #include "../game_main.h"
 #include "../main/game_globals.h"
 #include "main/world_globals.h"
 #include "main/level_medals.h"
+#include "main/worker_pool.h"
 #include "../core/render.h"
 #include "../script/luna/luna.h"
 
 #include "npc/npc_activation.h"
 #include "npc/npc_queues.h"
 #include "npc/section_overlap.h"
+#include "npc/npc_hot_fields.h"
 
 #include "effect.h"
 #include "npc_id.h"
@@ -635,8 +638,15 @@ double g_drawBGOs_invalidate_rate = 0;
 constexpr double i_drawBlocks_margin = 64;
 constexpr double i_drawBGOs_margin = 128;
 
-// updates the lists of blocks and BGOs to draw on i'th vScreen of screen
-void s_UpdateDrawItems(Screen_t& screen, int i)
+// raw results of the block query for each vScreen
+static std::vector<BaseRef_t> s_drawBlocks_query[maxLocalPlayers];
+
+// which of the lists s_FillDrawItems should rebuild for each vScreen
+static bool s_drawBlocks_refill[maxLocalPlayers] = {false, false};
+static bool s_drawBGOs_refill[maxLocalPlayers] = {false, false};
+
+// checks whether the lists of blocks and BGOs to draw on i'th vScreen of screen are still valid, and updates their query bounds if not
+static void s_CheckDrawItems(Screen_t& screen, int i)
 {
     vScreen_t& vscreen = screen.vScreen(i + 1);
 
@@ -657,15 +667,48 @@ void s_UpdateDrawItems(Screen_t& screen, int i)
     {
         g_drawBlocks_valid[i] = true;
         s_drawBlocks_invalidate_timer[i] = 0;
+        s_drawBlocks_refill[i] = true;
 
         // form query location
         s_drawBlocks_bounds[i] = newLoc(-vscreen.X - i_drawBlocks_margin,
             -vscreen.Y - i_drawBlocks_margin,
             vscreen.Width + i_drawBlocks_margin * 2,
             vscreen.Height + i_drawBlocks_margin * 2);
+    }
+
+    // update draw BGOs if needed
+    if(!g_drawBGOs_valid[i]
+        || -vscreen.X                  < s_drawBGOs_bounds[i].X                               + s_drawBGOs_invalidate_timer[i]
+        || -vscreen.X + vscreen.Width  > s_drawBGOs_bounds[i].X + s_drawBGOs_bounds[i].Width  - s_drawBGOs_invalidate_timer[i]
+        || -vscreen.Y                  < s_drawBGOs_bounds[i].Y                               + s_drawBGOs_invalidate_timer[i]
+        || -vscreen.Y + vscreen.Height > s_drawBGOs_bounds[i].Y + s_drawBGOs_bounds[i].Height - s_drawBGOs_invalidate_timer[i])
+    {
+        g_drawBGOs_valid[i] = true;
+        s_drawBGOs_invalidate_timer[i] = 0;
+        s_drawBGOs_refill[i] = true;
+
+        // form query location
+        s_drawBGOs_bounds[i] = newLoc(-vscreen.X - i_drawBGOs_margin,
+            -vscreen.Y - i_drawBGOs_margin,
+            vscreen.Width + i_drawBGOs_margin * 2,
+            vscreen.Height + i_drawBGOs_margin * 2);
+    }
+}
+
+// rebuilds the lists flagged by s_CheckDrawItems for i'th vScreen; only reads the level state, so it is safe to run on a worker thread
+static void s_FillDrawItems(int i)
+{
+    if(i < 0 || i >= maxLocalPlayers)
+        return;
+
+    if(s_drawBlocks_refill[i])
+    {
+        s_drawBlocks_refill[i] = false;
 
         // make query (sort by ID as done in vanilla)
-        TreeResult_Sentinel<BlockRef_t> areaBlocks = treeFLBlockQuery(s_drawBlocks_bounds[i], SORTMODE_ID);
+        std::vector<BaseRef_t>& areaBlocks = s_drawBlocks_query[i];
+        areaBlocks.clear();
+        treeFLBlockQuery(areaBlocks, s_drawBlocks_bounds[i], SORTMODE_ID);
 
         // load query results into different sets of blocks
         s_drawSBlocks[i].clear();
@@ -696,21 +739,9 @@ void s_UpdateDrawItems(Screen_t& screen, int i)
             });
     }
 
-    // update draw BGOs if needed
-    if(!g_drawBGOs_valid[i]
-        || -vscreen.X                  < s_drawBGOs_bounds[i].X                               + s_drawBGOs_invalidate_timer[i]
-        || -vscreen.X + vscreen.Width  > s_drawBGOs_bounds[i].X + s_drawBGOs_bounds[i].Width  - s_drawBGOs_invalidate_timer[i]
-        || -vscreen.Y                  < s_drawBGOs_bounds[i].Y                               + s_drawBGOs_invalidate_timer[i]
-        || -vscreen.Y + vscreen.Height > s_drawBGOs_bounds[i].Y + s_drawBGOs_bounds[i].Height - s_drawBGOs_invalidate_timer[i])
+    if(s_drawBGOs_refill[i])
     {
-        g_drawBGOs_valid[i] = true;
-        s_drawBGOs_invalidate_timer[i] = 0;
-
-        // form query location
-        s_drawBGOs_bounds[i] = newLoc(-vscreen.X - i_drawBGOs_margin,
-            -vscreen.Y - i_drawBGOs_margin,
-            vscreen.Width + i_drawBGOs_margin * 2,
-            vscreen.Height + i_drawBGOs_margin * 2);
+        s_drawBGOs_refill[i] = false;
 
         // make query (sort by ID as done in vanilla)
         s_drawBGOs[i].clear();
@@ -718,6 +749,30 @@ void s_UpdateDrawItems(Screen_t& screen, int i)
     }
 }
 
+// updates the lists of blocks and BGOs to draw on i'th vScreen of screen
+void s_UpdateDrawItems(Screen_t& screen, int i)
+{
+    s_CheckDrawItems(screen, i);
+    s_FillDrawItems(i);
+}
+
+// updates the lists of blocks and BGOs to draw on all active vScreens of screen, in parallel when there are several
+static void s_UpdateAllDrawItems(Screen_t& screen)
+{
+    int first = screen.active_begin();
+    int count = screen.active_end() - first;
+
+    for(int vscreen_i = first; vscreen_i < first + count; vscreen_i++)
+        s_CheckDrawItems(screen, vscreen_i);
+
+    WorkerPool::Run(count,
+        [](void* userdata, int index)
+        {
+            s_FillDrawItems(*(int*)userdata + index);
+        },
+        &first);
+}
+
 void GraphicsLazyPreLoad()
 {
     // FIXME: update to work for multiple screens
@@ -734,6 +789,55 @@ void GraphicsLazyPreLoad()
 
     CenterScreens(Screens[0]);
 
+    // pictures of the types used by the level, NPCs (including block contents) first
+    std::vector<StdPicture*> level_pictures;
+    std::bitset<maxNPCType + 1> npc_seen;
+    std::bitset<maxBlockType + 1> block_seen;
+    std::bitset<maxBackgroundType + 1> bgo_seen;
+
+    for(int A = 1; A <= numNPCs; A++)
+    {
+        int type = NPC[A].Type;
+        if(IF_INRANGE(type, 0, maxNPCType) && !npc_seen[type])
+        {
+            npc_seen[type] = true;
+            level_pictures.push_back(&GFXNPC[type]);
+        }
+    }
+
+    for(int A = 1; A <= numBlock; A++)
+    {
+        int type = Block[A].Special - 1000;
+        if(IF_INRANGE(type, 1, maxNPCType) && !npc_seen[type])
+        {
+            npc_seen[type] = true;
+            level_pictures.push_back(&GFXNPC[type]);
+        }
+    }
+
+    for(int A = 1; A <= numBlock; A++)
+    {
+        int type = Block[A].Type;
+        if(IF_INRANGE(type, 1, maxBlockType) && !block_seen[type])
+        {
+            block_seen[type] = true;
+            level_pictures.push_back(&GFXBlock[type]);
+        }
+    }
+
+    for(int A = 1; A <= numBackground; A++)
+    {
+        int type = Background[A].Type;
+        if(IF_INRANGE(type, 1, maxBackgroundType) && !bgo_seen[type])
+        {
+            bgo_seen[type] = true;
+            level_pictures.push_back(&GFXBackgroundBMP[type]);
+        }
+    }
+
+    // pack the small ones into texture atlases (if enabled) before the visible ones get loaded separately below
+    XRender::packTextureAtlas(level_pictures);
+
     For(Z, 1, numScreens)
     {
         if(SingleCoop == 2)
@@ -841,6 +945,12 @@ void GraphicsLazyPreLoad()
                 XRender::lazyPreLoad(GFXNPC[n.Type]);
         }
     }
+
+    // decode the rest of the level's pictures in the background, NPCs (including block contents) first
+    XRender::lazyPrefetchCancel();
+
+    for(StdPicture* picture : level_pictures)
+        XRender::lazyPrefetch(*picture);
 }
 
 // swappable buffer for previous frame's NoReset NPCs
@@ -849,6 +959,12 @@ static std::vector<NPCRef_t> s_NoReset_NPCs_LastFrame;
 // shared between the NPC screen logic functions, always reset to 0 between frames
 static std::bitset<maxNPCs> s_NPC_present;
 
+// packed copies of the checked NPCs' rects and their onscreen flags, shared between the NPC screen logic functions
+static NPC_HotFields_t s_checkNPCs_hot;
+static std::vector<uint8_t> s_onscreen_Z;
+static std::vector<uint8_t> s_onscreen_c_Z1;
+static std::vector<uint8_t> s_onscreen_c_Z2;
+
 // does the classic ("onscreen") NPC activation / reset logic for vScreen Z, directly based on the many NPC loops of the original game
 void ClassicNPCScreenLogic(int Z, int numScreens, bool fill_draw_queue, NPC_Draw_Queue_t& NPC_Draw_Queue_p)
 {
@@ -881,13 +997,19 @@ void ClassicNPCScreenLogic(int Z, int numScreens, bool fill_draw_queue, NPC_Draw
     for(int16_t n : checkNPCs)
         NPC_present[n] = false;
 
+    // test all of their rects against the vScreen at once
+    s_checkNPCs_hot.gather(checkNPCs);
+    s_checkNPCs_hot.onscreen(Z, s_onscreen_Z);
+
     // allocate it outside the loop; use it only when needed
     Location_t npcALoc;
 
     // following logic is somewhat difficult to read but includes the precise conditions
     // from each NPC check in the original UpdateGraphics to determine how to handle each NPC
-    for(int A : checkNPCs)
+    for(size_t i = 0; i < checkNPCs.size(); i++)
     {
+        int A = checkNPCs[i];
+
         bool has_ALoc = false;
         bool check_both_reset = false;
         bool check_long_life = false;
@@ -1005,7 +1127,7 @@ void ClassicNPCScreenLogic(int Z, int numScreens, bool fill_draw_queue, NPC_Draw
         if(!can_check)
             continue;
 
-        if((vScreenCollision(Z, NPC[A].Location) || (has_ALoc && vScreenCollision(Z, npcALoc))) && !NPC[A].Hidden)
+        if((s_onscreen_Z[i] || (has_ALoc && vScreenCollision(Z, npcALoc))) && !s_checkNPCs_hot.hidden[i])
         {
             if(kill_zero && NPC[A].Type == 0) // what is this? almost certainly some sort of debugging on Redigit's side
             {
@@ -1153,10 +1275,22 @@ void ModernNPCScreenLogic(Screen_t& screen, int vscreen_i, bool fill_draw_queue,
     for(int16_t n : checkNPCs)
         NPC_present[n] = false;
 
+    // test all of their rects against the visible and canonical vScreens at once
+    s_checkNPCs_hot.gather(checkNPCs);
+    s_checkNPCs_hot.onscreen(Z, s_onscreen_Z);
+
+    if(c_Z1)
+        s_checkNPCs_hot.onscreen(c_Z1, s_onscreen_c_Z1);
+
+    if(c_Z2)
+        s_checkNPCs_hot.onscreen(c_Z2, s_onscreen_c_Z2);
+
     Location_t loc2;
 
-    for(int A : checkNPCs)
+    for(size_t i = 0; i < checkNPCs.size(); i++)
     {
+        int A = checkNPCs[i];
+
         // there are three related things we will determine:
         // - is the NPC onscreen for rendering?
         // - can we reset the NPC (respawn it to its original location)?
@@ -1182,20 +1316,20 @@ void ModernNPCScreenLogic(Screen_t& screen, int vscreen_i, bool fill_draw_queue,
 
         bool render, cannot_reset, can_activate;
 
-        if(NPC[A].Hidden)
+        if(s_checkNPCs_hot.hidden[i])
         {
             render = cannot_reset = can_activate = false;
         }
         else
         {
-            render = vScreenCollision(Z, NPC[A].Location) || (loc2_exists && vScreenCollision(Z, loc2));
+            render = s_onscreen_Z[i] || (loc2_exists && vScreenCollision(Z, loc2));
 
             bool onscreen_canonical = false;
 
             // check canonical screen
             if(c_Z1)
             {
-                onscreen_canonical = (vScreenCollision(c_Z1, NPC[A].Location)
+                onscreen_canonical = (s_onscreen_c_Z1[i]
                     || (loc2_exists && vScreenCollision(c_Z1, loc2)));
             }
             // fallback to Z itself if no canonical screen exists
@@ -1207,7 +1341,7 @@ void ModernNPCScreenLogic(Screen_t& screen, int vscreen_i, bool fill_draw_queue,
             // add second canonical screen if needed
             if(c_Z2 && !onscreen_canonical)
             {
-                onscreen_canonical = (vScreenCollision(c_Z2, NPC[A].Location)
+                onscreen_canonical = (s_onscreen_c_Z2[i]
                     || (loc2_exists && vScreenCollision(c_Z2, loc2)));
             }
 
@@ -1451,6 +1585,10 @@ void UpdateGraphics(bool skipRepaint)
     if(g_config.enable_frameskip && !TakeScreen && frameSkipNeeded())
         Do_FrameSkip = true;
 
+    // headless and fast-forwarded replays only need the logic part of most frames
+    if(Record::SkipDraw())
+        Do_FrameSkip = true;
+
 #ifdef __16M__
     if(!XRender::ready_for_frame())
     {
@@ -1869,6 +2007,9 @@ void UpdateGraphicsScreen(Screen_t& screen)
     XRender::renderRect(0, 0, XRender::TargetW, XRender::TargetH, {0, 0, 0});
     DrawBackdrop(screen);
 
+    // update the vectors of all the onscreen blocks and backgrounds for use at multiple places
+    s_UpdateAllDrawItems(screen);
+
     // No logic
     // Draw the screens!
     for(int vscreen_i = screen.active_begin(); vscreen_i < screen.active_end(); vscreen_i++)
@@ -1955,8 +2096,7 @@ void UpdateGraphicsScreen(Screen_t& screen)
         XRender::setTargetLayer(g_config.td_compat_mode ? 2 : 1);
 #endif
 
-        // update the vectors of all the onscreen blocks and backgrounds for use at multiple places
-        s_UpdateDrawItems(screen, vscreen_i);
+        // the vectors of all the onscreen blocks and backgrounds (for use at multiple places) were updated before the loop
         const std::vector<BlockRef_t>& screenMainBlocks = s_drawMainBlocks[vscreen_i];
         const std::vector<BlockRef_t>& screenLavaBlocks = s_drawLavaBlocks[vscreen_i];
         const std::vector<BlockRef_t>& screenSBlocks = s_drawSBlocks[vscreen_i];
@@ -18,7 +18,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <set>
+#include <bitset>
+#include <vector>
 
 #include "sdl_proxy/sdl_stdinc.h"
 #include "globals.h"
@@ -61,7 +62,9 @@ RangeArrI<uint8_t, 1, maxEvents, 0> newEventPlayer;
 int newEventNum = 0;
 
 layerindex_t LAYER_USED_P_SWITCH = LAYER_NONE;
-static std::set<eventindex_t> recentlyTriggeredEvents;
+//! events triggered since the last ClearTriggeredEvents() call: a flag per event for lookups, and a list for clearing them
+static std::bitset<maxEvents + 1> s_eventTriggered;
+static std::vector<eventindex_t> s_triggeredEvents;
 
 static SDL_INLINE bool equalCase(const std::string &x, const std::string &y)
 {
@@ -97,6 +100,32 @@ static void sorted_erase(std::vector<vbint_t>& vec, vbint_t val)
     vec.erase(it);
 }
 
+// moves a layer's members into its own block/BGO/water tables, which store them relative to the layer's offset
+static void s_splitMovingLayer(layerindex_t L)
+{
+    // these thresholds can be tweaked, but they balance the expense of querying more tables with the expense of updating locations in the main table
+    if(Layer[L].blocks.size() > 2)
+        treeBlockSplitLayer(L);
+
+    if(Layer[L].BGOs.size() > 2)
+        treeBackgroundSplitLayer(L);
+
+    if(Layer[L].waters.size() > 2)
+        treeWaterSplitLayer(L);
+}
+
+// frames that a layer must stay still in UpdateLayers before it gets joined: the speed of a layer attached to an NPC (AttLayer)
+//   follows the NPC's movement of the last frame, so it often drops to zero for a single frame
+static constexpr uint8_t c_layerJoinDelay = 64;
+
+// moves a stopped layer's members back into the main tables (does nothing if the layer isn't split)
+static void s_joinStoppedLayer(layerindex_t L)
+{
+    treeBlockJoinLayer(L);
+    treeBackgroundJoinLayer(L);
+    treeWaterJoinLayer(L);
+}
+
 
 
 // utilities for layerindex_t and eventindex_t
@@ -1244,7 +1273,11 @@ eventindex_t ProcEvent_Safe(bool is_resume, eventindex_t index, int whichPlayer,
     if(is_resume)
         goto event_resume;
 
-    recentlyTriggeredEvents.insert(index);
+    if(!s_eventTriggered[index])
+    {
+        s_eventTriggered[index] = true;
+        s_triggeredEvents.push_back(index);
+    }
 
     if(g_config.speedrun_stop_timer_by == Config_t::SPEEDRUN_STOP_EVENT && equalCase(evt.Name.c_str(), g_config.speedrun_stop_timer_at))
         speedRun_bossDeadEvent();
@@ -1304,6 +1337,8 @@ eventindex_t ProcEvent_Safe(bool is_resume, eventindex_t index, int whichPlayer,
             bool set_qScreen = false;
             bool set_qScreen_canonical = false;
 
+            const bool is_level_start = equalCase(evt.Name.c_str(), "Level - Start");
+
             for(int screen_i = 0; screen_i < c_screenCount; screen_i++)
             {
                 Screen_t& screen = Screens[screen_i];
@@ -1317,16 +1352,16 @@ eventindex_t ProcEvent_Safe(bool is_resume, eventindex_t index, int whichPlayer,
                 int warped_plr = 0;
 
                 // warp other players to resized section, if not a reset or level start
-                bool do_warp = !is_reset && !evt.AutoStart && !equalCase(evt.Name.c_str(), "Level - Start");
+                bool do_warp = !is_reset && !evt.AutoStart && !is_level_start;
                 s_testPlayersInSection(screen, B, do_warp, onscreen_plr, warped_plr);
 
                 bool set_qScreen_i = false;
 
                 // start the modern qScreen animation
-                if(!equalCase(evt.Name.c_str(), "Level - Start") && g_config.modern_section_change)
+                if(!is_level_start && g_config.modern_section_change)
                     set_qScreen_i = s_initModernQScreen(screen, B, tempLevel, newLevel, onscreen_plr, warped_plr, is_reset);
                 // legacy qScreen animation
-                else if(!equalCase(evt.Name.c_str(), "Level - Start"))
+                else if(!is_level_start)
                     set_qScreen_i = s_initLegacyQScreen(screen, B, tempLevel, newLevel, onscreen_plr);
 
                 if(set_qScreen_i)
@@ -1367,22 +1402,10 @@ eventindex_t ProcEvent_Safe(bool is_resume, eventindex_t index, int whichPlayer,
         if(Layer[B].SpeedX == 0.f && Layer[B].SpeedY == 0.f)
         {
             // eventually, only re-join tables the first time the event has been triggered in a level
-            treeBlockJoinLayer(B);
-            treeBackgroundJoinLayer(B);
-            treeWaterJoinLayer(B);
+            s_joinStoppedLayer(B);
         }
         else
-        {
-            // these thresholds can be tweaked, but they balance the expense of querying more tables with the expense of updating locations in the main table
-            if(Layer[B].blocks.size() > 2)
-                treeBlockSplitLayer(B);
-
-            if(Layer[B].BGOs.size() > 2)
-                treeBackgroundSplitLayer(B);
-
-            if(Layer[B].waters.size() > 2)
-                treeWaterSplitLayer(B);
-        }
+            s_splitMovingLayer(B);
     }
 
     if(!AutoUseModern) // Use legacy auto-scrolling when modern autoscrolling was never used here
@@ -1654,14 +1677,28 @@ void CancelNewEvent(eventindex_t index)
 
 bool EventWasTriggered(eventindex_t index)
 {
-    return !recentlyTriggeredEvents.empty() &&
-            recentlyTriggeredEvents.find(index) != recentlyTriggeredEvents.end();
+    return index <= maxEvents && s_eventTriggered[index];
+}
+
+bool EventWasTriggered(const std::string& EventName)
+{
+    // only compare the names of the (usually very few) events triggered this frame
+    for(eventindex_t index : s_triggeredEvents)
+    {
+        // several events may share a name, so check the one FindEvent() resolves it to
+        if(equalCase(Events[index].Name, EventName))
+            return EventWasTriggered(FindEvent(EventName));
+    }
+
+    return false;
 }
 
 void ClearTriggeredEvents()
 {
-    if(!recentlyTriggeredEvents.empty())
-        recentlyTriggeredEvents.clear();
+    for(eventindex_t index : s_triggeredEvents)
+        s_eventTriggered[index] = false;
+
+    s_triggeredEvents.clear();
 }
 
 void UpdateLayers()
@@ -1710,7 +1747,15 @@ void UpdateLayers()
 
         // only consider non-empty, moving layers
         if(Layer[A].Name.empty() || (Layer[A].SpeedX == 0.f && Layer[A].SpeedY == 0.f))
+        {
+            // layers stopped by NPCs (AttLayer) or by players were split below, and are rejoined once they have stayed still
+            if(Layer[A].StillFrames < c_layerJoinDelay)
+                Layer[A].StillFrames++;
+            else
+                s_joinStoppedLayer(A);
+
             continue;
+        }
 
         // the layer does not move
         if(FreezeNPCs || (FreezeLayers && Layer[A].EffectStop))
@@ -1746,6 +1791,11 @@ void UpdateLayers()
         {
             // if(!(FreezeLayers && Layer[A].EffectStop))
             {
+                // layers moved by NPCs (AttLayer) or by players never pass through ProcEvent, so split them here,
+                // before the offset changes; once split, a layer moves within its own tables without any tree updates
+                s_splitMovingLayer(A);
+                Layer[A].StillFrames = 0;
+
                 Layer[A].OffsetX += double(Layer[A].SpeedX);
                 Layer[A].OffsetY += double(Layer[A].SpeedY);
 
@@ -63,6 +63,8 @@ struct Layer_t
 // NEW: track the layer offset so we don't need to update the block/BGO trees
     double OffsetX = 0.0;
     double OffsetY = 0.0;
+// NEW: frames the layer has been still for (saturates), so that a layer split by UpdateLayers is only joined once it has settled
+    uint8_t StillFrames = 0;
 };
 
 struct EventSection_t
@@ -257,6 +259,8 @@ bool DeleteEvent(eventindex_t index);
 void CancelNewEvent(eventindex_t index);
 // EXTRA: Check was any event got triggered?
 bool EventWasTriggered(eventindex_t index);
+// EXTRA: same as EventWasTriggered(FindEvent(EventName)), without a name search when no event was triggered
+bool EventWasTriggered(const std::string& EventName);
 // EXTRA: Clear up the tracklist
 void ClearTriggeredEvents();
 
@@ -30,6 +30,9 @@
 #include "sound.h"
 #include "main/game_info.h"
 #include "main/speedrunner.h"
+#include "main/record.h"
+#include "main/replay_trace.h"
+#include "main/state_hash.h"
 #include "main/game_info.h"
 #include "main/asset_pack.h"
 #include "main/translate.h"
@@ -42,6 +45,10 @@
 #   include "capabilities.h"
 #endif
 
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+#   include "main/replay_batch.h"
+#endif
+
 #ifndef THEXTECH_NO_ARGV_HANDLING
 #   include <tclap/CmdLine.h>
 #endif
@@ -352,6 +359,7 @@ int main(int argc, char**argv)
                                                 "  hw - generic hardware accelerated render (currently SDL2) [Default]\n"
                                                 "  vsync - generic hardware accelerated render with vSync [deprecated]\n"
                                                 "  sdl - hardware accelerated SDL2 render\n"
+                                                "  cpu - built-in software render (headless-friendly, same output everywhere)\n"
 #   ifdef THEXTECH_BUILD_GL_DESKTOP_MODERN
                                                 "  opengl - hardware accelerated OpenGL 2.1+ render\n"
 #   endif
@@ -451,6 +459,60 @@ int main(int argc, char**argv)
                                                     false, "undefined",
                                                    "opaque, always, never",
                                                     cmd);
+        TCLAP::ValueArg<std::string> replaySpeed(std::string(), "replay-speed",
+                                                 "Run a replay faster than real time\n"
+                                                 "Supported values:\n"
+                                                 "  max - Run the replay as fast as possible\n"
+                                                 "  xN - Run N frames per real-time frame (x1 is real time)",
+                                                 false, std::string(),
+                                                 "max, x2, x4, etc.",
+                                                 cmd);
+        TCLAP::ValueArg<int> replayRenderInterval(std::string(), "replay-render-interval",
+                                                  "While a replay is fast-forwarded, only draw every Nth frame (0 to never draw).\n"
+                                                  "By default, one frame is drawn per real-time frame, or one per 64 frames at max speed",
+                                                  false, -1,
+                                                  "number of frames",
+                                                  cmd);
+        TCLAP::ValueArg<unsigned int> replayStartFrame(std::string(), "replay-start-frame",
+                                                       "Start a binary replay from its last keyframe at or before the given frame\n"
+                                                       "(the recording must have been made by the same build). Combine with --replay-bisect\n"
+                                                       "to compare only the part of a long replay near a known divergence",
+                                                       false, 0,
+                                                       "frame number",
+                                                       cmd);
+        TCLAP::ValueArg<std::string> replayFrameDump(std::string(), "replay-frame-dump",
+                                                     "Write replayed frames into the given directory as PNG files (needs --render cpu),\n"
+                                                     "to compare the rendering against reference images",
+                                                     false, std::string(),
+                                                     "path to directory",
+                                                     cmd);
+        TCLAP::ValueArg<unsigned int> replayFrameDumpInterval(std::string(), "replay-frame-dump-interval",
+                                                              "Write every Nth replayed frame with --replay-frame-dump (default 64)",
+                                                              false, 64,
+                                                              "number of frames",
+                                                              cmd);
+        TCLAP::ValueArg<std::string> replayTrace(std::string(), "replay-trace",
+                                                 "Write a per-frame trace of the gameplay state during a recording or replay",
+                                                 false, std::string(),
+                                                 "path to file",
+                                                 cmd);
+        TCLAP::ValueArg<std::string> replayBisect(std::string(), "replay-bisect",
+                                                  "Compare a replay against the trace of a reference run (made with --replay-trace),\n"
+                                                  "and report the first diverging frame, object, and field",
+                                                  false, std::string(),
+                                                  "path to file",
+                                                  cmd);
+        TCLAP::ValueArg<std::string> benchTables(std::string(), "bench-tables",
+                                                 "Benchmark the block and NPC spatial tables on synthetic levels and on the given levels, then quit",
+                                                 false, std::string(),
+                                                 "path to level file or directory, or \"synthetic\"",
+                                                 cmd);
+        TCLAP::ValueArg<std::string> stateHash(std::string(), "state-hash",
+                                               "Write a 64-bit hash of the gameplay state for every frame of a recording or replay,\n"
+                                               "to compare runs between builds and platforms",
+                                               false, std::string(),
+                                               "path to file",
+                                               cmd);
         TCLAP::SwitchArg switchDisplayControls(std::string(), "show-controls", "Display current controller state while the game process", false);
         TCLAP::ValueArg<unsigned int> showBatteryStatus(std::string(), "show-battery-status",
                                                    "Display the battery status indicator (if available):\n"
@@ -477,6 +539,21 @@ int main(int argc, char**argv)
 
         TCLAP::SwitchArg switchVerboseLog(std::string(), "verbose", "Enable log output into the terminal", false);
 
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+        TCLAP::ValueArg<std::string> replayBatch(std::string(), "replay-batch",
+                                                 "Run all replays (*.rec) of a directory headless, in parallel worker processes, and print a summary",
+                                                 false, std::string(),
+                                                 "path to directory");
+        TCLAP::ValueArg<std::string> replayBatchOutput(std::string(), "replay-batch-output",
+                                                       "Write the replay batch summary into a file (CSV, or JSON if the name ends with .json)",
+                                                       false, std::string(),
+                                                       "path to file");
+        TCLAP::ValueArg<unsigned int> replayBatchJobs(std::string(), "replay-batch-jobs",
+                                                      "Number of parallel replay workers (by default, the number of CPU cores)",
+                                                      false, 0u,
+                                                      "number of workers");
+#endif
+
         TCLAP::UnlabeledMultiArg<std::string> inputFileNames("levelpath", "Path to level file or replay data to run the test", false, std::string(), "path to file");
 
         cmd.add(&switchFrameSkip);
@@ -507,6 +584,11 @@ int main(int argc, char**argv)
         cmd.add(&langOutputPath);
 #endif
         cmd.add(&lang);
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+        cmd.add(&replayBatch);
+        cmd.add(&replayBatchOutput);
+        cmd.add(&replayBatchJobs);
+#endif
         cmd.add(&inputFileNames);
 
         cmd.parse(argc, argv);
@@ -630,6 +712,41 @@ int main(int argc, char**argv)
                 g_config.show_playtime_counter = Config_t::PLAYTIME_COUNTER_ANIMATED;
         }
 
+        if(replaySpeed.isSet())
+        {
+            std::string speed = replaySpeed.getValue();
+            int multiplier = 0;
+
+            if(speed == "max")
+                Record::replay_speed = 0;
+            else if(speed.size() > 1 && speed[0] == 'x' && sscanf(speed.c_str() + 1, "%d", &multiplier) == 1 && multiplier >= 1)
+                Record::replay_speed = multiplier;
+            else
+            {
+                std::cerr << "Error: Invalid value for the --replay-speed argument: " << speed << std::endl;
+                std::cerr.flush();
+                return 2;
+            }
+
+            Record::replay_speed_set = true;
+            Record::replay_render_interval = (Record::replay_speed > 0) ? Record::replay_speed : 64;
+        }
+
+        if(replayRenderInterval.isSet() && replayRenderInterval.getValue() >= 0)
+            Record::replay_render_interval = replayRenderInterval.getValue();
+
+        if(replayStartFrame.isSet())
+            Record::replay_start_frame = replayStartFrame.getValue();
+
+        Record::replay_frame_dump_dir = replayFrameDump.getValue();
+
+        if(replayFrameDumpInterval.isSet())
+            Record::replay_frame_dump_interval = (int)replayFrameDumpInterval.getValue();
+
+        ReplayTrace::output_path = replayTrace.getValue();
+        ReplayTrace::reference_path = replayBisect.getValue();
+        StateHash::output_path = stateHash.getValue();
+
         if(switchTestShowFPS.isSet())
             g_config.show_fps = switchTestShowFPS.getValue();
 
@@ -678,6 +795,8 @@ int main(int argc, char**argv)
                 g_config.render_mode = Config_t::RENDER_ACCELERATED_AUTO;
             else if(rt == "sdl")
                 g_config.render_mode = Config_t::RENDER_ACCELERATED_SDL;
+            else if(rt == "cpu")
+                g_config.render_mode = Config_t::RENDER_SOFTWARE_CPU;
             else if(rt == "opengl")
                 g_config.render_mode = Config_t::RENDER_ACCELERATED_OPENGL;
             else if(rt == "opengl11")
@@ -723,6 +842,12 @@ int main(int argc, char**argv)
         }
 
         setup.verboseLogging = switchVerboseLog.getValue();
+        setup.benchTables = benchTables.getValue();
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+        setup.replayBatchDir = replayBatch.getValue();
+        setup.replayBatchOutput = replayBatchOutput.getValue();
+        setup.replayBatchJobs = int(replayBatchJobs.getValue());
+#endif
 #ifdef THEXTECH_INTERPROC_SUPPORTED
         setup.interprocess = switchTestInterprocess.getValue();
 #endif
@@ -778,6 +903,16 @@ int main(int argc, char**argv)
 
     UpdateConfig();
 
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+    // the main process only supervises the workers; each worker continues below with its own replay
+    if(!setup.replayBatchDir.empty())
+    {
+        int batch_ret = 0;
+        if(ReplayBatch::Run(setup, batch_ret))
+            return batch_ret;
+    }
+#endif
+
     // set this flag before SDL initialization to allow game be quit when closing a window before a loading process will be completed
     GameIsActive = true;
 
@@ -809,6 +944,10 @@ int main(int argc, char**argv)
 
     int ret = GameMain(setup);
 
+#ifdef THEXTECH_REPLAY_BATCH_SUPPORTED
+    ReplayBatch::FinishWorker();
+#endif
+
 #ifdef ENABLE_XTECH_LUA
     if(!xtech_lua_quit())
         ret = 1;
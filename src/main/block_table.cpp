@@ -188,12 +188,7 @@ struct TableInterface
                 sort_mode = SORTMODE_LOC;
         }
 
-        if(sort_mode == SORTMODE_LOC)
-            std::sort(out.begin(), out.end(), Comparisons::Loc<ItemRef_t>);
-        else if(sort_mode == SORTMODE_ID)
-            std::sort(out.begin(), out.end(), Comparisons::ID<ItemRef_t>);
-        else if(sort_mode == SORTMODE_Z)
-            std::sort(out.begin(), out.end(), Comparisons::Z<ItemRef_t>);
+        sort_query_results<ItemRef_t>(out, 0, sort_mode);
     }
 
     void query(std::vector<BaseRef_t>& out, double Left, double Top, double Right, double Bottom,
@@ -229,6 +224,8 @@ struct TableInterface
     }
 };
 
+TREEQUERY_THREAD_LOCAL std::vector<BaseRef_t> g_querySortScratch;
+
 table_t<BlockRef_t> s_temp_block_table;
 table_t<NPCRef_t> s_npc_table;
 bool s_temp_blocks_enabled = false;
@@ -417,12 +414,7 @@ void treeTempBlockQuery(std::vector<BaseRef_t>& out,
             sort_mode = SORTMODE_LOC;
     }
 
-    if(sort_mode == SORTMODE_LOC)
-        std::sort(out.begin(), out.end(), Comparisons::Loc<BlockRef_t>);
-    else if(sort_mode == SORTMODE_ID)
-        std::sort(out.begin(), out.end(), Comparisons::ID<BlockRef_t>);
-    else if(sort_mode == SORTMODE_Z)
-        std::sort(out.begin(), out.end(), Comparisons::Z<BlockRef_t>);
+    sort_query_results<BlockRef_t>(out, 0, sort_mode);
 }
 
 TreeResult_Sentinel<BlockRef_t> treeTempBlockQuery(const Location_t &_loc,
@@ -518,12 +510,7 @@ TreeResult_Sentinel<BlockRef_t> treeBlockQuery(const Location_t &_loc,
             sort_mode = SORTMODE_LOC;
     }
 
-    if(sort_mode == SORTMODE_LOC)
-        std::sort(result.i_vec->begin(), result.i_vec->end(), Comparisons::Loc<BlockRef_t>);
-    else if(sort_mode == SORTMODE_ID)
-        std::sort(result.i_vec->begin(), result.i_vec->end(), Comparisons::ID<BlockRef_t>);
-    else if(sort_mode == SORTMODE_Z)
-        std::sort(result.i_vec->begin(), result.i_vec->end(), Comparisons::Z<BlockRef_t>);
+    sort_query_results<BlockRef_t>(*result.i_vec, 0, sort_mode);
 
     return result;
 }
@@ -670,12 +657,7 @@ void treeNPCQuery(std::vector<BaseRef_t>& out, const Location_t &_loc, int sort_
     if(sort_mode == SORTMODE_COMPAT)
         sort_mode = SORTMODE_ID;
 
-    if(sort_mode == SORTMODE_LOC)
-        std::sort(out.begin(), out.end(), Comparisons::Loc<NPCRef_t>);
-    else if(sort_mode == SORTMODE_ID)
-        std::sort(out.begin(), out.end(), Comparisons::ID<NPCRef_t>);
-    else if(sort_mode == SORTMODE_Z)
-        std::sort(out.begin(), out.end(), Comparisons::Z<NPCRef_t>);
+    sort_query_results<NPCRef_t>(out, 0, sort_mode);
 }
 
 TreeResult_Sentinel<NPCRef_t> treeNPCQuery(const Location_t &_loc,
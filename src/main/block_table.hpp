@@ -25,12 +25,16 @@
 
 #include <iterator>
 #include <array>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
 #include <set>
-#include <unordered_map>
+#include <vector>
 
 #include "globals.h"
 #include "layers.h"
 #include "npc_traits.h"
+#include "main/trees.h"
 
 #include "sdl_proxy/sdl_stdinc.h"
 
@@ -48,6 +52,8 @@ struct AugBaseRef_t
     uint8_t cont_axes;
 };
 
+struct node_pool_t;
+
 struct node_t
 {
     // not safe to change this
@@ -65,12 +71,6 @@ struct node_t
         cont_axes = 0;
     }
 
-    inline ~node_t()
-    {
-        if(next)
-            delete next;
-    }
-
     struct iterator
     {
         node_t* parent;
@@ -128,21 +128,8 @@ struct node_t
         return iterator(nullptr);
     }
 
-    inline void insert(AugBaseRef_t b)
-    {
-        if(this->filled < node_size)
-        {
-            this->refs[this->filled] = b.ref;
-            this->cont_axes |= (b.cont_axes & 3) << (this->filled * 2);
-            this->filled++;
-        }
-        else
-        {
-            if(!this->next)
-                this->next = new node_t;
-            this->next->insert(b);
-        }
-    }
+    // overflow nodes are owned by the table's pool
+    inline void insert(AugBaseRef_t b, node_pool_t& pool);
 
     inline void erase(iterator& it)
     {
@@ -169,6 +156,66 @@ struct node_t
     }
 };
 
+// allocates the overflow nodes of a table from contiguous chunks, all freed together when the table is cleared
+struct node_pool_t
+{
+    static constexpr size_t chunk_size = 256;
+
+    std::vector<node_t*> chunks;
+    size_t chunk_used = chunk_size;
+
+    node_pool_t() = default;
+    node_pool_t(const node_pool_t&) = delete;
+    node_pool_t& operator=(const node_pool_t&) = delete;
+
+    ~node_pool_t()
+    {
+        clear();
+    }
+
+    inline node_t* alloc()
+    {
+        if(chunk_used == chunk_size)
+        {
+            chunks.push_back(new node_t[chunk_size]);
+            chunk_used = 0;
+        }
+
+        return &chunks.back()[chunk_used++];
+    }
+
+    void clear()
+    {
+        for(node_t* chunk : chunks)
+            delete[] chunk;
+
+        chunks.clear();
+        chunk_used = chunk_size;
+    }
+
+    size_t count() const
+    {
+        return chunks.empty() ? 0 : (chunks.size() - 1) * chunk_size + chunk_used;
+    }
+};
+
+inline void node_t::insert(AugBaseRef_t b, node_pool_t& pool)
+{
+    node_t* n = this;
+
+    while(n->filled == node_size)
+    {
+        if(!n->next)
+            n->next = pool.alloc();
+
+        n = n->next;
+    }
+
+    n->refs[n->filled] = b.ref;
+    n->cont_axes |= (b.cont_axes & 3) << (n->filled * 2);
+    n->filled++;
+}
+
 struct AugLoc_t
 {
     int16_t x, y;
@@ -278,10 +325,10 @@ struct screen_t
         }
     }
 
-    void insert(BaseRef_t obj, const rect_internal& rect)
+    void insert(BaseRef_t obj, const rect_internal& rect, node_pool_t& pool)
     {
         for(const AugLoc_t& loc : rect)
-            nodes[loc.x * 32 + loc.y].insert({obj, loc.cont_axes});
+            nodes[loc.x * 32 + loc.y].insert({obj, loc.cont_axes}, pool);
     }
 
     void erase(BaseRef_t obj, const rect_internal& rect)
@@ -341,6 +388,131 @@ inline Location_t extract_loc_layer(MyRef_t obj)
     return loc;
 }
 
+// Sorting of query results.
+//
+// The results of an unsorted query must stay in table order (gameplay code iterates them with early exits),
+// so the tables can't keep their nodes sorted. Instead, the results are sorted without std::sort where the
+// order is fully determined (by index), and with sort keys loaded once per item where ties are possible.
+
+// below this size, index order uses an insertion sort instead of a radix sort
+static constexpr size_t c_indexSortRadixMin = 64;
+
+// scratch buffer of the radix sort (one per thread, see TREEQUERY_THREAD_LOCAL)
+extern TREEQUERY_THREAD_LOCAL std::vector<BaseRef_t> g_querySortScratch;
+
+inline void sort_refs_by_index(BaseRef_t* begin, BaseRef_t* end)
+{
+    size_t n = end - begin;
+
+    if(n < c_indexSortRadixMin)
+    {
+        for(BaseRef_t* i = begin + 1; i < end; i++)
+        {
+            BaseRef_t v = *i;
+            BaseRef_t* j = i;
+
+            for(; j > begin && v.index < (j - 1)->index; j--)
+                *j = *(j - 1);
+
+            *j = v;
+        }
+
+        return;
+    }
+
+    // two-pass LSD radix sort of the 16-bit indices (sign bit flipped to order negative indices first)
+    if(g_querySortScratch.size() < n)
+        g_querySortScratch.resize(n);
+
+    BaseRef_t* src = begin;
+    BaseRef_t* dst = g_querySortScratch.data();
+
+    for(int shift = 0; shift < 16; shift += 8)
+    {
+        size_t count[257] = {0};
+
+        for(size_t i = 0; i < n; i++)
+            count[((((uint16_t)src[i].index ^ 0x8000) >> shift) & 0xFF) + 1]++;
+
+        for(int b = 0; b < 256; b++)
+            count[b + 1] += count[b];
+
+        for(size_t i = 0; i < n; i++)
+            dst[count[(((uint16_t)src[i].index ^ 0x8000) >> shift) & 0xFF]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    // after an even number of passes, the result is back in the output
+}
+
+template<class ItemRef_t>
+inline void sort_refs_by_loc(BaseRef_t* begin, BaseRef_t* end)
+{
+    using pos_t = typename std::decay<decltype(ItemRef_t((int16_t)0)->Location.X)>::type;
+
+    struct key_t
+    {
+        pos_t X, Y;
+        BaseRef_t ref;
+    };
+
+    size_t n = end - begin;
+
+    if(n < 2)
+        return;
+
+    static TREEQUERY_THREAD_LOCAL std::vector<key_t> keys;
+    keys.resize(n);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        const auto& loc = ((ItemRef_t)begin[i])->Location;
+        keys[i] = {loc.X, loc.Y, begin[i]};
+    }
+
+    // exactly the comparisons of Comparisons::Loc, so ties end up in the same order as before
+    std::sort(keys.begin(), keys.end(),
+        [](const key_t& a, const key_t& b)
+        {
+            return (a.X <= b.X && (a.X < b.X || a.Y < b.Y));
+        });
+
+    for(size_t i = 0; i < n; i++)
+        begin[i] = keys[i].ref;
+}
+
+//! sorts query results from position begin onward (sort_mode must already be resolved from SORTMODE_COMPAT)
+template<class ItemRef_t>
+inline void sort_query_results(std::vector<BaseRef_t>& out, size_t begin, int sort_mode)
+{
+    if(begin >= out.size())
+        return;
+
+    BaseRef_t* first = out.data() + begin;
+    BaseRef_t* last = out.data() + out.size();
+
+    if(sort_mode == SORTMODE_LOC)
+        sort_refs_by_loc<ItemRef_t>(first, last);
+    else if(sort_mode == SORTMODE_ID)
+        sort_refs_by_index(first, last);
+    else if(sort_mode == SORTMODE_Z)
+    {
+        if(std::is_same<ItemRef_t, BackgroundRef_t>::value)
+            std::sort(first, last, Comparisons::Z<ItemRef_t>);
+        else
+            sort_refs_by_index(first, last);
+    }
+}
+
+//! heap usage of a table, reported by the table benchmark
+struct table_stats_t
+{
+    size_t members = 0;
+    size_t screens = 0;
+    size_t overflow_nodes = 0;
+};
+
 // it's a bunch of stacks of screens, which are 2048x2048.
 // will be reallocated as needed
 template<class MyRef_t>
@@ -349,8 +521,26 @@ struct table_t
     typedef std::vector<screen_t*> screen_ptr_arr_t;
     std::vector<screen_ptr_arr_t> columns;
     std::vector<int> col_first_row_index;
-    std::unordered_map<MyRef_t, rect_external> member_rects;
     int first_col_index;
+    node_pool_t node_pool;
+
+    struct member_t
+    {
+        rect_external rect;
+        int32_t slot = -1; // position in member_list, or -1 if not a member
+    };
+
+    // the lowest index of any table's array (NPC array starts at -128)
+    static constexpr int member_index_offset = 128;
+
+    // members are indexed in pages of 256 refs, so that a layer's table only allocates the pages its members fall into
+    static constexpr int member_page_bits = 8;
+    static constexpr size_t member_page_size = (size_t)1 << member_page_bits;
+
+    // rect each member was inserted with, indexed by ref (plus member_index_offset); unused pages are null
+    std::vector<std::unique_ptr<member_t[]>> member_pages;
+    // all current members, for clear_light
+    std::vector<MyRef_t> member_list;
 
     ~table_t()
     {
@@ -358,6 +548,67 @@ struct table_t
     }
 
 private:
+    static inline size_t member_key(MyRef_t b)
+    {
+        return (size_t)((int)b + member_index_offset);
+    }
+
+    // entry of a ref whose page is known to exist
+    inline member_t& member_at(MyRef_t b)
+    {
+        size_t key = member_key(b);
+        return member_pages[key >> member_page_bits][key & (member_page_size - 1)];
+    }
+
+    inline member_t* find_member(MyRef_t b)
+    {
+        size_t key = member_key(b);
+        size_t page = key >> member_page_bits;
+
+        if(page >= member_pages.size() || !member_pages[page])
+            return nullptr;
+
+        member_t* m = &member_pages[page][key & (member_page_size - 1)];
+
+        if(m->slot < 0)
+            return nullptr;
+
+        return m;
+    }
+
+    inline void set_member(MyRef_t b, const rect_external& rect)
+    {
+        size_t key = member_key(b);
+        size_t page = key >> member_page_bits;
+
+        if(page >= member_pages.size())
+            member_pages.resize(page + 1);
+
+        if(!member_pages[page])
+            member_pages[page].reset(new member_t[member_page_size]);
+
+        member_t& m = member_pages[page][key & (member_page_size - 1)];
+
+        if(m.slot < 0)
+        {
+            m.slot = (int32_t)member_list.size();
+            member_list.push_back(b);
+        }
+
+        m.rect = rect;
+    }
+
+    inline void remove_member(member_t& m)
+    {
+        MyRef_t last = member_list.back();
+
+        member_at(last).slot = m.slot;
+        member_list[m.slot] = last;
+        member_list.pop_back();
+
+        m.slot = -1;
+    }
+
     void insert(MyRef_t b, const rect_external& rect)
     {
         int lcol = rect.l / 2048;
@@ -466,7 +717,7 @@ private:
                 if(inner_b & 63)
                     inner_rect.b += 1;
 
-                columns[internal_col][internal_row]->insert(b, inner_rect);
+                columns[internal_col][internal_row]->insert(b, inner_rect, node_pool);
 
                 inner_rect.cont_axes |= CONT_Y;
             }
@@ -555,7 +806,7 @@ private:
 public:
     void query(std::vector<BaseRef_t>& out, const rect_external& rect)
     {
-        if(columns.size() == 0 || member_rects.size() == 0)
+        if(columns.size() == 0 || member_list.size() == 0)
             return;
 
         int lcol = rect.l / 2048;
@@ -648,7 +899,7 @@ public:
             return;
 
         rect_external rect(loc);
-        member_rects[b] = rect;
+        set_member(b, rect);
         insert(b, rect);
     }
 
@@ -661,18 +912,18 @@ public:
             return;
 
         rect_external rect(loc);
-        member_rects[b] = rect;
+        set_member(b, rect);
         insert(b, rect);
     }
 
     void erase(MyRef_t b)
     {
-        auto it = member_rects.find(b);
-        if(it == member_rects.end())
+        member_t* m = find_member(b);
+        if(!m)
             return;
 
-        erase(b, it->second);
-        member_rects.erase(it);
+        erase(b, m->rect);
+        remove_member(*m);
     }
 
     void update(MyRef_t b)
@@ -681,34 +932,34 @@ public:
 
         rect_external rect(loc);
 
-        auto it = member_rects.find(b);
-        if(it != member_rects.end())
+        member_t* m = find_member(b);
+        if(m)
         {
             // no-change optimization
-            if(it->second.l == rect.l
-                && it->second.r == rect.r
-                && it->second.t == rect.t
-                && it->second.b == rect.b)
+            if(m->rect.l == rect.l
+                && m->rect.r == rect.r
+                && m->rect.t == rect.t
+                && m->rect.b == rect.b)
             {
                 return;
             }
 
-            erase(b, it->second);
+            erase(b, m->rect);
         }
 
         // ignore improper rects
         if(loc.Width < 0 || loc.Height < 0)
             return;
 
-        member_rects[b] = rect;
+        set_member(b, rect);
         insert(b, rect);
     }
 
     void update_layer(MyRef_t b)
     {
-        auto it = member_rects.find(b);
-        if(it != member_rects.end())
-            erase(b, it->second);
+        member_t* m = find_member(b);
+        if(m)
+            erase(b, m->rect);
 
         insert_layer(b);
     }
@@ -724,15 +975,33 @@ public:
 
         columns.clear();
         col_first_row_index.clear();
-        member_rects.clear();
+        std::vector<std::unique_ptr<member_t[]>>().swap(member_pages);
+        member_list.clear();
+        node_pool.clear();
+    }
+
+    table_stats_t stats() const
+    {
+        table_stats_t ret;
+        ret.members = member_list.size();
+        ret.overflow_nodes = node_pool.count();
+
+        for(const auto& col : columns)
+            ret.screens += col.size();
+
+        return ret;
     }
 
     void clear_light()
     {
-        for(const auto& p : member_rects)
-            erase(p.first, p.second);
+        for(MyRef_t b : member_list)
+        {
+            member_t& m = member_at(b);
+            erase(b, m.rect);
+            m.slot = -1;
+        }
 
-        member_rects.clear();
+        member_list.clear();
     }
 };
 
@@ -0,0 +1,568 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include <Logger/logger.h>
+
+#include "../globals.h"
+#include "../layers.h"
+#include "../rand.h"
+#include "../screen.h"
+#include "../npc/npc_queues.h"
+#include "../npc/section_overlap.h"
+#include "../graphics/gfx_update.h"
+#include "trees.h"
+#include "block_table.h"
+#include "game_loop_interrupt.h"
+#include "record_binary.h"
+#include "game_snapshot.h"
+
+namespace GameSnapshot
+{
+
+using RecordBinary::Writer;
+using RecordBinary::Reader;
+
+static const char c_snapshotMagic[4] = {'X', 'T', 'S', 'S'};
+static const char c_deltaMagic[4] = {'X', 'T', 'S', 'D'};
+static constexpr uint8_t c_snapshotVersion = 2;
+
+//! a differing byte run only ends once this many bytes in a row are unchanged again
+static constexpr size_t c_deltaMinSkip = 8;
+
+//! tree split flags of each layer, collected while loading and applied when the tables are rebuilt
+enum : uint8_t
+{
+    SPLIT_BLOCKS = 1,
+    SPLIT_BGOS = 2,
+    SPLIT_WATER = 4,
+};
+
+template<class T>
+static inline T s_item(int64_t v)
+{
+    return T(v);
+}
+
+template<>
+inline NPCRef_t s_item<NPCRef_t>(int64_t v)
+{
+    return NPCRef_t((int16_t)v);
+}
+
+//! writes the visited state into a snapshot
+struct SaveVisitor
+{
+    static constexpr bool loading = false;
+
+    Writer& w;
+
+    explicit SaveVisitor(Writer& w) : w(w) {}
+
+    template<class T>
+    void value(T& v)
+    {
+        w.bytes((const void*)&v, sizeof(T));
+    }
+
+    template<class T, long begin, long end>
+    void objects(RangeArr<T, begin, end>& arr, long first, long last)
+    {
+        long count = (last >= first) ? last - first + 1 : 0;
+        w.uvar((uint64_t)count);
+
+        if(count > 0)
+            w.bytes((const void*)&arr[first], sizeof(T) * count);
+    }
+
+    template<class C>
+    void list(C& c)
+    {
+        w.uvar(c.size());
+
+        for(const auto& i : c)
+            w.svar((int)i);
+    }
+};
+
+//! walks through a snapshot without modifying anything, to validate it before it's loaded
+struct CheckVisitor
+{
+    static constexpr bool loading = false;
+
+    Reader& r;
+
+    explicit CheckVisitor(Reader& r) : r(r) {}
+
+    void skip(uint64_t size)
+    {
+        if((uint64_t)(r.end - r.p) < size)
+        {
+            r.ok = false;
+            r.p = r.end;
+        }
+        else
+            r.p += size;
+    }
+
+    template<class T>
+    void value(T&)
+    {
+        skip(sizeof(T));
+    }
+
+    template<class T, long begin, long end>
+    void objects(RangeArr<T, begin, end>&, long first, long)
+    {
+        uint64_t count = r.uvar();
+
+        // the whole range must fit into the array
+        if(count > (uint64_t)(end - first + 1))
+            r.ok = false;
+
+        skip(count * sizeof(T));
+    }
+
+    template<class C>
+    void list(C&)
+    {
+        uint64_t size = r.uvar();
+
+        for(uint64_t i = 0; i < size && r.ok; i++)
+            r.svar();
+    }
+};
+
+//! restores the visited state from a validated snapshot
+struct LoadVisitor
+{
+    static constexpr bool loading = true;
+
+    Reader& r;
+
+    explicit LoadVisitor(Reader& r) : r(r) {}
+
+    template<class T>
+    void value(T& v)
+    {
+        r.bytes((void*)&v, sizeof(T));
+    }
+
+    template<class T, long begin, long end>
+    void objects(RangeArr<T, begin, end>& arr, long first, long)
+    {
+        uint64_t count = r.uvar();
+
+        if(count > 0)
+            r.bytes((void*)&arr[first], sizeof(T) * count);
+    }
+
+    template<class C>
+    void list(C& c)
+    {
+        uint64_t size = r.uvar();
+
+        c.clear();
+
+        for(uint64_t i = 0; i < size; i++)
+            c.insert(c.end(), s_item<typename C::value_type>(r.svar()));
+    }
+};
+
+static uint8_t s_layer_split[maxLayers + 1];
+
+//! visits every part of the level state in a fixed order
+template<class Visitor>
+static void s_visit(Visitor& v)
+{
+    // object counts (they must come first, because restoring the arrays depends on them)
+    v.value(numNPCs);
+    v.value(numBlock);
+    v.value(numBackground);
+    v.value(numLocked);
+    v.value(numEffects);
+    v.value(numPlayers);
+    v.value(numWater);
+    v.value(numWarps);
+    v.value(iBlocks);
+
+    // gameplay scalars
+    v.value(Score);
+    v.value(Coins);
+    v.value(Lives);
+    v.value(g_100s);
+    v.value(numStars);
+    v.value(PSwitchTime);
+    v.value(PSwitchStop);
+    v.value(PSwitchPlayer);
+    v.value(BeltDirection);
+    v.value(FreezeNPCs);
+    v.value(StopHit);
+    v.value(LevelMacro);
+    v.value(LevelMacroCounter);
+    v.value(LevelMacroWhich);
+    v.value(LevelBeatCode);
+    v.value(CommonFrame);
+    v.value(CommonFrame_NotFrozen);
+    v.value(BlocksSorted);
+    v.value(qScreen);
+    v.value(qScreen_canonical);
+    v.value(BattleLives);
+    v.value(BattleWinner);
+    v.value(BattleIntro);
+    v.value(BattleOutro);
+    v.value(OwedMount);
+    v.value(OwedMountType);
+
+    // sections (changed by events)
+    v.value(level);
+    v.value(LevelWrap);
+    v.value(LevelVWrap);
+    v.value(OffScreenExit);
+    v.value(NoTurnBack);
+    v.value(UnderWater);
+    v.value(bgMusic);
+    v.value(Background2);
+    v.value(AutoX);
+    v.value(AutoY);
+
+    // camera
+    v.value(vScreen);
+    v.value(qScreenLoc);
+    v.value(Screens);
+
+    // object arrays
+    v.objects(NPC, -128, numNPCs);
+    v.objects(Block, 0, numBlock);
+    v.objects(Background, 1, numBackground + numLocked);
+    v.objects(Effect, 1, numEffects);
+    v.objects(Player, 0, numPlayers);
+    v.objects(Water, 1, numWater);
+    v.objects(Warp, 1, numWarps);
+    v.value(iBlock);
+
+    // layers
+    for(int l = 0; l < numLayers; l++)
+    {
+        Layer_t& layer = Layer[l];
+
+        v.value(layer.EffectStop);
+        v.value(layer.Hidden);
+        v.value(layer.SpeedX);
+        v.value(layer.SpeedY);
+        v.value(layer.ApplySpeedX);
+        v.value(layer.ApplySpeedY);
+        v.value(layer.OffsetX);
+        v.value(layer.OffsetY);
+        v.value(layer.StillFrames);
+
+        v.list(layer.blocks);
+        v.list(layer.BGOs);
+        v.list(layer.NPCs);
+        v.list(layer.warps);
+        v.list(layer.waters);
+
+        uint8_t split = 0;
+
+        if(!Visitor::loading)
+        {
+            split |= treeBlockLayerActive(l) ? SPLIT_BLOCKS : 0;
+            split |= treeBackgroundLayerActive(l) ? SPLIT_BGOS : 0;
+            split |= treeWaterLayerActive(l) ? SPLIT_WATER : 0;
+        }
+
+        v.value(split);
+        s_layer_split[l] = split;
+    }
+
+    // events
+    v.value(newEventNum);
+    v.value(NewEvent);
+    v.value(newEventDelay);
+    v.value(newEventPlayer);
+
+    // NPC queues
+    v.list(NPCQueues::NoReset);
+    v.list(NPCQueues::Killed);
+    v.list(NPCQueues::PlayerTemp);
+    v.list(NPCQueues::Unchecked);
+    v.list(NPCQueues::Active.no_change);
+    v.list(NPCQueues::RespawnDelay);
+}
+
+//! the snapshot header identifies the build's object layout and the level
+static void s_write_header(Writer& w)
+{
+    w.bytes(c_snapshotMagic, 4);
+    w.u8(c_snapshotVersion);
+
+    w.uvar(sizeof(NPC_t));
+    w.uvar(sizeof(Block_t));
+    w.uvar(sizeof(Background_t));
+    w.uvar(sizeof(Effect_t));
+    w.uvar(sizeof(Player_t));
+    w.uvar(sizeof(Water_t));
+    w.uvar(sizeof(Warp_t));
+    w.uvar(sizeof(vScreen_t));
+    w.uvar(random_state_size());
+
+    w.str(FileNameFull);
+    w.uvar((uint64_t)numLayers);
+    w.uvar((uint64_t)numEvents);
+}
+
+static bool s_check_header(Reader& r)
+{
+    char magic[4];
+    if(!r.bytes(magic, 4) || std::memcmp(magic, c_snapshotMagic, 4) != 0 || r.u8() != c_snapshotVersion)
+        return false;
+
+    Writer expected;
+    s_write_header(expected);
+
+    // compare the remaining part of the header with this build and level
+    Reader exp(expected.buf.data() + 5, expected.buf.data() + expected.buf.size());
+
+    while(!exp.at_end())
+    {
+        if(r.at_end() || r.u8() != exp.u8())
+            return false;
+    }
+
+    return r.ok;
+}
+
+static bool s_can_snapshot()
+{
+#ifdef RANGE_ARR_USE_HEAP
+    // the object arrays hold pointers, so they can't be copied raw
+    return false;
+#else
+    // the game loop must not be in the middle of a frame
+    return g_gameLoopInterrupt.site == GameLoopInterrupt::None;
+#endif
+}
+
+bool Capture(std::vector<uint8_t>& out)
+{
+    if(!s_can_snapshot())
+        return false;
+
+    Writer w;
+    w.buf.swap(out);
+    w.buf.clear();
+
+    s_write_header(w);
+
+    std::vector<uint8_t> rand_state(random_state_size());
+    random_save_state(rand_state.data());
+    w.bytes(rand_state.data(), rand_state.size());
+
+    SaveVisitor save(w);
+    s_visit(save);
+
+    w.buf.swap(out);
+
+    return true;
+}
+
+//! rebuilds the lookup tables from the restored objects
+static void s_rebuild_tables()
+{
+    treeLevelCleanAll();
+
+    for(int i = 1; i <= numBlock; i++)
+        treeBlockAddLayer(Block[i].Layer, i);
+
+    for(int i = 1; i <= numBackground + numLocked; i++)
+        treeBackgroundAddLayer(Background[i].Layer, i);
+
+    for(int i = 1; i <= numWater; i++)
+        treeWaterAddLayer(Water[i].Layer, i);
+
+    for(int i = 1; i <= numNPCs; i++)
+        treeNPCAdd(i);
+
+    for(int l = 0; l < numLayers; l++)
+    {
+        if(s_layer_split[l] & SPLIT_BLOCKS)
+            treeBlockSplitLayer(l);
+
+        if(s_layer_split[l] & SPLIT_BGOS)
+            treeBackgroundSplitLayer(l);
+
+        if(s_layer_split[l] & SPLIT_WATER)
+            treeWaterSplitLayer(l);
+    }
+
+    NPCQueues::Active.invalidate();
+
+    CalculateSectionOverlaps();
+
+    invalidateDrawBlocks();
+    invalidateDrawBGOs();
+}
+
+bool Restore(const std::vector<uint8_t>& in)
+{
+    if(!s_can_snapshot())
+        return false;
+
+    Reader r(in.data(), in.data() + in.size());
+
+    if(!s_check_header(r))
+    {
+        pLogWarning("GameSnapshot: snapshot is from a different build or level");
+        return false;
+    }
+
+    const uint8_t* body = r.p;
+
+    // validate first, so that a broken snapshot can't leave a half-restored level
+    {
+        Reader check_r(body, r.end);
+        CheckVisitor check(check_r);
+        check.skip(random_state_size());
+        s_visit(check);
+
+        if(!check_r.ok || !check_r.at_end())
+        {
+            pLogWarning("GameSnapshot: snapshot is corrupt");
+            return false;
+        }
+    }
+
+    random_load_state(r.p);
+    r.p += random_state_size();
+
+    LoadVisitor load(r);
+    s_visit(load);
+
+    s_rebuild_tables();
+
+    return true;
+}
+
+void MakeDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& cur, std::vector<uint8_t>& delta)
+{
+    Writer w;
+    w.buf.swap(delta);
+    w.buf.clear();
+
+    w.bytes(c_deltaMagic, 4);
+    w.uvar(base.size());
+    w.uvar(cur.size());
+
+    const uint8_t* b = base.data();
+    const uint8_t* c = cur.data();
+    size_t m = base.size();
+    size_t n = cur.size();
+
+    // a sequence of (unchanged byte count, changed byte count, changed bytes)
+    size_t i = 0;
+    while(i < n)
+    {
+        size_t skip_start = i;
+
+        while(i < n && i < m && c[i] == b[i])
+            i++;
+
+        size_t lit_start = i;
+        size_t same = 0;
+
+        while(i < n)
+        {
+            if(i < m && c[i] == b[i])
+            {
+                if(++same >= c_deltaMinSkip)
+                    break;
+            }
+            else
+                same = 0;
+
+            i++;
+        }
+
+        size_t lit_end = (i < n) ? i + 1 - same : n - same;
+
+        w.uvar(lit_start - skip_start);
+        w.uvar(lit_end - lit_start);
+        w.bytes(c + lit_start, lit_end - lit_start);
+
+        i = lit_end;
+    }
+
+    w.buf.swap(delta);
+}
+
+bool ApplyDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta, std::vector<uint8_t>& out)
+{
+    Reader r(delta.data(), delta.data() + delta.size());
+
+    char magic[4];
+    if(!r.bytes(magic, 4) || std::memcmp(magic, c_deltaMagic, 4) != 0)
+        return false;
+
+    uint64_t base_size = r.uvar();
+    uint64_t size = r.uvar();
+
+    if(!r.ok || base_size != base.size() || &base == &out)
+        return false;
+
+    out.resize((size_t)size);
+
+    size_t i = 0;
+    while(i < out.size())
+    {
+        uint64_t skip = r.uvar();
+        uint64_t lit = r.uvar();
+
+        if(!r.ok || skip > out.size() - i || i + skip > base.size())
+            return false;
+
+        std::memcpy(out.data() + i, base.data() + i, (size_t)skip);
+        i += skip;
+
+        if(lit > out.size() - i || !r.bytes(out.data() + i, (size_t)lit))
+            return false;
+
+        i += lit;
+    }
+
+    return r.ok && r.at_end();
+}
+
+bool CaptureDelta(std::vector<uint8_t>& base, std::vector<uint8_t>& delta)
+{
+    static std::vector<uint8_t> s_cur;
+
+    if(!Capture(s_cur))
+        return false;
+
+    MakeDelta(base, s_cur, delta);
+    base.swap(s_cur);
+
+    return true;
+}
+
+} // namespace GameSnapshot
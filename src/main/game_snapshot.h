@@ -0,0 +1,69 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module captures the live level simulation state into compact in-memory snapshots
+// and restores it from them, for rewind, retrying a section, and replay bisection
+//
+// Snapshots hold raw copies of the object arrays, so they are only valid for the build that made them.
+
+#pragma once
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+namespace GameSnapshot
+{
+
+/**
+ * \brief Captures the current level state
+ * \param out Receives the full snapshot (its capacity is reused between calls)
+ * \return false if snapshots aren't supported by this build
+ */
+bool Capture(std::vector<uint8_t>& out);
+
+/**
+ * \brief Restores the level state from a full snapshot
+ *
+ * Must be called between frames, in the same level that the snapshot was captured in.
+ * Layer memberships, NPC queues, and the block/BGO/NPC/water tables are rebuilt from the restored objects.
+ *
+ * \return false (leaving the level state untouched) if the snapshot is invalid or from a different level
+ */
+bool Restore(const std::vector<uint8_t>& in);
+
+//! encodes the full snapshot cur as a delta against the full snapshot base
+void MakeDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& cur, std::vector<uint8_t>& delta);
+
+//! reconstructs a full snapshot from the full snapshot that a delta was made against; returns false if they don't match
+bool ApplyDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta, std::vector<uint8_t>& out);
+
+/**
+ * \brief Captures the current level state as a delta against the previous snapshot
+ * \param base Full previous snapshot (or empty); replaced by the new full snapshot
+ * \param delta Receives the delta from the previous to the new snapshot
+ * \return false if snapshots aren't supported by this build
+ */
+bool CaptureDelta(std::vector<uint8_t>& base, std::vector<uint8_t>& delta);
+
+} // namespace GameSnapshot
+
+#endif // #ifndef GAME_SNAPSHOT_H
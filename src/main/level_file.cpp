@@ -1543,6 +1543,8 @@ void OpenLevelDataPost()
                 level[A].Y = level[A].Height - 600; // Better and cleaner logic
         }
 
+        InvalidateSectionIndex();
+
         int B = numBackground;
         for(int A = 1; A <= numWarps; A++)
         {
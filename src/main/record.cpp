@@ -39,6 +39,10 @@
 #include "../frame_timer.h"
 #include "../config.h"
 #include "record.h"
+#include "record_binary.h"
+#include "replay_trace.h"
+#include "state_hash.h"
+#include "game_snapshot.h"
 
 #include "sdl_proxy/sdl_timer.h"
 #include "sdl_proxy/sdl_stdinc.h"
@@ -116,9 +120,18 @@ namespace Record
 // public
 FILE* record_file = nullptr;
 FILE* replay_file = nullptr;
+bool  headless_replay = false;
+int   replay_speed = 1;
+bool  replay_speed_set = false;
+int   replay_render_interval = 1;
+int64_t replay_start_frame = 0;
+std::string replay_frame_dump_dir;
+int   replay_frame_dump_interval = 64;
 
 //! Externally providen level file path for the replay
 static std::string replayLevelFilePath;
+//! path of the replayed recording, used to name its state hash stream
+static std::string s_replay_path;
 
 static const int c_recordVersion = 3;
 
@@ -132,6 +145,51 @@ static int64_t      next_record_frame = 0;
 static uint32_t     last_status_tick = 0;
 static Controls_t   last_controls[maxPlayers];
 
+static ReplayResult s_replay_result = ReplayResult::None;
+static int64_t      s_replay_frames = 0;
+
+//! wall-clock start of the replay, used to report the simulation speed
+static std::chrono::steady_clock::time_point s_replay_start;
+
+// binary format state
+static bool         s_replay_binary = false;
+static bool         s_record_binary = false;
+static RecordBinary::FileReader s_bin_reader;
+static RecordBinary::FileWriter s_bin_writer;
+
+//! frames between the full-state keyframes of a binary recording
+static constexpr int64_t c_keyframeInterval = RecordBinary::FileWriter::c_chunkFrames;
+//! scratch buffer for the keyframe snapshots
+static std::vector<uint8_t> s_keyframe_state;
+
+// binary event types (the same letters as the text record types)
+enum : uint8_t
+{
+    EVENT_CONTROL = 'C',
+    EVENT_STATUS = 'S',
+    EVENT_NPCS = 'N',
+    EVENT_END = 'E',
+    EVENT_RESULT = 'R',
+    EVENT_KEYFRAME = 'K',
+};
+
+// order of the keys, both for the text record letters and for the binary change masks
+static const char c_keyLetters[] = "UDLRSIABXY";
+static bool Controls_t::* const c_keyFields[] =
+{
+    &Controls_t::Up,
+    &Controls_t::Down,
+    &Controls_t::Left,
+    &Controls_t::Right,
+    &Controls_t::Start,
+    &Controls_t::Drop,
+    &Controls_t::Jump,
+    &Controls_t::Run,
+    &Controls_t::AltJump,
+    &Controls_t::AltRun,
+};
+static constexpr int c_numKeys = sizeof(c_keyFields) / sizeof(c_keyFields[0]);
+
 
 static void write_header()
 {
@@ -189,6 +247,45 @@ static void write_header()
     }
 }
 
+static void locate_level(const char* recorded_path, const char* md5hash)
+{
+    std::string thisHash;
+
+    // now SET the filename
+    FullFileName = replayLevelFilePath.empty() ? recorded_path : replayLevelFilePath;
+    // if(SDL_strcasecmp(buffer, FilefNameFull.c_str()))
+    //     pLogWarning("FileName does not match.");
+
+    pLogDebug("Attempt to load level file %s for the replay", FullFileName.c_str());
+
+    thisHash = md5::file_to_hashGC(FullFileName);
+
+    if(thisHash.empty())
+    {
+        FullFileName = AppPath + FullFileName;
+        pLogDebug("Not found; attempt to load level file %s for the replay", FullFileName.c_str());
+        thisHash = md5::file_to_hashGC(FullFileName);
+    }
+
+    if(thisHash.empty())
+        pLogCritical("Failed to retrieve the MD5 hash for %s file (probably, it doesn't exist)", FullFileName.c_str());
+
+    pLogDebug("Replay file (loaded %s, expected %s)", thisHash.c_str(), md5hash);
+    int hashCmp = thisHash.compare(md5hash);
+    if(hashCmp != 0)
+        pLogCritical("Loaded level file is not matched to expected (check sum missmatch %d)", hashCmp);
+}
+
+static void setup_replay_mode()
+{
+    Cheater = true; // important to avoid losing player save data in replay mode.
+    TestLevel = false;
+    // an explicit finite replay speed is paced by the frame timer
+    g_config.unlimited_framerate = !replay_speed_set || replay_speed <= 0;
+    g_config.show_fps = true;
+    g_config.enable_frameskip = false;
+}
+
 // FIXME: Implement the error returning and on-failure abortation with leading abortation of record replaying startup
 
 static void read_header()
@@ -198,7 +295,6 @@ static void read_header()
     // buffer is a 1024-character buffer used for reading strings, shared with the record_init() function.
     char buffer[1024];
     char md5hash[1024];
-    std::string thisHash;
 
     // n is an integer for some implicit conversions
     int n;
@@ -232,31 +328,10 @@ static void read_header()
 
     clipNewLine(buffer, 1024); // clip the newline :(
 
-    // now SET the filename
-    FullFileName = replayLevelFilePath.empty() ? buffer : replayLevelFilePath;
-    // if(SDL_strcasecmp(buffer, FilefNameFull.c_str()))
-    //     pLogWarning("FileName does not match.");
-
-    pLogDebug("Attempt to load level file %s for the replay", FullFileName.c_str());
-
-    thisHash = md5::file_to_hashGC(FullFileName);
-
-    if(thisHash.empty())
-    {
-        FullFileName = AppPath + FullFileName;
-        pLogDebug("Not found; attempt to load level file %s for the replay", FullFileName.c_str());
-        thisHash = md5::file_to_hashGC(FullFileName);
-    }
-
-    if(thisHash.empty())
-        pLogCritical("Failed to retrieve the MD5 hash for %s file (probably, it doesn't exist)", FullFileName.c_str());
-
     SDL_memset(md5hash, 0, sizeof(md5hash));
     fscanf(replay_file, "SumMD5 %s\r\n", md5hash); // File's hash
-    pLogDebug("Replay file (loaded %s, expected %s)", thisHash.c_str(), md5hash);
-    int hashCmp = thisHash.compare(md5hash);
-    if(hashCmp != 0)
-        pLogCritical("Loaded level file is not matched to expected (check sum missmatch %d)", hashCmp);
+
+    locate_level(buffer, md5hash);
 
     fscanf(replay_file, "Seed %d\r\n", &n); // random seed
     seedRandom(n);
@@ -329,23 +404,164 @@ static void read_header()
         Player[A].HeldBonus = NPCID(HeldBonus);
     }
 
-    Cheater = true; // important to avoid losing player save data in replay mode.
-    TestLevel = false;
-    g_config.unlimited_framerate = true;
-    g_config.show_fps = true;
-    g_config.enable_frameskip = false;
+    setup_replay_mode();
+}
+
+static void write_header_binary()
+{
+    RecordBinary::Writer w;
+
+    w.uvar(c_recordVersion);
+    w.str(LONG_VERSION);
+    w.svar(g_config.compatibility_mode);
+
+    if(FullFileName.compare(0, AppPath.size(), AppPath) == 0)
+        w.str(FullFileName.substr(AppPath.size()));
+    else
+        w.str(FullFileName);
+
+    w.str(md5::file_to_hashGC(FullFileName));
+    w.svar(readSeed());
+    w.u8((Checkpoint == FullFileName) ? 1 : 0);
+
+    if(g_config.fix_vanilla_checkpoints && Checkpoint == FullFileName)
+    {
+        w.uvar(CheckpointsList.size());
+
+        for(const Checkpoint_t& cp : CheckpointsList)
+            w.svar(cp.id);
+    }
+    else
+        w.uvar(0);
+
+    w.svar(StartWarp);
+    w.svar(ReturnWarp);
+    w.svar(Lives);
+    w.svar(Coins);
+    w.svar(Score);
+    w.uvar(numStars);
+
+    for(const auto& star : Star)
+    {
+        w.str(star.level);
+        w.svar(star.Section);
+    }
+
+    w.uvar(numPlayers);
+
+    for(int A = 1; A <= numPlayers; A++)
+    {
+        w.svar(Player[A].Character);
+        w.svar(Player[A].State);
+        w.svar(Player[A].Mount);
+        w.svar(Player[A].MountType);
+        w.svar(Player[A].HeldBonus);
+    }
+
+    s_bin_writer.open(record_file, w);
+}
+
+static void read_header_binary()
+{
+    RecordBinary::Reader r = s_bin_reader.header();
+
+    int recordVersion = (int)r.uvar();
+    pLogDebug("Loading binary recording version %d", recordVersion);
+
+    std::string version = r.str();
+    pLogDebug("Recording made with %s", version.c_str());
+
+    int n = (int)r.svar();
+    pLogDebug("  at compat level %d", n);
+
+    if(n != Config_t::COMPAT_SMBX13)
+        pLogWarning("compatibility mode is not a long-term support version. Do not expect identical results.");
+
+    g_config.compatibility_mode = n;
+    UpdateConfig();
+
+    std::string level = r.str();
+    std::string md5hash = r.str();
+    locate_level(level.c_str(), md5hash.c_str());
+
+    seedRandom((int)r.svar());
+
+    Checkpoint = r.u8() ? FullFileName : std::string();
+
+    n = (int)r.uvar();
+    if(g_config.fix_vanilla_checkpoints && Checkpoint == FullFileName)
+        CheckpointsList.resize(n);
+
+    for(int i = 0; i < n; i++)
+    {
+        int id = (int)r.svar();
+        if(g_config.fix_vanilla_checkpoints && Checkpoint == FullFileName)
+            CheckpointsList[i].id = id;
+    }
+
+    StartWarp = (int)r.svar();
+    ReturnWarp = (int)r.svar();
+    Lives = (int)r.svar();
+    Coins = (int)r.svar();
+    Score = (int)r.svar();
+    numStars = (int)r.uvar();
+
+    Star.clear();
+    if(Star.capacity() < (size_t)numStars)
+        Star.reserve(numStars);
+
+    for(int A = 1; A <= numStars && r.ok; A++)
+    {
+        Star_t star;
+        star.level = r.str();
+        star.Section = (int)r.svar();
+        Star.push_back(std::move(star));
+    }
+
+    numPlayers = (int)r.uvar();
+
+    for(int A = 1; A <= numPlayers && A <= maxPlayers; A++)
+    {
+        Player[A].Character = (vbint_t)r.svar();
+        Player[A].State = (vbint_t)r.svar();
+        Player[A].Mount = (vbint_t)r.svar();
+        Player[A].MountType = (vbint_t)r.svar();
+        Player[A].HeldBonus = NPCID(r.svar());
+    }
+
+    if(!r.ok)
+        pLogCritical("Binary record file has an invalid header!");
+
+    setup_replay_mode();
 }
 
 static void write_end()
 {
+    if(s_record_binary)
+    {
+        s_bin_writer.event(frame_no+1, EVENT_END).svar(LevelBeatCode);
+        return;
+    }
+
     fprintf(record_file, " %" PRId64 " \r\nEnd\r\nLevelBeatCode %d\r\n", frame_no+1, LevelBeatCode);
 }
 
 static void read_end()
 {
-    int b;
+    int b = 0;
+    bool valid;
 
-    if(fscanf(replay_file, "End\r\nLevelBeatCode %d\r\n", &b) != 1)
+    if(s_replay_binary)
+    {
+        valid = (s_bin_reader.next_type() == EVENT_END);
+
+        if(valid)
+            b = (int)s_bin_reader.data().svar();
+    }
+    else
+        valid = (fscanf(replay_file, "End\r\nLevelBeatCode %d\r\n", &b) == 1);
+
+    if(!valid)
     {
         pLogWarning("old gameplay file diverged (invalid end header).");
         diverged_major = true;
@@ -370,60 +586,60 @@ static void write_control()
     {
         const Controls_t& keys = Player[i+1].Controls;
 
-        if(!last_controls[i].Up && keys.Up)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dU\r\n", frame_no, i+1);
-        else if(last_controls[i].Up && !keys.Up)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dU\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Down && keys.Down)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dD\r\n", frame_no, i+1);
-        else if(last_controls[i].Down && !keys.Down)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dD\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Left && keys.Left)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dL\r\n", frame_no, i+1);
-        else if(last_controls[i].Left && !keys.Left)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dL\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Right && keys.Right)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dR\r\n", frame_no, i+1);
-        else if(last_controls[i].Right && !keys.Right)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dR\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Start && keys.Start)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dS\r\n", frame_no, i+1);
-        else if(last_controls[i].Start && !keys.Start)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dS\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Drop && keys.Drop)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dI\r\n", frame_no, i+1);
-        else if(last_controls[i].Drop && !keys.Drop)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dI\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Jump && keys.Jump)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dA\r\n", frame_no, i+1);
-        else if(last_controls[i].Jump && !keys.Jump)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dA\r\n", frame_no, i+1);
-
-        if(!last_controls[i].Run && keys.Run)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dB\r\n", frame_no, i+1);
-        else if(last_controls[i].Run && !keys.Run)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dB\r\n", frame_no, i+1);
-
-        if(!last_controls[i].AltJump && keys.AltJump)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dX\r\n", frame_no, i+1);
-        else if(last_controls[i].AltJump && !keys.AltJump)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dX\r\n", frame_no, i+1);
-
-        if(!last_controls[i].AltRun && keys.AltRun)
-            fprintf(record_file, " %" PRId64 "\r\nC+%dY\r\n", frame_no, i+1);
-        else if(last_controls[i].AltRun && !keys.AltRun)
-            fprintf(record_file, " %" PRId64 "\r\nC-%dY\r\n", frame_no, i+1);
+        if(s_record_binary)
+        {
+            uint32_t changed = 0;
+
+            for(int k = 0; k < c_numKeys; k++)
+            {
+                if(last_controls[i].*c_keyFields[k] != keys.*c_keyFields[k])
+                    changed |= (1 << k);
+            }
+
+            if(changed)
+            {
+                RecordBinary::Writer& w = s_bin_writer.event(frame_no, EVENT_CONTROL);
+                w.u8((uint8_t)i);
+                w.uvar(changed);
+            }
+        }
+        else
+        {
+            for(int k = 0; k < c_numKeys; k++)
+            {
+                if(!(last_controls[i].*c_keyFields[k]) && keys.*c_keyFields[k])
+                    fprintf(record_file, " %" PRId64 "\r\nC+%d%c\r\n", frame_no, i+1, c_keyLetters[k]);
+                else if(last_controls[i].*c_keyFields[k] && !(keys.*c_keyFields[k]))
+                    fprintf(record_file, " %" PRId64 "\r\nC-%d%c\r\n", frame_no, i+1, c_keyLetters[k]);
+            }
+        }
 
         last_controls[i] = keys;
     }
 
-    fflush(record_file);
+    if(!s_record_binary)
+        fflush(record_file);
+}
+
+// replicate the controls changes of a replay in the new recording
+static void replicate_control(int i, uint32_t changed)
+{
+    if(!record_file)
+        return;
+
+    if(s_record_binary)
+    {
+        RecordBinary::Writer& w = s_bin_writer.event(frame_no, EVENT_CONTROL);
+        w.u8((uint8_t)i);
+        w.uvar(changed);
+        return;
+    }
+
+    for(int k = 0; k < c_numKeys; k++)
+    {
+        if(changed & (1 << k))
+            fprintf(record_file, " %" PRId64 "\r\nC%c%d%c\r\n", frame_no, (last_controls[i].*c_keyFields[k]) ? '+' : '-', i+1, c_keyLetters[k]);
+    }
 }
 
 static void read_control()
@@ -434,34 +650,54 @@ static void read_control()
     if(fscanf(replay_file, "C%c%d%c\r\n", &mode, &p, &key) != 3)
         return;
 
+    if(p < 1 || p > maxPlayers)
+        return;
+
     bool set = (mode != '-');
 
-    if(key == 'U')
-        last_controls[p-1].Up = set;
-    else if(key == 'D')
-        last_controls[p-1].Down = set;
-    else if(key == 'L')
-        last_controls[p-1].Left = set;
-    else if(key == 'R')
-        last_controls[p-1].Right = set;
-    else if(key == 'S')
-        last_controls[p-1].Start = set;
-    else if(key == 'I')
-        last_controls[p-1].Drop = set;
-    else if(key == 'A')
-        last_controls[p-1].Jump = set;
-    else if(key == 'B')
-        last_controls[p-1].Run = set;
-    else if(key == 'X')
-        last_controls[p-1].AltJump = set;
-    else if(key == 'Y')
-        last_controls[p-1].AltRun = set;
-
-    // replicate the controls changes in the new recording
-    if(record_file)
+    for(int k = 0; k < c_numKeys; k++)
+    {
+        if(key == c_keyLetters[k])
+        {
+            last_controls[p-1].*c_keyFields[k] = set;
+            replicate_control(p-1, 1 << k);
+            break;
+        }
+    }
+}
+
+static void read_control_binary()
+{
+    RecordBinary::Reader& r = s_bin_reader.data();
+
+    int i = r.u8();
+    uint32_t changed = (uint32_t)r.uvar();
+
+    if(!r.ok || i >= maxPlayers)
+        return;
+
+    for(int k = 0; k < c_numKeys; k++)
+    {
+        if(changed & (1 << k))
+            last_controls[i].*c_keyFields[k] = !(last_controls[i].*c_keyFields[k]);
+    }
+
+    replicate_control(i, changed);
+}
+
+static int count_active_NPCs()
+{
+    int numActiveNPCs = 0;
+    if(frame_no != 0)
     {
-        fprintf(record_file, " %" PRId64 "\r\nC%c%d%c\r\n", frame_no, mode, p, key);
+        for(int i = 1; i <= numNPCs; i++)
+        {
+            if(NPC[i].Active)
+                numActiveNPCs ++;
+        }
     }
+
+    return numActiveNPCs;
 }
 
 static void write_status()
@@ -473,24 +709,40 @@ static void write_status()
         g_stats.renderedBGOs = 0;
     }
 
-    fprintf(record_file, " %" PRId64 " \r\nStatus\r\n", frame_no);
     uint32_t status_tick = SDL_GetTicks();
-    fprintf(record_file, "Ticks %lu\r\n", (long unsigned)(SDL_GetTicks() - last_status_tick));
+    uint32_t ticks = SDL_GetTicks() - last_status_tick;
     last_status_tick = status_tick;
-    fprintf(record_file, "randCalls %ld\r\n", random_ncalls());
-    fprintf(record_file, "Score %d\r\n", Score);
-    fprintf(record_file, "numNPCs %d\r\n", numNPCs);
 
-    int numActiveNPCs = 0;
-    if(frame_no != 0)
+    int numActiveNPCs = count_active_NPCs();
+
+    if(s_record_binary)
     {
-        for(int i = 1; i <= numNPCs; i++)
+        RecordBinary::Writer& w = s_bin_writer.event(frame_no, EVENT_STATUS);
+        w.uvar(ticks);
+        w.svar(random_ncalls());
+        w.svar(Score);
+        w.uvar(numNPCs);
+        w.uvar(numActiveNPCs);
+        w.uvar(g_stats.renderedNPCs);
+        w.uvar(g_stats.renderedBlocks);
+        w.uvar(g_stats.renderedBGOs);
+        w.uvar(numPlayers);
+
+        for(int i = 1; i <= numPlayers; i++)
         {
-            if(NPC[i].Active)
-                numActiveNPCs ++;
+            w.f64(Player[i].Location.X);
+            w.f64(Player[i].Location.Y);
         }
+
+        return;
     }
 
+    fprintf(record_file, " %" PRId64 " \r\nStatus\r\n", frame_no);
+    fprintf(record_file, "Ticks %lu\r\n", (long unsigned)ticks);
+    fprintf(record_file, "randCalls %ld\r\n", random_ncalls());
+    fprintf(record_file, "Score %d\r\n", Score);
+    fprintf(record_file, "numNPCs %d\r\n", numNPCs);
+
     fprintf(record_file, "numActiveNPCs %d\r\n", numActiveNPCs);
     fprintf(record_file, "numRenderNPCs %d\r\nnumRenderBlocks %d\r\nnumRenderBGOs %d\r\n",
         g_stats.renderedNPCs, g_stats.renderedBlocks, g_stats.renderedBGOs);
@@ -504,45 +756,43 @@ static void write_status()
     fflush(record_file);
 }
 
-static void read_status()
+// keyframe data: the controls that were held before this frame, and a snapshot of the level state
+static void write_keyframe()
 {
-    if(frame_no == 0)
-    {
-        g_stats.renderedNPCs = 0;
-        g_stats.renderedBlocks = 0;
-        g_stats.renderedBGOs = 0;
-    }
+    if(!GameSnapshot::Capture(s_keyframe_state))
+        return;
 
-    int o_ticks, o_Score, o_numNPCs, o_numActiveNPCs, o_renderedNPCs, o_renderedBlocks, o_renderedBGOs;
-    long o_randCalls;
+    RecordBinary::Writer data;
+    data.u8((uint8_t)numPlayers);
 
-    int success = 0;
+    for(int i = 0; i < numPlayers; i++)
+    {
+        uint32_t held = 0;
 
-    fscanf(replay_file, "Status\r\n%n", &success);
+        for(int k = 0; k < c_numKeys; k++)
+        {
+            if(last_controls[i].*c_keyFields[k])
+                held |= (1 << k);
+        }
 
-    if(!success)
-    {
-        pLogWarning("old gameplay file diverged (invalid status header) at frame %" PRId64 ".", frame_no);
-        diverged_major = true;
-        return;
+        data.uvar(held);
     }
 
-    if(fscanf(replay_file,
-              "Ticks %d\r\n"
-              "randCalls %ld\r\n"
-              "Score %d\r\n"
-              "numNPCs %d\r\n"
-              "numActiveNPCs %d\r\n"
-              "numRenderNPCs %d\r\n"
-              "numRenderBlocks %d\r\n"
-              "numRenderBGOs %d\r\n",
-        &o_ticks, &o_randCalls, &o_Score, &o_numNPCs, &o_numActiveNPCs, &o_renderedNPCs, &o_renderedBlocks, &o_renderedBGOs) != 8)
-    {
-        pLogWarning("old gameplay file diverged (invalid status info) at frame %" PRId64 ".", frame_no);
-        diverged_major = true;
-        return;
-    }
+    data.bytes(s_keyframe_state.data(), s_keyframe_state.size());
+
+    RecordBinary::Writer& w = s_bin_writer.keyframe(frame_no, EVENT_KEYFRAME);
+    w.uvar(data.buf.size());
+    w.bytes(data.buf.data(), data.buf.size());
+}
+
+//! render stats are only meaningful if every replayed frame is drawn
+static bool s_check_render_stats()
+{
+    return !headless_replay && !(FastForwarding() && replay_render_interval != 1);
+}
 
+static void check_status(long o_randCalls, int o_Score, int o_numNPCs, int o_numActiveNPCs, int o_renderedNPCs, int o_renderedBlocks, int o_renderedBGOs)
+{
     if(o_randCalls != random_ncalls())
     {
         pLogWarning("randCalls diverged (old: %d, new: %ld) at frame %" PRId64 ".", o_randCalls, random_ncalls(), frame_no);
@@ -570,15 +820,7 @@ static void read_status()
         diverged_major = true;
     }
 
-    int numActiveNPCs = 0;
-    if(frame_no != 0)
-    {
-        for(int i = 1; i <= numNPCs; i++)
-        {
-            if(NPC[i].Active)
-                numActiveNPCs ++;
-        }
-    }
+    int numActiveNPCs = count_active_NPCs();
 
     if(o_numActiveNPCs != numActiveNPCs)
     {
@@ -586,23 +828,86 @@ static void read_status()
         diverged_minor = true;
     }
 
-    if(o_renderedNPCs != g_stats.renderedNPCs)
+    // nothing gets drawn in headless mode, so the render stats are meaningless
+    if(s_check_render_stats() && o_renderedNPCs != g_stats.renderedNPCs)
     {
         pLogWarning("renderedNPCs diverged (old: %d, new: %d) at frame %" PRId64 ".", o_renderedNPCs, g_stats.renderedNPCs, frame_no);
         diverged_minor = true;
     }
 
-    if(o_renderedBlocks != g_stats.renderedBlocks)
+    if(s_check_render_stats() && o_renderedBlocks != g_stats.renderedBlocks)
     {
         pLogWarning("renderedBlocks diverged (old: %d, new: %d) at frame %" PRId64 ".", o_renderedBlocks, g_stats.renderedBlocks, frame_no);
         diverged_minor = true;
     }
 
-    if(o_renderedBGOs != g_stats.renderedBGOs)
+    if(s_check_render_stats() && o_renderedBGOs != g_stats.renderedBGOs)
     {
         pLogWarning("renderedBGOs diverged (old: %d, new: %d) at frame %" PRId64 ".", o_renderedBGOs, g_stats.renderedBGOs, frame_no);
         diverged_minor = true;
     }
+}
+
+static void check_player_location(int i, double px, double py)
+{
+    // quite non-strict because in a true divergence situation, it will get continually worse
+    if(SDL_fabs(px - Player[i].Location.X) > 0.01 ||
+       SDL_fabs(py - Player[i].Location.Y) > 0.01)
+    {
+        pLogWarning("player %d position diverged (old x=%f new x=%f, old y=%f new y=%f) at frame %" PRId64 ".",
+                    i,
+                    px, Player[i].Location.X,
+                    py, Player[i].Location.Y, frame_no);
+        diverged_minor = true;
+        if(SDL_fabs(px - Player[i].Location.X) > 1 ||
+           SDL_fabs(py - Player[i].Location.Y) > 1)
+        {
+            pLogWarning("  this is a major divergence.");
+            diverged_major = true;
+        }
+    }
+}
+
+static void read_status()
+{
+    if(frame_no == 0)
+    {
+        g_stats.renderedNPCs = 0;
+        g_stats.renderedBlocks = 0;
+        g_stats.renderedBGOs = 0;
+    }
+
+    int o_ticks, o_Score, o_numNPCs, o_numActiveNPCs, o_renderedNPCs, o_renderedBlocks, o_renderedBGOs;
+    long o_randCalls;
+
+    int success = 0;
+
+    fscanf(replay_file, "Status\r\n%n", &success);
+
+    if(!success)
+    {
+        pLogWarning("old gameplay file diverged (invalid status header) at frame %" PRId64 ".", frame_no);
+        diverged_major = true;
+        return;
+    }
+
+    if(fscanf(replay_file,
+              "Ticks %d\r\n"
+              "randCalls %ld\r\n"
+              "Score %d\r\n"
+              "numNPCs %d\r\n"
+              "numActiveNPCs %d\r\n"
+              "numRenderNPCs %d\r\n"
+              "numRenderBlocks %d\r\n"
+              "numRenderBGOs %d\r\n",
+        &o_ticks, &o_randCalls, &o_Score, &o_numNPCs, &o_numActiveNPCs, &o_renderedNPCs, &o_renderedBlocks, &o_renderedBGOs) != 8)
+    {
+        pLogWarning("old gameplay file diverged (invalid status info) at frame %" PRId64 ".", frame_no);
+        diverged_major = true;
+        return;
+    }
+
+    check_status(o_randCalls, o_Score, o_numNPCs, o_numActiveNPCs, o_renderedNPCs, o_renderedBlocks, o_renderedBGOs);
 
     for(int i = 1; i <= numPlayers; i++)
     {
@@ -615,27 +920,85 @@ static void read_status()
             break;
         }
 
-        // quite non-strict because in a true divergence situation, it will get continually worse
-        if(SDL_fabs(px - Player[i].Location.X) > 0.01 ||
-           SDL_fabs(py - Player[i].Location.Y) > 0.01)
+        check_player_location(i, px, py);
+    }
+}
+
+static void read_status_binary()
+{
+    if(frame_no == 0)
+    {
+        g_stats.renderedNPCs = 0;
+        g_stats.renderedBlocks = 0;
+        g_stats.renderedBGOs = 0;
+    }
+
+    RecordBinary::Reader& r = s_bin_reader.data();
+
+    r.uvar(); // ticks
+    long o_randCalls = (long)r.svar();
+    int o_Score = (int)r.svar();
+    int o_numNPCs = (int)r.uvar();
+    int o_numActiveNPCs = (int)r.uvar();
+    int o_renderedNPCs = (int)r.uvar();
+    int o_renderedBlocks = (int)r.uvar();
+    int o_renderedBGOs = (int)r.uvar();
+    int o_numPlayers = (int)r.uvar();
+
+    if(!r.ok)
+    {
+        pLogWarning("old gameplay file diverged (invalid status info) at frame %" PRId64 ".", frame_no);
+        diverged_major = true;
+        return;
+    }
+
+    check_status(o_randCalls, o_Score, o_numNPCs, o_numActiveNPCs, o_renderedNPCs, o_renderedBlocks, o_renderedBGOs);
+
+    for(int i = 1; i <= o_numPlayers; i++)
+    {
+        double px = r.f64();
+        double py = r.f64();
+
+        if(!r.ok || i > numPlayers)
         {
-            pLogWarning("player %d position diverged (old x=%f new x=%f, old y=%f new y=%f) at frame %" PRId64 ".",
-                        i,
-                        px, Player[i].Location.X,
-                        py, Player[i].Location.Y, frame_no);
-            diverged_minor = true;
-            if(SDL_fabs(px - Player[i].Location.X) > 1 ||
-               SDL_fabs(py - Player[i].Location.Y) > 1)
-            {
-                pLogWarning("  this is a major divergence.");
-                diverged_major = true;
-            }
+            pLogWarning("old gameplay file diverged (invalid player %d info) at frame %" PRId64 ".", i, frame_no);
+            diverged_major = true;
+            continue;
         }
+
+        check_player_location(i, px, py);
     }
 }
 
 static void write_NPCs()
 {
+    if(s_record_binary)
+    {
+        RecordBinary::Writer& w = s_bin_writer.event(frame_no, EVENT_NPCS);
+        w.uvar(numNPCs);
+
+        for(int i = 1; i <= numNPCs; i++)
+        {
+            const NPC_t& n = NPC[i];
+            w.uvar(n.Type);
+            w.u8(n.Active);
+            w.f64(n.Direction);
+            w.f64(n.Location.X);
+            w.f64(n.Location.Y);
+            w.f64(n.Location.Width);
+            w.f64(n.Location.Height);
+            w.f64(n.Special);
+            w.f64(n.Special2);
+            w.f64(n.Special3);
+            w.f64(n.Special4);
+            w.f64(n.Special5);
+            w.f64(n.SpecialX);
+            w.f64(n.SpecialY);
+        }
+
+        return;
+    }
+
     fprintf(record_file, " %" PRId64 " \r\nNPCs\r\nnumNPCs %d\r\n", frame_no, numNPCs);
     for(int i = 1; i <= numNPCs; i++)
     {
@@ -649,6 +1012,51 @@ static void write_NPCs()
     }
 }
 
+static void check_NPC(int i, int T, int A, double D, double X, double Y, double W, double H, const double (&sOld)[7])
+{
+    const NPC_t& n = NPC[i];
+
+    if(T != n.Type)
+    {
+        pLogWarning("NPC[%d].Type diverged (old %d, new %d) at frame %" PRId64 ".", i, T, n.Type, frame_no);
+        diverged_major = true;
+    }
+
+    if((bool)A != n.Active)
+    {
+        pLogWarning("NPC[%d].Active diverged (old %d, new %d; type %d) at frame %" PRId64 ".", i, A, n.Active, n.Type, frame_no);
+        diverged_minor = true;
+    }
+
+    if(!fEqual((float)D, n.Direction))
+    {
+        pLogWarning("NPC[%d].Direction diverged (old %f, new %f; type %d) at frame %" PRId64 ".", i, D, n.Direction, n.Type, frame_no);
+        diverged_minor = true;
+    }
+
+    if(SDL_fabs(X - n.Location.X) > 0.01 ||
+       SDL_fabs(Y - n.Location.Y) > 0.01 ||
+       SDL_fabs(W - n.Location.Width) > 0.01 ||
+       SDL_fabs(H - n.Location.Height) > 0.01)
+    {
+        pLogWarning("NPC[%d].Location diverged (old %lf %lf %lf %lf, new %lf %lf %lf %lf; type %d) at frame %" PRId64 ".", i,
+            X, Y, W, H, n.Location.X, n.Location.Y, n.Location.Width, n.Location.Height, n.Type, frame_no);
+        diverged_minor = true;
+    }
+
+    double sNew[] = {(double)n.Special, (double)n.Special2, (double)n.Special3, (double)n.Special4, (double)n.Special5, (double)n.SpecialX, (double)n.SpecialY};
+
+    for(int s = 0; s < 7; ++s)
+    {
+        if(!fEqual(sOld[s], sNew[s]))
+        {
+            pLogWarning("NPC[%d].Special%d diverged (old %f => new %f; type %d) at frame %" PRId64 ".",
+                        i, s + 1, sOld[s], sNew[s], n.Type, frame_no);
+            diverged_minor = true;
+        }
+    }
+}
+
 static void read_NPCs()
 {
     int success = 0;
@@ -713,48 +1121,8 @@ static void read_NPCs()
             if(i > numNPCs)
                 continue;
 
-            const NPC_t& n = NPC[i];
-
-            if(T != n.Type)
-            {
-                pLogWarning("NPC[%d].Type diverged (old %d, new %d) at frame %" PRId64 ".", i, T, n.Type, frame_no);
-                diverged_major = true;
-            }
-
-            if((bool)A != n.Active)
-            {
-                pLogWarning("NPC[%d].Active diverged (old %d, new %d; type %d) at frame %" PRId64 ".", i, A, n.Active, n.Type, frame_no);
-                diverged_minor = true;
-            }
-
-            if(!fEqual((float)D, n.Direction))
-            {
-                pLogWarning("NPC[%d].Direction diverged (old %f, new %f; type %d) at frame %" PRId64 ".", i, D, n.Direction, n.Type, frame_no);
-                diverged_minor = true;
-            }
-
-            if(SDL_fabs(X - n.Location.X) > 0.01 ||
-               SDL_fabs(Y - n.Location.Y) > 0.01 ||
-               SDL_fabs(W - n.Location.Width) > 0.01 ||
-               SDL_fabs(H - n.Location.Height) > 0.01)
-            {
-                pLogWarning("NPC[%d].Location diverged (old %lf %lf %lf %lf, new %lf %lf %lf %lf; type %d) at frame %" PRId64 ".", i,
-                    X, Y, W, H, n.Location.X, n.Location.Y, n.Location.Width, n.Location.Height, n.Type, frame_no);
-                diverged_minor = true;
-            }
-
-            double sOld[] = {S1, S2, S3, S4, S5, S6, S7};
-            double sNew[] = {(double)n.Special, (double)n.Special2, (double)n.Special3, (double)n.Special4, (double)n.Special5, (double)n.SpecialX, (double)n.SpecialY};
-
-            for(int s = 0; s < 7; ++s)
-            {
-                if(!fEqual(sOld[s], sNew[s]))
-                {
-                    pLogWarning("NPC[%d].Special%d diverged (old %f => new %f; type %d) at frame %" PRId64 ".",
-                                i, s + 1, sOld[s], sNew[s], n.Type, frame_no);
-                    diverged_minor = true;
-                }
-            }
+            const double sOld[] = {S1, S2, S3, S4, S5, S6, S7};
+            check_NPC(i, T, A, D, X, Y, W, H, sOld);
 
 //            if(S1 != n.Special || S2 != n.Special2 || S3 != n.Special3 || S4 != n.Special4 || S5 != n.Special5 || S6 != n.Special6 || S7 != n.Special7)
 //            {
@@ -773,6 +1141,115 @@ static void read_NPCs()
     }
 }
 
+static void read_NPCs_binary()
+{
+    RecordBinary::Reader& r = s_bin_reader.data();
+
+    int o_numNPCs = (int)r.uvar();
+
+    if(r.ok && o_numNPCs != numNPCs)
+    {
+        pLogWarning("numNPCs diverged (old %d, new %d) at frame %" PRId64 ".", o_numNPCs, numNPCs, frame_no);
+        diverged_major = true;
+    }
+
+    for(int i = 1; i <= o_numNPCs && r.ok; i++)
+    {
+        int T = (int)r.uvar();
+        int A = r.u8();
+        double D = r.f64();
+        double X = r.f64();
+        double Y = r.f64();
+        double W = r.f64();
+        double H = r.f64();
+
+        double sOld[7];
+        for(int s = 0; s < 7; s++)
+            sOld[s] = r.f64();
+
+        if(r.ok && i <= numNPCs)
+            check_NPC(i, T, A, D, X, Y, W, H, sOld);
+    }
+
+    if(!r.ok)
+    {
+        pLogWarning("old gameplay file diverged (invalid NPC data) at frame %" PRId64 ".", frame_no);
+        diverged_major = true;
+    }
+}
+
+//! consumes the current keyframe event's data (like the other event readers, the caller then moves on with next()),
+//!   and returns its payload; returns false if the keyframe is corrupt
+static bool take_keyframe(RecordBinary::Reader& payload)
+{
+    RecordBinary::Reader& r = s_bin_reader.data();
+
+    uint64_t size = r.uvar();
+    if(!r.ok || (uint64_t)(r.end - r.p) < size)
+    {
+        r.ok = false;
+        return false;
+    }
+
+    payload = RecordBinary::Reader(r.p, r.p + size);
+    r.p += size;
+
+    return true;
+}
+
+//! restores the state of the last keyframe at or before replay_start_frame; returns false if the replay must start from frame 0
+static bool seek_keyframe()
+{
+    int64_t at = s_bin_reader.seek_chunk(replay_start_frame, true);
+
+    if(at <= 0 || s_bin_reader.next_frame() != at || s_bin_reader.next_type() != EVENT_KEYFRAME)
+    {
+        pLogWarning("Replayed recording has no keyframe at or before frame %" PRId64 ", replaying from the start.", replay_start_frame);
+        return false;
+    }
+
+    RecordBinary::Reader data;
+
+    if(!take_keyframe(data))
+    {
+        pLogWarning("Keyframe at frame %" PRId64 " is corrupt, replaying from the start.", at);
+        return false;
+    }
+
+    int players = data.u8();
+    Controls_t held[maxPlayers];
+
+    for(int i = 0; i < players; i++)
+    {
+        uint32_t mask = (uint32_t)data.uvar();
+
+        if(i >= maxPlayers)
+            continue;
+
+        for(int k = 0; k < c_numKeys; k++)
+            held[i].*c_keyFields[k] = (mask & (1 << k)) != 0;
+    }
+
+    s_keyframe_state.assign(data.p, data.end);
+
+    if(!data.ok || players != numPlayers || !GameSnapshot::Restore(s_keyframe_state))
+    {
+        pLogWarning("Keyframe at frame %" PRId64 " can't be restored (made by a different build?), replaying from the start.", at);
+        return false;
+    }
+
+    for(int i = 0; i < numPlayers; i++)
+        last_controls[i] = held[i];
+
+    // the keyframe event has been consumed, continue with the events of its frame
+    s_bin_reader.next();
+
+    pLogDebug("Replay resumed from the keyframe at frame %" PRId64, at);
+    frame_no = at;
+
+    return true;
+}
+
 void InitRecording()
 {
     if(LevelEditor || GameMenu || GameOutro)
@@ -793,14 +1270,35 @@ void InitRecording()
 
     std::string filename = makeRecordPrefix();
 
-    if(!record_file)
+    // a fast-forwarded replay doesn't draw every frame, so its render stats couldn't be re-recorded,
+    // and a replay started at a keyframe would make a recording without its beginning
+    if(!record_file && !headless_replay && !FastForwarding() && !(replay_file && replay_start_frame > 0))
         record_file = Files::utf8_fopen(filename.c_str(), "wb");
 
     // start of gameplay data
     seedRandom(iRand(32767));
 
     if(replay_file)
+        s_replay_start = std::chrono::steady_clock::now();
+
+    if(replay_file && s_replay_binary)
     {
+        read_header_binary();
+        s_bin_reader.rewind();
+        next_record_frame = s_bin_reader.next_frame();
+
+        if(next_record_frame < 0)
+        {
+            pLogWarning("Replayed recording file has prematurely ended.");
+            diverged_major = true;
+            EndRecording();
+        }
+    }
+    else if(replay_file)
+    {
+        if(replay_start_frame > 0)
+            pLogWarning("Text recordings have no keyframes, replaying from the start.");
+
         read_header();
         if(!fscanf(replay_file, "%" PRId64 "\r\n", &next_record_frame))
         {
@@ -811,10 +1309,25 @@ void InitRecording()
     }
 
     if(record_file)
-        write_header();
+    {
+        s_record_binary = g_config.record_gameplay_binary;
+
+        if(s_record_binary)
+            write_header_binary();
+        else
+            write_header();
+    }
 
     for(int i = 0; i < numPlayers; i++)
         last_controls[i] = Controls_t();
+
+    ReplayTrace::Start();
+
+    // replays hash next to the replayed file (tagged with the build), new recordings next to the recording
+    if(replay_file)
+        StateHash::Start(s_replay_path + "." + SHORT_VERSION + ".hash");
+    else
+        StateHash::Start(filename.substr(0, filename.size() - 4) + ".hash");
 }
 
 // need to preload level info from the replay to load with proper compat
@@ -829,11 +1342,33 @@ void LoadReplay(const std::string &recording_path, const std::string &level_path
     if(!replay_file)
     {
         replay_file = Files::utf8_fopen(recording_path.c_str(), "rb");
-        if(replay_file)
+        s_replay_path = recording_path;
+
+        s_replay_binary = replay_file && RecordBinary::IsBinary(replay_file);
+
+        if(s_replay_binary && !s_bin_reader.load(replay_file))
+        {
+            pLogCritical("Binary record file %s is invalid!", recording_path.c_str());
+            fclose(replay_file);
+            replay_file = nullptr;
+            s_replay_binary = false;
+        }
+
+        if(s_replay_binary)
+            read_header_binary();
+        else if(replay_file)
             read_header();
     }
 }
 
+static void write_result(const char* text)
+{
+    if(s_record_binary)
+        s_bin_writer.event(frame_no+1, EVENT_RESULT).u8((uint8_t)s_replay_result);
+    else
+        fprintf(record_file, "%s\r\n", text);
+}
+
 void EndRecording()
 {
     if(!record_file && !replay_file)
@@ -841,6 +1376,9 @@ void EndRecording()
 
     in_level = false;
 
+    ReplayTrace::Stop();
+    StateHash::Stop();
+
     if(record_file)
         write_end();
 
@@ -848,28 +1386,38 @@ void EndRecording()
     {
         read_end();
 
+        s_replay_frames = frame_no;
+
+        double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - s_replay_start).count();
+        double sim_fps = (wall_time > 0.0) ? frame_no / wall_time : 0.0;
+        pLogDebug("Replay simulated %" PRId64 " frames in %.2f s (%.1f FPS, %.2fx real time)", frame_no, wall_time, sim_fps, sim_fps / c_gameFramesPerSecond);
+        printf("Replay simulated %" PRId64 " frames in %.2f s (%.1f FPS, %.2fx real time)\n", frame_no, wall_time, sim_fps, sim_fps / c_gameFramesPerSecond);
+
         if(!diverged_minor && !diverged_major)
         {
+            s_replay_result = ReplayResult::Pass;
             pLogDebug("CONGRATULATIONS! Your build's run did not diverge from the old run.");
             printf("CONGRATULATIONS! Your build's run did not diverge from the old run.\n");
 
             if(record_file)
-                fprintf(record_file, "DID NOT diverge from old run.\r\n");
+                write_result("DID NOT diverge from old run.");
         }
         else if(!diverged_major)
         {
+            s_replay_result = ReplayResult::Minor;
             pLogDebug("Your build's run only had MINOR divergence from the old run.");
             printf("Your build's run only had MINOR divergence from the old run.\n");
 
             if(record_file)
-                fprintf(record_file, "MINOR divergence from old run.\r\n");
+                write_result("MINOR divergence from old run.");
         }
         else
         {
+            s_replay_result = ReplayResult::Diverged;
             pLogWarning("I'm sorry, but your build's run DIVERGED from the old run.");
             printf("I'm sorry, but your build's run DIVERGED from the old run.\n");
             if(record_file)
-                fprintf(record_file, "DIVERGED from old run.\r\n");
+                write_result("DIVERGED from old run.");
         }
 
         fclose(replay_file);
@@ -880,17 +1428,123 @@ void EndRecording()
 
     if(record_file)
     {
+        if(s_record_binary)
+            s_bin_writer.finish();
+
         fclose(record_file);
         record_file = nullptr;
     }
 }
 
+bool FastForwarding()
+{
+    return replay_file && replay_speed != 1;
+}
+
+bool FastForwardNoDelay()
+{
+    if(!FastForwarding())
+        return false;
+
+    // frame_no has already been advanced by Sync() for the current frame
+    return replay_speed <= 0 || (frame_no % replay_speed) != 0;
+}
+
+int64_t FrameDumpNumber()
+{
+    if(!replay_file || replay_frame_dump_dir.empty() || replay_frame_dump_interval <= 0)
+        return -1;
+
+    // frame_no has already been advanced by Sync() for the current frame
+    return (frame_no % replay_frame_dump_interval) == 0 ? frame_no : -1;
+}
+
+bool SkipDraw()
+{
+    if(!replay_file)
+        return false;
+
+    if(headless_replay)
+        return true;
+
+    if(FrameDumpNumber() >= 0)
+        return false;
+
+    if(!FastForwarding() || replay_render_interval == 1)
+        return false;
+
+    return replay_render_interval <= 0 || (frame_no % replay_render_interval) != 0;
+}
+
+ReplayResult GetReplayResult(int64_t* frames)
+{
+    if(frames)
+        *frames = s_replay_frames;
+
+    return s_replay_result;
+}
+
 void Sync()
 {
     if(!record_file && !replay_file)
         return; // Do nothing
 
-    if(replay_file)
+    if(replay_file && s_replay_binary)
+    {
+        // the keyframe must be restored between frames, after the level has been fully set up
+        if(frame_no == 0 && replay_start_frame > 0)
+        {
+            if(!seek_keyframe())
+                s_bin_reader.rewind();
+
+            next_record_frame = s_bin_reader.next_frame();
+        }
+
+        while(next_record_frame == frame_no && replay_file)
+        {
+            uint8_t type = s_bin_reader.next_type();
+
+            if(type == EVENT_STATUS)
+                read_status_binary();
+            else if(type == EVENT_END)
+                read_end();
+            else if(type == EVENT_NPCS)
+                read_NPCs_binary();
+            else if(type == EVENT_CONTROL)
+                read_control_binary();
+            else if(type == EVENT_KEYFRAME)
+            {
+                // keyframes are only used to seek
+                RecordBinary::Reader payload;
+                if(!take_keyframe(payload))
+                    pLogWarning("Keyframe at frame %" PRId64 " of the replayed recording is corrupt.", frame_no);
+            }
+            else if(type == EVENT_RESULT)
+                s_bin_reader.data().u8();
+            else
+            {
+                pLogWarning("Invalid record type %c in replayed recording file.", type);
+                diverged_major = true;
+                EndRecording();
+                return;
+            }
+
+            s_bin_reader.next();
+            next_record_frame = s_bin_reader.next_frame();
+
+            if(next_record_frame < 0)
+            {
+                pLogWarning("Replayed recording file has prematurely ended.");
+                diverged_major = true;
+                EndRecording();
+                return;
+            }
+        }
+
+        for(int i = 0; i < numPlayers; i++)
+            Player[i+1].Controls = last_controls[i];
+    }
+    else if(replay_file)
     {
         while(next_record_frame == frame_no && replay_file)
         {
@@ -928,6 +1582,10 @@ void Sync()
 
     if(record_file)
     {
+        // keyframes are captured before the frame's controls change, so a seek resumes right at their frame
+        if(s_record_binary && frame_no > 0 && !(frame_no % c_keyframeInterval))
+            write_keyframe();
+
         write_control();
 
         if(!(frame_no % 60))
@@ -937,6 +1595,9 @@ void Sync()
             write_NPCs();
     }
 
+    ReplayTrace::Frame(frame_no);
+    StateHash::Frame();
+
     frame_no++;
 }
 
@@ -26,6 +26,8 @@
 #define RECORD_H
 
 #include <string>
+#include <cstdint>
+#include <cstdio>
 
 namespace Record
 {
@@ -34,6 +36,42 @@ namespace Record
 extern FILE* record_file;
 extern FILE* replay_file;
 
+//! headless replay (used by the batch runner): don't write a new recording, skip drawing, and don't compare render stats
+extern bool headless_replay;
+
+//! replay speed: 1 is real time, N > 1 runs N frames per real-time frame, and 0 runs as fast as possible
+extern int replay_speed;
+//! the replay speed was set explicitly (otherwise, replays run at the unlimited frame rate)
+extern bool replay_speed_set;
+//! while a replay is fast-forwarded, only draw every Nth frame (0 to never draw)
+extern int replay_render_interval;
+//! start a binary replay from its last keyframe at or before this frame (0 to replay from the start)
+extern int64_t replay_start_frame;
+//! directory that the CPU render writes replayed frames into as PNG files (empty to disable)
+extern std::string replay_frame_dump_dir;
+//! write every Nth replayed frame (such frames are always drawn, even during a fast-forward)
+extern int replay_frame_dump_interval;
+
+//! returns true if a replay is currently being fast-forwarded
+bool FastForwarding();
+//! returns true if the frame timer should skip its delay after the current frame
+bool FastForwardNoDelay();
+//! returns true if drawing the current frame should be skipped
+bool SkipDraw();
+//! returns the number of the replayed frame that should be dumped after drawing it, or -1
+int64_t FrameDumpNumber();
+
+enum class ReplayResult
+{
+    None = 0,
+    Pass,
+    Minor,
+    Diverged,
+};
+
+//! returns the outcome of the last finished replay, and (optionally) the number of frames it simulated
+ReplayResult GetReplayResult(int64_t* frames = nullptr);
+
 void LoadReplay(const std::string &recording_path, const std::string &level_path);
 
 void InitRecording();
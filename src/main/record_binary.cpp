@@ -0,0 +1,462 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "record_binary.h"
+
+namespace RecordBinary
+{
+
+static const char c_fileMagic[4] = {'X', 'T', 'R', 'B'};
+static const char c_indexMagic[4] = {'X', 'T', 'R', 'I'};
+
+static constexpr size_t c_footerSize = 16;
+
+//! maximum chunk payload before a new chunk is started early
+static constexpr size_t c_maxChunkSize = 65536;
+
+
+void Writer::uvar(uint64_t v)
+{
+    while(v >= 0x80)
+    {
+        buf.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+
+    buf.push_back((uint8_t)v);
+}
+
+void Writer::svar(int64_t v)
+{
+    // zigzag encoding keeps small negative values small
+    uvar(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+void Writer::f64(double v)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+
+    for(int i = 0; i < 8; i++)
+        buf.push_back((uint8_t)(bits >> (i * 8)));
+}
+
+void Writer::str(const std::string& v)
+{
+    uvar(v.size());
+    bytes(v.data(), v.size());
+}
+
+void Writer::bytes(const void* data, size_t size)
+{
+    const uint8_t* src = (const uint8_t*)data;
+    buf.insert(buf.end(), src, src + size);
+}
+
+
+uint8_t Reader::u8()
+{
+    if(p >= end)
+    {
+        ok = false;
+        return 0;
+    }
+
+    return *(p++);
+}
+
+uint64_t Reader::uvar()
+{
+    uint64_t ret = 0;
+
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        if(p >= end)
+        {
+            ok = false;
+            return 0;
+        }
+
+        uint8_t b = *(p++);
+        ret |= (uint64_t)(b & 0x7F) << shift;
+
+        if(!(b & 0x80))
+            return ret;
+    }
+
+    ok = false;
+    return ret;
+}
+
+int64_t Reader::svar()
+{
+    uint64_t v = uvar();
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+double Reader::f64()
+{
+    if(end - p < 8)
+    {
+        ok = false;
+        p = end;
+        return 0.0;
+    }
+
+    uint64_t bits = 0;
+    for(int i = 0; i < 8; i++)
+        bits |= (uint64_t)p[i] << (i * 8);
+
+    p += 8;
+
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+std::string Reader::str()
+{
+    uint64_t size = uvar();
+
+    if(!ok || (uint64_t)(end - p) < size)
+    {
+        ok = false;
+        p = end;
+        return std::string();
+    }
+
+    std::string ret((const char*)p, (size_t)size);
+    p += size;
+
+    return ret;
+}
+
+bool Reader::bytes(void* data, size_t size)
+{
+    if((size_t)(end - p) < size)
+    {
+        ok = false;
+        p = end;
+        return false;
+    }
+
+    std::memcpy(data, p, size);
+    p += size;
+
+    return true;
+}
+
+
+bool IsBinary(FILE* f)
+{
+    char magic[4];
+
+    ::rewind(f);
+    bool ret = (fread(magic, 1, 4, f) == 4 && std::memcmp(magic, c_fileMagic, 4) == 0);
+    ::rewind(f);
+
+    return ret;
+}
+
+
+void FileWriter::write_raw(const void* data, size_t size)
+{
+    if(m_file)
+        fwrite(data, 1, size, m_file);
+
+    m_offset += size;
+}
+
+void FileWriter::open(FILE* f, const Writer& header)
+{
+    m_file = f;
+    m_offset = 0;
+    m_chunk.buf.clear();
+    m_chunk_flags = 0;
+    m_chunk_first_frame = -1;
+    m_last_frame = 0;
+    m_index.clear();
+
+    Writer w;
+    w.bytes(c_fileMagic, 4);
+    w.u8(c_containerVersion);
+    w.uvar(header.buf.size());
+
+    write_raw(w.buf.data(), w.buf.size());
+    write_raw(header.buf.data(), header.buf.size());
+}
+
+bool FileWriter::starts_chunk(int64_t frame) const
+{
+    return m_chunk_first_frame < 0
+        || frame - m_chunk_first_frame >= c_chunkFrames
+        || m_chunk.buf.size() >= c_maxChunkSize;
+}
+
+Writer& FileWriter::event(int64_t frame, uint8_t type)
+{
+    if(starts_chunk(frame))
+    {
+        flush_chunk();
+        m_chunk_first_frame = frame;
+        m_last_frame = frame;
+    }
+
+    m_chunk.uvar((uint64_t)(frame - m_last_frame));
+    m_chunk.u8(type);
+    m_last_frame = frame;
+
+    return m_chunk;
+}
+
+Writer& FileWriter::keyframe(int64_t frame, uint8_t type)
+{
+    flush_chunk();
+    m_chunk_first_frame = frame;
+    m_last_frame = frame;
+    m_chunk_flags |= CHUNK_KEYFRAME;
+
+    return event(frame, type);
+}
+
+void FileWriter::flush_chunk()
+{
+    if(m_chunk_first_frame < 0)
+        return;
+
+    ChunkIndex_t entry;
+    entry.first_frame = m_chunk_first_frame;
+    entry.offset = m_offset;
+    entry.flags = m_chunk_flags;
+    m_index.push_back(entry);
+
+    Writer w;
+    w.uvar((uint64_t)m_chunk_first_frame);
+    w.u8(m_chunk_flags);
+    w.uvar(m_chunk.buf.size());
+
+    write_raw(w.buf.data(), w.buf.size());
+    write_raw(m_chunk.buf.data(), m_chunk.buf.size());
+
+    if(m_file)
+        fflush(m_file);
+
+    m_chunk.buf.clear();
+    m_chunk_flags = 0;
+    m_chunk_first_frame = -1;
+}
+
+void FileWriter::finish()
+{
+    flush_chunk();
+
+    uint64_t index_offset = m_offset;
+
+    Writer w;
+    for(const ChunkIndex_t& entry : m_index)
+    {
+        w.uvar((uint64_t)entry.first_frame);
+        w.uvar(entry.offset);
+        w.u8(entry.flags);
+    }
+
+    for(int i = 0; i < 8; i++)
+        w.u8((uint8_t)(index_offset >> (i * 8)));
+
+    uint32_t count = (uint32_t)m_index.size();
+    for(int i = 0; i < 4; i++)
+        w.u8((uint8_t)(count >> (i * 8)));
+
+    w.bytes(c_indexMagic, 4);
+
+    write_raw(w.buf.data(), w.buf.size());
+
+    if(m_file)
+        fflush(m_file);
+
+    m_file = nullptr;
+}
+
+
+bool FileReader::load(FILE* f)
+{
+    m_data.clear();
+    m_index.clear();
+    m_corrupt = false;
+
+    if(fseek(f, 0, SEEK_END) != 0)
+        return false;
+
+    long size = ftell(f);
+    ::rewind(f);
+
+    if(size < 5)
+        return false;
+
+    m_data.resize((size_t)size);
+    if(fread(m_data.data(), 1, m_data.size(), f) != m_data.size())
+        return false;
+
+    ::rewind(f);
+
+    Reader r(m_data.data(), m_data.data() + m_data.size());
+
+    char magic[4];
+    r.bytes(magic, 4);
+
+    if(std::memcmp(magic, c_fileMagic, 4) != 0 || r.u8() > c_containerVersion)
+        return false;
+
+    uint64_t header_size = r.uvar();
+    if(!r.ok || (uint64_t)(r.end - r.p) < header_size)
+        return false;
+
+    m_header = Reader(r.p, r.p + header_size);
+
+    load_index();
+    rewind();
+
+    return true;
+}
+
+void FileReader::load_index()
+{
+    const uint8_t* end = m_data.data() + m_data.size();
+
+    m_chunks_begin = m_header.end;
+    m_chunks_end = end;
+
+    // unfinished recording: no index, chunks extend to the end of the file
+    if((size_t)(end - m_chunks_begin) < c_footerSize || std::memcmp(end - 4, c_indexMagic, 4) != 0)
+        return;
+
+    const uint8_t* footer = end - c_footerSize;
+
+    uint64_t index_offset = 0;
+    for(int i = 0; i < 8; i++)
+        index_offset |= (uint64_t)footer[i] << (i * 8);
+
+    uint32_t count = 0;
+    for(int i = 0; i < 4; i++)
+        count |= (uint32_t)footer[8 + i] << (i * 8);
+
+    if(index_offset > (uint64_t)(footer - m_data.data()) || m_data.data() + index_offset < m_chunks_begin)
+        return;
+
+    m_chunks_end = m_data.data() + index_offset;
+
+    Reader r(m_chunks_end, footer);
+
+    m_index.reserve(count);
+
+    for(uint32_t i = 0; i < count && r.ok; i++)
+    {
+        ChunkIndex_t entry;
+        entry.first_frame = (int64_t)r.uvar();
+        entry.offset = r.uvar();
+        entry.flags = r.u8();
+
+        if(r.ok && entry.offset < index_offset && m_data.data() + entry.offset >= m_chunks_begin)
+            m_index.push_back(entry);
+    }
+}
+
+bool FileReader::open_chunk(const uint8_t* at)
+{
+    if(at >= m_chunks_end)
+        return false;
+
+    Reader r(at, m_chunks_end);
+    int64_t first_frame = (int64_t)r.uvar();
+    r.u8(); // flags
+    uint64_t size = r.uvar();
+
+    if(!r.ok || (uint64_t)(m_chunks_end - r.p) < size)
+    {
+        m_corrupt = true;
+        return false;
+    }
+
+    m_chunk = Reader(r.p, r.p + size);
+    m_chunk_frame = first_frame;
+
+    return true;
+}
+
+void FileReader::advance()
+{
+    while(m_chunk.at_end())
+    {
+        if(!open_chunk(m_chunk.end))
+        {
+            m_next_frame = -1;
+            m_next_type = 0;
+            return;
+        }
+    }
+
+    int64_t delta = (int64_t)m_chunk.uvar();
+    m_next_type = m_chunk.u8();
+
+    if(!m_chunk.ok)
+    {
+        m_corrupt = true;
+        m_next_frame = -1;
+        return;
+    }
+
+    m_chunk_frame += delta;
+    m_next_frame = m_chunk_frame;
+}
+
+void FileReader::rewind()
+{
+    m_corrupt = false;
+    m_chunk = Reader(m_chunks_begin, m_chunks_begin);
+    advance();
+}
+
+int64_t FileReader::seek_chunk(int64_t frame, bool keyframe_only)
+{
+    const ChunkIndex_t* found = nullptr;
+
+    for(const ChunkIndex_t& entry : m_index)
+    {
+        if(entry.first_frame > frame)
+            break;
+
+        if(!keyframe_only || (entry.flags & CHUNK_KEYFRAME))
+            found = &entry;
+    }
+
+    if(!found)
+        return -1;
+
+    const uint8_t* at = m_data.data() + found->offset;
+    m_corrupt = false;
+    m_chunk = Reader(at, at);
+    advance();
+
+    return found->first_frame;
+}
+
+} // namespace RecordBinary
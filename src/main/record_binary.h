@@ -0,0 +1,209 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module implements the container of the binary gameplay recording format
+//
+// File layout (all fixed-size integers are little-endian):
+//   "XTRB" magic, u8 container version, varint header size, header bytes
+//   chunks: varint first frame, u8 flags, varint payload size, payload
+//     payload is a sequence of events: varint frame delta, u8 type, type-specific data
+//   index: per chunk, varint first frame, varint file offset, u8 flags
+//   footer: u64 index offset, u32 chunk count, "XTRI" magic
+//
+// Chunks are self-delimited, so a file without the index (unfinished recording) can still be played.
+
+#pragma once
+#ifndef RECORD_BINARY_H
+#define RECORD_BINARY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace RecordBinary
+{
+
+static constexpr uint8_t c_containerVersion = 1;
+
+//! chunk contains a full-state keyframe as its first event
+static constexpr uint8_t CHUNK_KEYFRAME = 1;
+
+//! serializes values into a growable byte buffer
+struct Writer
+{
+    std::vector<uint8_t> buf;
+
+    inline void u8(uint8_t v)
+    {
+        buf.push_back(v);
+    }
+
+    void uvar(uint64_t v);
+    void svar(int64_t v);
+    void f64(double v);
+    void str(const std::string& v);
+    void bytes(const void* data, size_t size);
+};
+
+//! deserializes values from a byte range; sets ok to false on any overrun
+struct Reader
+{
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+    bool ok = true;
+
+    Reader() = default;
+    Reader(const uint8_t* begin, const uint8_t* end) : p(begin), end(end) {}
+
+    inline bool at_end() const
+    {
+        return p >= end;
+    }
+
+    uint8_t u8();
+    uint64_t uvar();
+    int64_t svar();
+    double f64();
+    std::string str();
+    bool bytes(void* data, size_t size);
+};
+
+struct ChunkIndex_t
+{
+    int64_t first_frame = 0;
+    uint64_t offset = 0;
+    uint8_t flags = 0;
+};
+
+//! checks whether an opened file starts with the binary recording magic (leaves the file position at the start)
+bool IsBinary(FILE* f);
+
+//! streams events into chunks of a binary recording file
+class FileWriter
+{
+    FILE* m_file = nullptr;
+    uint64_t m_offset = 0;
+
+    Writer m_chunk;
+    uint8_t m_chunk_flags = 0;
+    int64_t m_chunk_first_frame = -1;
+    int64_t m_last_frame = 0;
+
+    std::vector<ChunkIndex_t> m_index;
+
+    void write_raw(const void* data, size_t size);
+    void flush_chunk();
+
+public:
+    //! frames per chunk (about one minute of gameplay)
+    static constexpr int64_t c_chunkFrames = 3840;
+
+    void open(FILE* f, const Writer& header);
+
+    //! returns true if an event at this frame will start a new chunk
+    bool starts_chunk(int64_t frame) const;
+
+    //! begins an event, and returns the buffer that the event's data should be written to
+    Writer& event(int64_t frame, uint8_t type);
+
+    //! begins a keyframe event, always at the start of a new chunk (which gets marked as a keyframe chunk)
+    Writer& keyframe(int64_t frame, uint8_t type);
+
+    //! writes the remaining chunk, the index, and the footer
+    void finish();
+};
+
+//! holds a binary recording file in memory and walks through its events
+class FileReader
+{
+    std::vector<uint8_t> m_data;
+    std::vector<ChunkIndex_t> m_index;
+
+    Reader m_header;
+    const uint8_t* m_chunks_begin = nullptr;
+    const uint8_t* m_chunks_end = nullptr;
+
+    //! payload of the current chunk; its end is the start of the next chunk
+    Reader m_chunk;
+    int64_t m_chunk_frame = 0;
+
+    int64_t m_next_frame = -1;
+    uint8_t m_next_type = 0;
+
+    bool m_corrupt = false;
+
+    bool open_chunk(const uint8_t* at);
+    void load_index();
+    void advance();
+
+public:
+    //! loads a whole file (must already be checked with IsBinary)
+    bool load(FILE* f);
+
+    //! returns a reader positioned at the header data
+    Reader header() const
+    {
+        return m_header;
+    }
+
+    //! restarts reading from the first event
+    void rewind();
+
+    //! seeks to the start of the last chunk beginning at or before frame; returns its first frame or -1
+    int64_t seek_chunk(int64_t frame, bool keyframe_only = false);
+
+    //! frame of the next event, or -1 if there are no more events
+    int64_t next_frame() const
+    {
+        return m_next_frame;
+    }
+
+    uint8_t next_type() const
+    {
+        return m_next_type;
+    }
+
+    //! returns the reader for the current event's data and moves to the following event once it's been consumed
+    Reader& data()
+    {
+        return m_chunk;
+    }
+
+    //! call after the current event's data has been fully consumed
+    void next()
+    {
+        advance();
+    }
+
+    bool corrupt() const
+    {
+        return m_corrupt || !m_chunk.ok;
+    }
+
+    const std::vector<ChunkIndex_t>& index() const
+    {
+        return m_index;
+    }
+};
+
+} // namespace RecordBinary
+
+#endif // #ifndef RECORD_BINARY_H
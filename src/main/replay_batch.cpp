@@ -0,0 +1,357 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <DirManager/dirman.h>
+#include <Utils/files.h>
+
+#include "../cmd_line_setup.h"
+#include "record.h"
+#include "replay_batch.h"
+
+namespace ReplayBatch
+{
+
+struct JobResult_t
+{
+    std::string path;
+    Record::ReplayResult result = Record::ReplayResult::None;
+    int64_t frames = 0;
+    double wall_time = 0.0;
+};
+
+struct RunningJob_t
+{
+    pid_t pid = -1;
+    int read_fd = -1;
+    size_t index = 0;
+    std::chrono::steady_clock::time_point start;
+};
+
+//! pipe to the main process, only valid in a worker process
+static int s_worker_fd = -1;
+
+static const char* s_result_name(Record::ReplayResult result)
+{
+    switch(result)
+    {
+    case Record::ReplayResult::Pass:
+        return "pass";
+    case Record::ReplayResult::Minor:
+        return "minor";
+    case Record::ReplayResult::Diverged:
+        return "diverged";
+    default:
+        return "invalid";
+    }
+}
+
+static std::string s_json_escape(const std::string& in)
+{
+    std::string out;
+    out.reserve(in.size());
+
+    for(char c : in)
+    {
+        if(c == '"' || c == '\\')
+            out.push_back('\\');
+        else if((unsigned char)c < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", (unsigned)(unsigned char)c);
+            out += code;
+            continue;
+        }
+
+        out.push_back(c);
+    }
+
+    return out;
+}
+
+static std::string s_csv_escape(const std::string& in)
+{
+    std::string out;
+    out.reserve(in.size());
+
+    for(char c : in)
+    {
+        // quotes inside of a quoted CSV field are doubled
+        if(c == '"')
+            out.push_back('"');
+
+        out.push_back(c);
+    }
+
+    return out;
+}
+
+static void s_collect(RunningJob_t& job, int status, std::vector<JobResult_t>& results)
+{
+    JobResult_t& res = results[job.index];
+
+    res.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.start).count();
+
+    char buffer[64] = {0};
+    ssize_t got = read(job.read_fd, buffer, sizeof(buffer) - 1);
+    close(job.read_fd);
+    job.read_fd = -1;
+
+    int result_code = 0;
+    long long frames = 0;
+
+    // a worker that crashed, quit before the end of its replay, or reported an unknown result is counted as invalid
+    if(got > 0 && WIFEXITED(status) && sscanf(buffer, "%d %lld", &result_code, &frames) == 2
+        && result_code >= (int)Record::ReplayResult::None && result_code <= (int)Record::ReplayResult::Diverged)
+    {
+        res.result = (Record::ReplayResult)result_code;
+        res.frames = (int64_t)frames;
+    }
+
+    printf("[%s] %s (%" PRId64 " frames, %.2fs)\n", s_result_name(res.result), res.path.c_str(), res.frames, res.wall_time);
+    fflush(stdout);
+}
+
+static void s_write_summary(FILE* out, bool json, const std::vector<JobResult_t>& results)
+{
+    if(json)
+    {
+        fprintf(out, "[\n");
+
+        for(size_t i = 0; i < results.size(); i++)
+        {
+            const JobResult_t& res = results[i];
+            fprintf(out, "  {\"replay\": \"%s\", \"status\": \"%s\", \"frames\": %" PRId64 ", \"wall_time\": %.3f}%s\n",
+                    s_json_escape(res.path).c_str(), s_result_name(res.result), res.frames, res.wall_time,
+                    (i + 1 < results.size()) ? "," : "");
+        }
+
+        fprintf(out, "]\n");
+    }
+    else
+    {
+        fprintf(out, "replay,status,frames,wall_time\n");
+
+        for(const JobResult_t& res : results)
+            fprintf(out, "\"%s\",%s,%" PRId64 ",%.3f\n", s_csv_escape(res.path).c_str(), s_result_name(res.result), res.frames, res.wall_time);
+    }
+}
+
+bool Run(CmdLineSetup_t& setup, int& exit_code)
+{
+    exit_code = 0;
+
+    std::string dir = setup.replayBatchDir;
+    if(!dir.empty() && dir.back() != '/')
+        dir.push_back('/');
+
+    std::vector<std::string> files;
+    DirMan(dir).getListOfFiles(files, {".rec"});
+    std::sort(files.begin(), files.end());
+
+    if(files.empty())
+    {
+        fprintf(stderr, "Error: no replays (*.rec) found at %s\n", dir.c_str());
+        exit_code = 2;
+        return true;
+    }
+
+    int jobs = setup.replayBatchJobs;
+    if(jobs <= 0)
+        jobs = (int)std::thread::hardware_concurrency();
+    if(jobs <= 0)
+        jobs = 1;
+
+    std::vector<JobResult_t> results(files.size());
+    std::vector<RunningJob_t> running;
+
+    auto batch_start = std::chrono::steady_clock::now();
+
+    size_t next = 0;
+
+    while(next < files.size() || !running.empty())
+    {
+        // spawn as many workers as allowed
+        while(next < files.size() && (int)running.size() < jobs)
+        {
+            results[next].path = dir + files[next];
+
+            int fds[2];
+            if(pipe(fds) != 0)
+            {
+                perror("pipe");
+                exit_code = 2;
+                return true;
+            }
+
+            fflush(stdout);
+            fflush(stderr);
+
+            pid_t pid = fork();
+
+            if(pid < 0)
+            {
+                perror("fork");
+                close(fds[0]);
+                close(fds[1]);
+                exit_code = 2;
+                return true;
+            }
+            else if(pid == 0)
+            {
+                // worker: don't hold on to the other workers' pipes
+                for(const RunningJob_t& job : running)
+                    close(job.read_fd);
+
+                close(fds[0]);
+                s_worker_fd = fds[1];
+
+                setup.testReplay = results[next].path;
+                setup.testLevel.clear();
+                setup.replayBatchDir.clear();
+                Record::headless_replay = true;
+                Record::replay_speed = 0;
+                Record::replay_render_interval = 0;
+
+                return false;
+            }
+
+            close(fds[1]);
+
+            RunningJob_t job;
+            job.pid = pid;
+            job.read_fd = fds[0];
+            job.index = next;
+            job.start = std::chrono::steady_clock::now();
+            running.push_back(job);
+
+            next++;
+        }
+
+        int status = 0;
+        pid_t done = waitpid(-1, &status, 0);
+
+        if(done < 0 && errno == EINTR)
+            continue;
+
+        if(done < 0)
+        {
+            perror("waitpid");
+
+            // stop and reap the remaining workers, and report them (and the replays that never started) as invalid
+            for(RunningJob_t& job : running)
+            {
+                kill(job.pid, SIGKILL);
+
+                status = 0;
+                while(waitpid(job.pid, &status, 0) < 0 && errno == EINTR)
+                    ;
+
+                s_collect(job, status, results);
+            }
+
+            running.clear();
+
+            for(; next < files.size(); next++)
+                results[next].path = dir + files[next];
+
+            break;
+        }
+
+        for(auto it = running.begin(); it != running.end(); ++it)
+        {
+            if(it->pid == done)
+            {
+                s_collect(*it, status, results);
+                running.erase(it);
+                break;
+            }
+        }
+    }
+
+    double batch_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count();
+
+    int counts[4] = {0, 0, 0, 0};
+    for(const JobResult_t& res : results)
+        counts[(int)res.result]++;
+
+    printf("Ran %d replays with %d jobs in %.2fs: %d pass, %d minor, %d diverged, %d invalid\n",
+           (int)results.size(), jobs, batch_time,
+           counts[(int)Record::ReplayResult::Pass], counts[(int)Record::ReplayResult::Minor],
+           counts[(int)Record::ReplayResult::Diverged], counts[(int)Record::ReplayResult::None]);
+
+    const std::string& output = setup.replayBatchOutput;
+    bool json = Files::hasSuffix(output, ".json");
+
+    if(output.empty())
+        s_write_summary(stdout, false, results);
+    else
+    {
+        FILE* out = Files::utf8_fopen(output.c_str(), "wb");
+
+        if(!out)
+        {
+            fprintf(stderr, "Error: can't open %s for writing\n", output.c_str());
+            exit_code = 2;
+            return true;
+        }
+
+        s_write_summary(out, json, results);
+        fclose(out);
+    }
+
+    if(counts[(int)Record::ReplayResult::Diverged] || counts[(int)Record::ReplayResult::None])
+        exit_code = 1;
+
+    return true;
+}
+
+void FinishWorker()
+{
+    if(s_worker_fd < 0)
+        return;
+
+    int64_t frames = 0;
+    Record::ReplayResult result = Record::GetReplayResult(&frames);
+
+    char buffer[64];
+    int len = snprintf(buffer, sizeof(buffer), "%d %lld\n", (int)result, (long long)frames);
+
+    if(write(s_worker_fd, buffer, len) != len)
+        perror("write");
+
+    close(s_worker_fd);
+    s_worker_fd = -1;
+}
+
+} // namespace ReplayBatch
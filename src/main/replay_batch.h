@@ -0,0 +1,46 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module runs a directory of gameplay recordings in parallel worker processes
+// and writes a single summary of their results
+
+#pragma once
+#ifndef REPLAY_BATCH_H
+#define REPLAY_BATCH_H
+
+struct CmdLineSetup_t;
+
+namespace ReplayBatch
+{
+
+/**
+ * \brief Runs the replay batch described by setup.replayBatchDir
+ * \param setup Command line setup. In a worker process, setup.testReplay is set to the replay to run.
+ * \param exit_code Exit code for the main process once the batch is complete
+ * \return true in the main process (which should exit with exit_code), false in a worker process (which should run the replay normally)
+ */
+bool Run(CmdLineSetup_t& setup, int& exit_code);
+
+//! Called by a worker process once its replay has finished, to report the result to the main process
+void FinishWorker();
+
+} // namespace ReplayBatch
+
+#endif // #ifndef REPLAY_BATCH_H
@@ -0,0 +1,666 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <Logger/logger.h>
+#include <Utils/files.h>
+
+#include "../globals.h"
+#include "../layers.h"
+#include "../rand.h"
+#include "record_binary.h"
+#include "replay_trace.h"
+
+namespace ReplayTrace
+{
+
+using RecordBinary::Writer;
+using RecordBinary::Reader;
+
+std::string output_path;
+std::string reference_path;
+
+static const char c_traceMagic[4] = {'X', 'T', 'R', 'T'};
+static constexpr uint8_t c_traceVersion = 1;
+
+//! maximum number of differing fields listed when the first divergence is found
+static constexpr int c_maxReportedFields = 16;
+
+struct Field_t
+{
+    const char* name;
+    double (*get)(int i);
+};
+
+struct Category_t
+{
+    const char* name;
+    int first;
+    int (*last)();
+    const Field_t* fields;
+    int num_fields;
+};
+
+#define GLOBAL_FIELD(name, expr) {name, [](int) -> double { return (double)(expr); }}
+#define PLAYER_FIELD(f) {#f, [](int i) -> double { return (double)Player[i].f; }}
+#define NPC_FIELD(f) {#f, [](int i) -> double { return (double)NPC[i].f; }}
+#define BLOCK_FIELD(f) {#f, [](int i) -> double { return (double)Block[i].f; }}
+
+static const Field_t c_globalFields[] =
+{
+    GLOBAL_FIELD("randCalls", random_ncalls()),
+    GLOBAL_FIELD("Score", Score),
+    GLOBAL_FIELD("Coins", Coins),
+    GLOBAL_FIELD("Lives", Lives),
+    GLOBAL_FIELD("numStars", numStars),
+    GLOBAL_FIELD("numEffects", numEffects),
+    GLOBAL_FIELD("PSwitchTime", PSwitchTime),
+    GLOBAL_FIELD("PSwitchStop", PSwitchStop),
+    GLOBAL_FIELD("FreezeNPCs", FreezeNPCs),
+    GLOBAL_FIELD("LevelMacro", LevelMacro),
+    GLOBAL_FIELD("LevelMacroCounter", LevelMacroCounter),
+    GLOBAL_FIELD("newEventNum", newEventNum),
+};
+
+static const Field_t c_playerFields[] =
+{
+    PLAYER_FIELD(Location.X),
+    PLAYER_FIELD(Location.Y),
+    PLAYER_FIELD(Location.Width),
+    PLAYER_FIELD(Location.Height),
+    PLAYER_FIELD(Location.SpeedX),
+    PLAYER_FIELD(Location.SpeedY),
+    PLAYER_FIELD(Character),
+    PLAYER_FIELD(State),
+    PLAYER_FIELD(Mount),
+    PLAYER_FIELD(MountType),
+    PLAYER_FIELD(Direction),
+    PLAYER_FIELD(Effect),
+    PLAYER_FIELD(Effect2),
+    PLAYER_FIELD(Dead),
+    PLAYER_FIELD(TimeToLive),
+    PLAYER_FIELD(Immune),
+    PLAYER_FIELD(Section),
+    PLAYER_FIELD(HoldingNPC),
+    PLAYER_FIELD(StandingOnNPC),
+    PLAYER_FIELD(Slope),
+    PLAYER_FIELD(Jump),
+    PLAYER_FIELD(Duck),
+    PLAYER_FIELD(SpinJump),
+    PLAYER_FIELD(Slide),
+    PLAYER_FIELD(Vine),
+    PLAYER_FIELD(Wet),
+    PLAYER_FIELD(Quicksand),
+    PLAYER_FIELD(Stoned),
+    PLAYER_FIELD(WarpCD),
+    PLAYER_FIELD(Warp),
+    PLAYER_FIELD(FireBallCD),
+    PLAYER_FIELD(TailCount),
+    PLAYER_FIELD(RunCount),
+    PLAYER_FIELD(FlyCount),
+    PLAYER_FIELD(CanFly),
+    PLAYER_FIELD(CanFly2),
+    PLAYER_FIELD(GrabTime),
+    PLAYER_FIELD(Hearts),
+    PLAYER_FIELD(Multiplier),
+    PLAYER_FIELD(YoshiNPC),
+    PLAYER_FIELD(YoshiPlayer),
+    PLAYER_FIELD(Frame),
+    PLAYER_FIELD(FrameCount),
+};
+
+static const Field_t c_NPCFields[] =
+{
+    NPC_FIELD(Type),
+    NPC_FIELD(Killed),
+    NPC_FIELD(Active),
+    NPC_FIELD(Hidden),
+    NPC_FIELD(Location.X),
+    NPC_FIELD(Location.Y),
+    NPC_FIELD(Location.Width),
+    NPC_FIELD(Location.Height),
+    NPC_FIELD(Location.SpeedX),
+    NPC_FIELD(Location.SpeedY),
+    NPC_FIELD(Direction),
+    NPC_FIELD(Special),
+    NPC_FIELD(Special2),
+    NPC_FIELD(Special3),
+    NPC_FIELD(Special4),
+    NPC_FIELD(Special5),
+    NPC_FIELD(SpecialX),
+    NPC_FIELD(SpecialY),
+    NPC_FIELD(Effect),
+    NPC_FIELD(Effect2),
+    NPC_FIELD(Effect3),
+    NPC_FIELD(Section),
+    NPC_FIELD(TimeLeft),
+    NPC_FIELD(Projectile),
+    NPC_FIELD(HoldingPlayer),
+    NPC_FIELD(Generator),
+    NPC_FIELD(GeneratorTime),
+    NPC_FIELD(RealSpeedX),
+    NPC_FIELD(BeltSpeed),
+    NPC_FIELD(CantHurt),
+    NPC_FIELD(CantHurtPlayer),
+    NPC_FIELD(Immune),
+    NPC_FIELD(Damage),
+    NPC_FIELD(Multiplier),
+    NPC_FIELD(Slope),
+    NPC_FIELD(Stuck),
+    NPC_FIELD(Inert),
+    NPC_FIELD(Wet),
+    NPC_FIELD(Quicksand),
+    NPC_FIELD(TurnAround),
+    NPC_FIELD(RespawnDelay),
+    NPC_FIELD(Layer),
+    NPC_FIELD(Frame),
+    NPC_FIELD(FrameCount),
+};
+
+static const Field_t c_blockFields[] =
+{
+    BLOCK_FIELD(Type),
+    BLOCK_FIELD(Location.X),
+    BLOCK_FIELD(Location.Y),
+    BLOCK_FIELD(Location.Width),
+    BLOCK_FIELD(Location.Height),
+    BLOCK_FIELD(Location.SpeedX),
+    BLOCK_FIELD(Location.SpeedY),
+    BLOCK_FIELD(Special),
+    BLOCK_FIELD(Hidden),
+    BLOCK_FIELD(Invis),
+    BLOCK_FIELD(Kill),
+    BLOCK_FIELD(Layer),
+    BLOCK_FIELD(RapidHit),
+    BLOCK_FIELD(ShakeCounter),
+    BLOCK_FIELD(ShakeOffset),
+    BLOCK_FIELD(RespawnDelay),
+};
+
+#undef GLOBAL_FIELD
+#undef PLAYER_FIELD
+#undef NPC_FIELD
+#undef BLOCK_FIELD
+
+#define FIELD_COUNT(arr) (int)(sizeof(arr) / sizeof(arr[0]))
+
+static const Category_t c_categories[] =
+{
+    {"Global", 0, []() -> int { return 0; }, c_globalFields, FIELD_COUNT(c_globalFields)},
+    {"Player", 1, []() -> int { return numPlayers; }, c_playerFields, FIELD_COUNT(c_playerFields)},
+    {"NPC", 1, []() -> int { return numNPCs; }, c_NPCFields, FIELD_COUNT(c_NPCFields)},
+    {"Block", 1, []() -> int { return numBlock; }, c_blockFields, FIELD_COUNT(c_blockFields)},
+};
+
+#undef FIELD_COUNT
+
+static constexpr int c_numCategories = (int)(sizeof(c_categories) / sizeof(c_categories[0]));
+
+//! last known field values of one category's objects
+struct Mirror_t
+{
+    int count = 0;
+    std::vector<double> values;
+    //! objects changed during the current frame
+    std::vector<int> touched;
+
+    void resize(int new_count, int num_fields)
+    {
+        count = new_count;
+        // new objects must always count as changed
+        values.resize((size_t)new_count * num_fields, std::numeric_limits<double>::quiet_NaN());
+    }
+};
+
+static inline bool s_same(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static FILE* s_out = nullptr;
+static FILE* s_ref = nullptr;
+
+static Mirror_t s_live[c_numCategories];
+static Mirror_t s_ref_mirror[c_numCategories];
+
+//! local category and field index of each of the reference trace's categories and fields (-1 if unknown)
+static std::vector<int> s_ref_category;
+static std::vector<std::vector<int>> s_ref_field;
+
+static int64_t s_ref_next_frame = -1;
+static std::vector<uint8_t> s_ref_payload;
+
+static int64_t s_first_divergence = -1;
+static int64_t s_frames_compared = 0;
+
+static Writer s_frame_buf;
+static Writer s_change_buf;
+
+
+static bool s_read_uvar(FILE* f, uint64_t& out)
+{
+    out = 0;
+
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+        int c = fgetc(f);
+        if(c == EOF)
+            return false;
+
+        out |= (uint64_t)(c & 0x7F) << shift;
+
+        if(!(c & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+static void s_write_header(FILE* f)
+{
+    Writer w;
+    w.bytes(c_traceMagic, 4);
+    w.u8(c_traceVersion);
+    w.uvar(c_numCategories);
+
+    for(const Category_t& cat : c_categories)
+    {
+        w.str(cat.name);
+        w.uvar((uint64_t)cat.num_fields);
+
+        for(int j = 0; j < cat.num_fields; j++)
+            w.str(cat.fields[j].name);
+    }
+
+    fwrite(w.buf.data(), 1, w.buf.size(), f);
+}
+
+static bool s_read_str(FILE* f, std::string& out)
+{
+    uint64_t size;
+    if(!s_read_uvar(f, size) || size > 256)
+        return false;
+
+    out.resize((size_t)size);
+    return size == 0 || fread(&out[0], 1, (size_t)size, f) == size;
+}
+
+static bool s_read_header(FILE* f)
+{
+    char magic[4];
+    if(fread(magic, 1, 4, f) != 4 || std::memcmp(magic, c_traceMagic, 4) != 0 || fgetc(f) != c_traceVersion)
+        return false;
+
+    uint64_t num_categories;
+    if(!s_read_uvar(f, num_categories) || num_categories > 64)
+        return false;
+
+    s_ref_category.assign((size_t)num_categories, -1);
+    s_ref_field.assign((size_t)num_categories, std::vector<int>());
+
+    for(size_t c = 0; c < num_categories; c++)
+    {
+        std::string name;
+        uint64_t num_fields;
+        if(!s_read_str(f, name) || !s_read_uvar(f, num_fields) || num_fields > 1024)
+            return false;
+
+        int local_cat = -1;
+        for(int i = 0; i < c_numCategories; i++)
+        {
+            if(name == c_categories[i].name)
+                local_cat = i;
+        }
+
+        s_ref_category[c] = local_cat;
+        s_ref_field[c].assign((size_t)num_fields, -1);
+
+        for(size_t j = 0; j < num_fields; j++)
+        {
+            if(!s_read_str(f, name))
+                return false;
+
+            if(local_cat < 0)
+                continue;
+
+            const Category_t& cat = c_categories[local_cat];
+            for(int k = 0; k < cat.num_fields; k++)
+            {
+                if(name == cat.fields[k].name)
+                    s_ref_field[c][j] = k;
+            }
+        }
+    }
+
+    return true;
+}
+
+//! reads the header of the next frame of the reference trace
+static void s_ref_read_next()
+{
+    uint64_t frame, size;
+
+    if(!s_ref || !s_read_uvar(s_ref, frame) || !s_read_uvar(s_ref, size))
+    {
+        s_ref_next_frame = -1;
+        return;
+    }
+
+    s_ref_payload.resize((size_t)size);
+
+    if(size && fread(s_ref_payload.data(), 1, (size_t)size, s_ref) != size)
+    {
+        s_ref_next_frame = -1;
+        return;
+    }
+
+    s_ref_next_frame = (int64_t)frame;
+}
+
+//! applies the current reference frame to the reference mirror
+static bool s_ref_apply()
+{
+    Reader r(s_ref_payload.data(), s_ref_payload.data() + s_ref_payload.size());
+
+    for(size_t c = 0; c < s_ref_category.size(); c++)
+    {
+        int local_cat = s_ref_category[c];
+        uint64_t count = r.uvar();
+        uint64_t num_changes = r.uvar();
+
+        Mirror_t* m = (local_cat >= 0) ? &s_ref_mirror[local_cat] : nullptr;
+        int num_fields = (local_cat >= 0) ? c_categories[local_cat].num_fields : 0;
+
+        if(m && (int)count != m->count)
+            m->resize((int)count, num_fields);
+
+        for(uint64_t i = 0; i < num_changes && r.ok; i++)
+        {
+            uint64_t obj = r.uvar();
+            uint64_t field = r.uvar();
+            double value = r.f64();
+
+            if(!m || field >= s_ref_field[c].size() || s_ref_field[c][(size_t)field] < 0 || obj >= count)
+                continue;
+
+            m->values[(size_t)obj * num_fields + s_ref_field[c][(size_t)field]] = value;
+            m->touched.push_back((int)obj);
+        }
+    }
+
+    return r.ok;
+}
+
+//! updates the live mirror from the game state, and (optionally) encodes the changes
+static void s_live_update(Writer* out)
+{
+    for(int c = 0; c < c_numCategories; c++)
+    {
+        const Category_t& cat = c_categories[c];
+        Mirror_t& m = s_live[c];
+
+        int count = cat.last() - cat.first + 1;
+        if(count < 0)
+            count = 0;
+
+        if(count != m.count)
+            m.resize(count, cat.num_fields);
+
+        s_change_buf.buf.clear();
+        uint64_t num_changes = 0;
+
+        for(int i = 0; i < count; i++)
+        {
+            double* values = &m.values[(size_t)i * cat.num_fields];
+            bool touched = false;
+
+            for(int j = 0; j < cat.num_fields; j++)
+            {
+                double v = cat.fields[j].get(cat.first + i);
+
+                if(s_same(v, values[j]))
+                    continue;
+
+                values[j] = v;
+                touched = true;
+                num_changes++;
+
+                if(out)
+                {
+                    s_change_buf.uvar((uint64_t)i);
+                    s_change_buf.uvar((uint64_t)j);
+                    s_change_buf.f64(v);
+                }
+            }
+
+            if(touched)
+                m.touched.push_back(i);
+        }
+
+        if(out)
+        {
+            out->uvar((uint64_t)count);
+            out->uvar(num_changes);
+            out->bytes(s_change_buf.buf.data(), s_change_buf.buf.size());
+        }
+    }
+}
+
+static void s_report(const char* text)
+{
+    pLogWarning("Replay trace: %s", text);
+    printf("Replay trace: %s\n", text);
+}
+
+//! compares the objects changed on either side during this frame; returns true if there were no differences
+static bool s_compare(int64_t frame)
+{
+    int reported = 0;
+    char line[512];
+
+    for(int c = 0; c < c_numCategories; c++)
+    {
+        const Category_t& cat = c_categories[c];
+        Mirror_t& live = s_live[c];
+        Mirror_t& ref = s_ref_mirror[c];
+
+        if(live.count != ref.count && reported < c_maxReportedFields)
+        {
+            snprintf(line, sizeof(line), "frame %" PRId64 ": %s count differs (reference %d, current %d)", frame, cat.name, ref.count, live.count);
+            s_report(line);
+            reported++;
+        }
+
+        std::vector<int>& touched = live.touched;
+        touched.insert(touched.end(), ref.touched.begin(), ref.touched.end());
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+        for(int i : touched)
+        {
+            if(i >= live.count || i >= ref.count)
+                continue;
+
+            const double* lv = &live.values[(size_t)i * cat.num_fields];
+            const double* rv = &ref.values[(size_t)i * cat.num_fields];
+
+            for(int j = 0; j < cat.num_fields; j++)
+            {
+                // fields that the reference build didn't trace are still NaN
+                if(std::isnan(rv[j]) || s_same(lv[j], rv[j]))
+                    continue;
+
+                if(reported < c_maxReportedFields)
+                {
+                    snprintf(line, sizeof(line), "frame %" PRId64 ": %s[%d].%s differs (reference %.10g, current %.10g)",
+                             frame, cat.name, cat.first + i, cat.fields[j].name, rv[j], lv[j]);
+                    s_report(line);
+                }
+
+                reported++;
+            }
+        }
+
+        live.touched.clear();
+        ref.touched.clear();
+    }
+
+    return reported == 0;
+}
+
+void Start()
+{
+    Stop();
+
+    for(int c = 0; c < c_numCategories; c++)
+    {
+        s_live[c] = Mirror_t();
+        s_ref_mirror[c] = Mirror_t();
+    }
+
+    s_first_divergence = -1;
+    s_frames_compared = 0;
+
+    if(!output_path.empty())
+    {
+        s_out = Files::utf8_fopen(output_path.c_str(), "wb");
+
+        if(s_out)
+            s_write_header(s_out);
+        else
+            pLogWarning("Replay trace: can't open %s for writing", output_path.c_str());
+    }
+
+    if(!reference_path.empty())
+    {
+        s_ref = Files::utf8_fopen(reference_path.c_str(), "rb");
+
+        if(s_ref && !s_read_header(s_ref))
+        {
+            pLogWarning("Replay trace: %s is not a valid trace file", reference_path.c_str());
+            fclose(s_ref);
+            s_ref = nullptr;
+        }
+        else if(!s_ref)
+            pLogWarning("Replay trace: can't open %s", reference_path.c_str());
+
+        s_ref_read_next();
+    }
+}
+
+void Frame(int64_t frame)
+{
+    if(!s_out && !s_ref)
+        return;
+
+    s_frame_buf.buf.clear();
+    s_live_update(s_out ? &s_frame_buf : nullptr);
+
+    if(s_out)
+    {
+        Writer w;
+        w.uvar((uint64_t)frame);
+        w.uvar(s_frame_buf.buf.size());
+        fwrite(w.buf.data(), 1, w.buf.size(), s_out);
+        fwrite(s_frame_buf.buf.data(), 1, s_frame_buf.buf.size(), s_out);
+    }
+
+    if(!s_ref)
+    {
+        for(Mirror_t& m : s_live)
+            m.touched.clear();
+
+        return;
+    }
+
+    // skip frames that weren't traced by this run (including the ones before the keyframe that a replay was started from)
+    while(s_ref_next_frame >= 0 && s_ref_next_frame < frame)
+    {
+        s_ref_apply();
+        s_ref_read_next();
+    }
+
+    if(s_ref_next_frame == frame)
+    {
+        if(!s_ref_apply())
+            pLogWarning("Replay trace: reference trace is corrupt at frame %" PRId64, frame);
+
+        s_ref_read_next();
+    }
+
+    s_frames_compared++;
+
+    if(!s_compare(frame))
+    {
+        // later differences are consequences of the first one
+        s_first_divergence = frame;
+        fclose(s_ref);
+        s_ref = nullptr;
+    }
+    else if(s_ref_next_frame < 0)
+    {
+        fclose(s_ref);
+        s_ref = nullptr;
+    }
+}
+
+void Stop()
+{
+    if(s_out)
+    {
+        fclose(s_out);
+        s_out = nullptr;
+    }
+
+    bool comparing = s_ref || s_frames_compared > 0;
+
+    if(s_ref)
+    {
+        fclose(s_ref);
+        s_ref = nullptr;
+    }
+
+    if(comparing && s_first_divergence < 0)
+    {
+        pLogDebug("Replay trace: no divergence from the reference trace in %" PRId64 " frames", s_frames_compared);
+        printf("Replay trace: no divergence from the reference trace in %" PRId64 " frames\n", s_frames_compared);
+    }
+    else if(comparing)
+    {
+        pLogWarning("Replay trace: first divergence from the reference trace at frame %" PRId64, s_first_divergence);
+        printf("Replay trace: first divergence from the reference trace at frame %" PRId64 "\n", s_first_divergence);
+    }
+
+    s_frames_compared = 0;
+}
+
+int64_t FirstDivergence()
+{
+    return s_first_divergence;
+}
+
+} // namespace ReplayTrace
@@ -0,0 +1,57 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module writes a field-level trace of the gameplay state during a recording or replay,
+// and compares a replay against the trace of a reference run to find the first divergence
+//
+// The trace stores, for every frame, the fields of players, NPCs, blocks, and some globals that
+// changed since the previous frame. Fields are identified by name, so traces of different builds
+// can be compared even if fields have been added or removed.
+
+#pragma once
+#ifndef REPLAY_TRACE_H
+#define REPLAY_TRACE_H
+
+#include <cstdint>
+#include <string>
+
+namespace ReplayTrace
+{
+
+//! trace file to write during the next recording or replay (empty to disable)
+extern std::string output_path;
+//! trace of a reference run to compare the next replay against (empty to disable)
+extern std::string reference_path;
+
+//! opens the trace files (called when a recording or replay starts)
+void Start();
+
+//! records / compares the state at the start of a frame (called from Record::Sync)
+void Frame(int64_t frame);
+
+//! closes the trace files and reports the result of the comparison
+void Stop();
+
+//! frame of the first divergence found in the comparison, or -1
+int64_t FirstDivergence();
+
+} // namespace ReplayTrace
+
+#endif // #ifndef REPLAY_TRACE_H
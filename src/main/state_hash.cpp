@@ -0,0 +1,283 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include <Logger/logger.h>
+#include <Utils/files.h>
+
+#include "../globals.h"
+#include "../config.h"
+#include "../rand.h"
+#include "../npc/npc_queues.h"
+#include "record_binary.h"
+#include "state_hash.h"
+
+namespace StateHash
+{
+
+std::string output_path;
+
+static const char c_hashMagic[4] = {'X', 'T', 'S', 'H'};
+static constexpr uint8_t c_hashVersion = 1;
+
+static FILE* s_out = nullptr;
+
+//! serialized state, reused between frames (values are little-endian, so hashes match across platforms)
+static RecordBinary::Writer s_state;
+
+
+// XXH64 (the state is serialized first, so only the one-shot variant is needed)
+
+static constexpr uint64_t c_prime1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t c_prime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t c_prime3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t c_prime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t c_prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t s_rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t s_read64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for(int i = 0; i < 8; i++)
+        v |= (uint64_t)p[i] << (i * 8);
+    return v;
+}
+
+static inline uint32_t s_read32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t s_round(uint64_t acc, uint64_t input)
+{
+    acc += input * c_prime2;
+    acc = s_rotl(acc, 31);
+    return acc * c_prime1;
+}
+
+static inline uint64_t s_merge_round(uint64_t acc, uint64_t val)
+{
+    acc ^= s_round(0, val);
+    return acc * c_prime1 + c_prime4;
+}
+
+static uint64_t s_xxh64(const uint8_t* p, size_t len, uint64_t seed)
+{
+    const uint8_t* end = p + len;
+    uint64_t h;
+
+    if(len >= 32)
+    {
+        uint64_t v1 = seed + c_prime1 + c_prime2;
+        uint64_t v2 = seed + c_prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - c_prime1;
+
+        do
+        {
+            v1 = s_round(v1, s_read64(p));
+            v2 = s_round(v2, s_read64(p + 8));
+            v3 = s_round(v3, s_read64(p + 16));
+            v4 = s_round(v4, s_read64(p + 24));
+            p += 32;
+        } while(end - p >= 32);
+
+        h = s_rotl(v1, 1) + s_rotl(v2, 7) + s_rotl(v3, 12) + s_rotl(v4, 18);
+        h = s_merge_round(h, v1);
+        h = s_merge_round(h, v2);
+        h = s_merge_round(h, v3);
+        h = s_merge_round(h, v4);
+    }
+    else
+        h = seed + c_prime5;
+
+    h += (uint64_t)len;
+
+    while(end - p >= 8)
+    {
+        h ^= s_round(0, s_read64(p));
+        h = s_rotl(h, 27) * c_prime1 + c_prime4;
+        p += 8;
+    }
+
+    if(end - p >= 4)
+    {
+        h ^= (uint64_t)s_read32(p) * c_prime1;
+        h = s_rotl(h, 23) * c_prime2 + c_prime3;
+        p += 4;
+    }
+
+    while(p < end)
+    {
+        h ^= (*p) * c_prime5;
+        h = s_rotl(h, 11) * c_prime1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= c_prime2;
+    h ^= h >> 29;
+    h *= c_prime3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+// every field goes through s_value, so that the field's type picks how it's written: integers as varints,
+//   and floating-point values by their bit pattern (a cast to an integer would hide fractions and the sign of zero)
+template<class T>
+static inline void s_value(RecordBinary::Writer& w, T v)
+{
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "hash floating-point fields through the double overload");
+    w.svar((int64_t)v);
+}
+
+static inline void s_value(RecordBinary::Writer& w, double v)
+{
+    w.f64(v);
+}
+
+static inline void s_value(RecordBinary::Writer& w, float v)
+{
+    w.f64(v);
+}
+
+static void s_location(RecordBinary::Writer& w, const Location_t& loc)
+{
+    s_value(w, loc.X);
+    s_value(w, loc.Y);
+    s_value(w, loc.Width);
+    s_value(w, loc.Height);
+    s_value(w, loc.SpeedX);
+    s_value(w, loc.SpeedY);
+}
+
+uint64_t Compute()
+{
+    RecordBinary::Writer& w = s_state;
+    w.buf.clear();
+
+    s_value(w, random_ncalls());
+    s_value(w, numPlayers);
+    s_value(w, numNPCs);
+    s_value(w, numBlock);
+
+    for(int i = 1; i <= numPlayers; i++)
+    {
+        const Player_t& p = Player[i];
+
+        s_location(w, p.Location);
+        s_value(w, p.State);
+        s_value(w, p.Mount);
+        s_value(w, p.Effect);
+        s_value(w, p.Dead);
+        s_value(w, p.Section);
+        s_value(w, p.HoldingNPC);
+        s_value(w, p.StandingOnNPC);
+    }
+
+    for(int i : NPCQueues::Active.no_change)
+    {
+        const NPC_t& n = NPC[i];
+
+        if(!n.Active)
+            continue;
+
+        s_value(w, i);
+        s_value(w, n.Type);
+        s_location(w, n.Location);
+        s_value(w, n.Killed);
+        s_value(w, n.Direction);
+        s_value(w, n.Special);
+        s_value(w, n.Special2);
+        s_value(w, n.SpecialX);
+        s_value(w, n.SpecialY);
+        s_value(w, n.Effect);
+        s_value(w, n.HoldingPlayer);
+    }
+
+    for(int i = 1; i <= numBlock; i++)
+    {
+        const Block_t& b = Block[i];
+
+        s_value(w, b.Location.X);
+        s_value(w, b.Location.Y);
+        s_value(w, b.Type);
+        s_value(w, b.Hidden);
+    }
+
+    return s_xxh64(w.buf.data(), w.buf.size(), 0);
+}
+
+void Start(const std::string& default_path)
+{
+    Stop();
+
+    std::string path = output_path;
+
+    if(path.empty() && g_config.record_state_hash)
+        path = default_path;
+
+    if(path.empty())
+        return;
+
+    s_out = Files::utf8_fopen(path.c_str(), "wb");
+
+    if(!s_out)
+    {
+        pLogWarning("State hash: can't open %s for writing", path.c_str());
+        return;
+    }
+
+    fwrite(c_hashMagic, 1, 4, s_out);
+    fputc(c_hashVersion, s_out);
+}
+
+void Frame()
+{
+    if(!s_out)
+        return;
+
+    uint64_t hash = Compute();
+
+    uint8_t bytes[8];
+    for(int i = 0; i < 8; i++)
+        bytes[i] = (uint8_t)(hash >> (i * 8));
+
+    fwrite(bytes, 1, 8, s_out);
+}
+
+void Stop()
+{
+    if(!s_out)
+        return;
+
+    fclose(s_out);
+    s_out = nullptr;
+}
+
+} // namespace StateHash
@@ -0,0 +1,54 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module writes a compact stream of per-frame hashes of the gameplay state,
+// so that the runs of two builds can be compared frame by frame
+//
+// File layout: "XTSH" magic, u8 version, then one little-endian u64 hash per frame, starting at frame 0.
+// The first differing hash (at byte offset 5 + 8 * frame) marks the frame where two runs diverged.
+
+#pragma once
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+#include <string>
+
+namespace StateHash
+{
+
+//! explicit hash stream file (set by the command line); otherwise the stream is written next to the recording if enabled in the config
+extern std::string output_path;
+
+//! returns a hash of the gameplay-relevant state: players, active NPCs, blocks, and the random call count
+uint64_t Compute();
+
+//! opens the hash stream (if enabled), using default_path unless output_path is set
+void Start(const std::string& default_path);
+
+//! appends the hash of the current state (called once per frame)
+void Frame();
+
+//! closes the hash stream
+void Stop();
+
+} // namespace StateHash
+
+#endif // #ifndef STATE_HASH_H
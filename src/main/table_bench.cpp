@@ -0,0 +1,409 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <DirManager/dirman.h>
+#include <Utils/files.h>
+#include <Logger/logger.h>
+
+#include "../globals.h"
+#include "../layers.h"
+#include "level_file.h"
+#include "trees.h"
+#include "block_table.h"
+#include "block_table.hpp"
+#include "table_bench.h"
+
+namespace TableBench
+{
+
+//! number of queries per query pass
+static constexpr int c_numQueries = 20000;
+
+//! xorshift32: the benchmark must not disturb the game's random state
+static uint32_t s_rng = 1;
+
+static uint32_t s_rand()
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+//! heap allocations are counted at the benchmarking thread while a benchmarked op runs (see operator new below)
+static TREEQUERY_THREAD_LOCAL bool s_count_allocs = false;
+static TREEQUERY_THREAD_LOCAL size_t s_num_allocs = 0;
+
+struct bench_run_t
+{
+    double seconds = 0.0;
+    size_t allocs = 0;
+};
+
+template<class Func>
+static bench_run_t s_time(Func f)
+{
+    bench_run_t ret;
+
+    s_num_allocs = 0;
+    s_count_allocs = true;
+
+    auto start = std::chrono::steady_clock::now();
+    f();
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    s_count_allocs = false;
+    ret.allocs = s_num_allocs;
+
+    return ret;
+}
+
+static void s_report(const char* bench_case, const char* table, const char* op, size_t ops, const bench_run_t& run, size_t results = 0)
+{
+    double mops = (run.seconds > 0) ? (double)ops / run.seconds / 1e6 : 0.0;
+
+    printf("%-24s %-8s %-20s %8zu ops %9.3f ms %8.3f Mops/s %8zu allocs", bench_case, table, op, ops, run.seconds * 1000.0, mops, run.allocs);
+
+    if(results)
+        printf(" %6.1f results/query", (double)results / ops);
+
+    printf("\n");
+}
+
+static const char* s_sort_name(int sort_mode)
+{
+    switch(sort_mode)
+    {
+    case SORTMODE_ID:
+        return "id";
+    case SORTMODE_LOC:
+        return "loc";
+    case SORTMODE_Z:
+        return "z";
+    default:
+        return "none";
+    }
+}
+
+//! sorts query results the way the engine's queries do, or (as the baseline) with the comparison sort they used before
+template<class ItemRef_t>
+static void s_sort(std::vector<BaseRef_t>& out, int sort_mode, bool baseline)
+{
+    if(!baseline)
+        sort_query_results<ItemRef_t>(out, 0, sort_mode);
+    else if(sort_mode == SORTMODE_LOC)
+        std::sort(out.begin(), out.end(), Comparisons::Loc<ItemRef_t>);
+    else if(sort_mode == SORTMODE_ID)
+        std::sort(out.begin(), out.end(), Comparisons::ID<ItemRef_t>);
+    else if(sort_mode == SORTMODE_Z)
+        std::sort(out.begin(), out.end(), Comparisons::Z<ItemRef_t>);
+}
+
+//! makes query rects around random members: small ones (like collision checks) and screen-sized ones (like drawing)
+template<class ItemRef_t>
+static std::vector<Location_t> s_make_queries(int count, double w, double h)
+{
+    std::vector<Location_t> ret;
+    ret.reserve(c_numQueries);
+
+    for(int i = 0; i < c_numQueries; i++)
+    {
+        ItemRef_t obj = (int)(s_rand() % count) + 1;
+        const Location_t& loc = obj->Location;
+
+        double jitter_x = (double)(s_rand() % 64) - 32;
+        double jitter_y = (double)(s_rand() % 64) - 32;
+
+        ret.push_back(newLoc(loc.X + jitter_x - w / 2, loc.Y + jitter_y - h / 2, w, h));
+    }
+
+    return ret;
+}
+
+//! benchmarks a standalone table filled with the first count members of the array
+template<class ItemRef_t>
+static void s_bench_table(const char* bench_case, const char* table_name, int count)
+{
+    if(count <= 0)
+        return;
+
+    table_t<ItemRef_t> table;
+    std::vector<BaseRef_t> out;
+    char op[32];
+
+    bench_run_t t = s_time([&]()
+    {
+        for(int i = 1; i <= count; i++)
+            table.insert(i);
+    });
+    s_report(bench_case, table_name, "insert", count, t);
+
+    table_stats_t st = table.stats();
+    printf("%-24s %-8s %zu members, %zu screens, %zu overflow nodes (%zu KiB)\n", bench_case, table_name,
+           st.members, st.screens, st.overflow_nodes,
+           (st.screens * sizeof(screen_t) + st.overflow_nodes * sizeof(node_t)) / 1024);
+
+    const std::vector<Location_t> small_queries = s_make_queries<ItemRef_t>(count, 32, 32);
+    const std::vector<Location_t> screen_queries = s_make_queries<ItemRef_t>(count, 800, 600);
+
+    for(int sort_mode : {SORTMODE_NONE, SORTMODE_ID, SORTMODE_LOC})
+    {
+        for(int pass = 0; pass < 2; pass++)
+        {
+            // the "-std" ops time the std::sort baseline for the same queries
+            for(bool baseline : {false, true})
+            {
+                if(baseline && sort_mode == SORTMODE_NONE)
+                    continue;
+
+                const std::vector<Location_t>& queries = pass ? screen_queries : small_queries;
+                size_t results = 0;
+
+                t = s_time([&]()
+                {
+                    for(const Location_t& loc : queries)
+                    {
+                        out.clear();
+                        table.query(out, loc);
+                        s_sort<ItemRef_t>(out, sort_mode, baseline);
+                        results += out.size();
+                    }
+                });
+
+                snprintf(op, sizeof(op), "query-%s-%s%s", pass ? "screen" : "small", s_sort_name(sort_mode), baseline ? "-std" : "");
+                s_report(bench_case, table_name, op, queries.size(), t, results);
+            }
+        }
+    }
+
+    // move every member by a tile and back (the first pass hits the no-change check for small moves)
+    for(double delta : {0.5, 48.0})
+    {
+        t = s_time([&]()
+        {
+            for(int i = 1; i <= count; i++)
+            {
+                ItemRef_t obj = i;
+                obj->Location.X += delta;
+                table.update(obj);
+                obj->Location.X -= delta;
+                table.update(obj);
+            }
+        });
+
+        s_report(bench_case, table_name, (delta < 1) ? "update-same-cell" : "update-move", (size_t)count * 2, t);
+    }
+
+    t = s_time([&]()
+    {
+        for(int i = 1; i <= count; i++)
+            table.erase(i);
+    });
+    s_report(bench_case, table_name, "erase", count, t);
+}
+
+//! benchmarks the engine-level queries (including margins and layer tables) over the current level
+static void s_bench_engine_queries(const char* bench_case)
+{
+    if(numBlock > 0)
+    {
+        const std::vector<Location_t> queries = s_make_queries<BlockRef_t>(numBlock, 32, 32);
+
+        for(int sort_mode : {SORTMODE_NONE, SORTMODE_ID, SORTMODE_LOC, SORTMODE_COMPAT})
+        {
+            size_t results = 0;
+
+            bench_run_t t = s_time([&]()
+            {
+                for(const Location_t& loc : queries)
+                    results += treeFLBlockQuery(loc, sort_mode).i_vec->size();
+            });
+
+            char op[32];
+            snprintf(op, sizeof(op), "FLBlock-%s", (sort_mode == SORTMODE_COMPAT) ? "compat" : s_sort_name(sort_mode));
+            s_report(bench_case, "engine", op, queries.size(), t, results);
+        }
+    }
+
+    if(numNPCs > 0)
+    {
+        const std::vector<Location_t> queries = s_make_queries<NPCRef_t>(numNPCs, 32, 32);
+
+        for(int sort_mode : {SORTMODE_NONE, SORTMODE_ID, SORTMODE_LOC})
+        {
+            size_t results = 0;
+
+            bench_run_t t = s_time([&]()
+            {
+                for(const Location_t& loc : queries)
+                    results += treeNPCQuery(loc, sort_mode).i_vec->size();
+            });
+
+            char op[32];
+            snprintf(op, sizeof(op), "NPC-%s", s_sort_name(sort_mode));
+            s_report(bench_case, "engine", op, queries.size(), t, results);
+        }
+    }
+}
+
+static void s_bench_current(const char* bench_case)
+{
+    s_rng = 1;
+
+    printf("== %s: %d blocks, %d NPCs\n", bench_case, (int)numBlock, (int)numNPCs);
+
+    s_bench_table<BlockRef_t>(bench_case, "block", numBlock);
+    s_bench_table<NPCRef_t>(bench_case, "npc", numNPCs);
+    s_bench_engine_queries(bench_case);
+
+    fflush(stdout);
+}
+
+/**
+ * \brief fills the level with a synthetic grid of blocks and NPCs
+ *
+ * \param spacing distance between neighbouring blocks (32 is a solid wall, smaller values overlap)
+ * \param npc_cluster number of NPCs stacked at each NPC location (more than 4 uses the overflow chains)
+ **/
+static void s_make_synthetic(int blocks, double spacing, int npcs, int npc_cluster)
+{
+    ClearLevel();
+
+    const int row_size = 256;
+
+    numBlock = blocks;
+    for(int i = 1; i <= numBlock; i++)
+    {
+        Block_t& b = Block[i];
+        b = Block_t();
+        b.Type = 1;
+        b.Layer = LAYER_NONE;
+        b.Location = newLoc(((i - 1) % row_size) * spacing, -((i - 1) / row_size) * spacing, 32, 32);
+        treeBlockAddLayer(b.Layer, i);
+    }
+
+    numNPCs = npcs;
+    for(int i = 1; i <= numNPCs; i++)
+    {
+        NPC_t& n = NPC[i];
+        int spot = (i - 1) / npc_cluster;
+
+        n = NPC_t();
+        n.Type = NPCID_FODDER_S3;
+        n.Layer = LAYER_NONE;
+        n.Location = newLoc((spot % row_size) * 48.0 + (i % npc_cluster), -(spot / row_size) * 64.0 - 32, 32, 32);
+        treeNPCAdd(i);
+    }
+}
+
+static void s_list_levels(const std::string& path, std::vector<std::string>& out)
+{
+    if(path.empty() || path == "synthetic")
+        return;
+
+    if(!DirMan::exists(path))
+    {
+        out.push_back(path);
+        return;
+    }
+
+    std::string dir = path;
+    if(dir.back() != '/')
+        dir.push_back('/');
+
+    std::vector<std::string> files;
+    DirMan(dir).getListOfFiles(files, {".lvl", ".lvlx"});
+    std::sort(files.begin(), files.end());
+
+    for(const std::string& f : files)
+        out.push_back(dir + f);
+}
+
+int Run(const std::string& path)
+{
+    int ret = 0;
+
+    s_make_synthetic(maxBlocks, 32.0, maxNPCs, 1);
+    s_bench_current("synthetic-grid");
+
+    s_make_synthetic(maxBlocks, 8.0, maxNPCs, 8);
+    s_bench_current("synthetic-dense");
+
+    std::vector<std::string> levels;
+    s_list_levels(path, levels);
+
+    for(const std::string& level : levels)
+    {
+        ClearLevel();
+
+        if(!OpenLevel(level))
+        {
+            fprintf(stderr, "Error: can't load level %s\n", level.c_str());
+            ret = 1;
+            continue;
+        }
+
+        s_bench_current(Files::basename(level).c_str());
+    }
+
+    ClearLevel();
+
+    return ret;
+}
+
+} // namespace TableBench
+
+// counts the allocations of the benchmarking thread; otherwise the same as the default operator new
+//   (the array and nothrow forms call this one, and the sized operator delete calls the unsized one)
+void* operator new(std::size_t size)
+{
+    if(TableBench::s_count_allocs)
+        TableBench::s_num_allocs++;
+
+    if(size == 0)
+        size = 1;
+
+    while(true)
+    {
+        void* p = std::malloc(size);
+
+        if(p)
+            return p;
+
+        std::new_handler handler = std::get_new_handler();
+
+        if(!handler)
+            throw std::bad_alloc();
+
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,43 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module implements a microbenchmark of the block and NPC spatial tables (run with --bench-tables)
+
+#pragma once
+#ifndef TABLE_BENCH_H
+#define TABLE_BENCH_H
+
+#include <string>
+
+namespace TableBench
+{
+
+/**
+ * \brief benchmarks insert, update, erase, and query throughput of the spatial tables
+ *
+ * runs synthetic dense levels first, then every level at path (a level file or a directory of levels; "synthetic" runs no levels)
+ *
+ * \returns the process exit code
+ **/
+int Run(const std::string& path);
+
+} // namespace TableBench
+
+#endif // #ifndef TABLE_BENCH_H
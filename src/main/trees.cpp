@@ -29,8 +29,22 @@
 #include "main/block_table.hpp"
 
 
-std::vector<BaseRef_t> treeresult_vec[MAX_TREEQUERY_DEPTH] = {std::vector<BaseRef_t>(400), std::vector<BaseRef_t>(400), std::vector<BaseRef_t>(50), std::vector<BaseRef_t>(50)};
-ptrdiff_t cur_treeresult_vec = 0;
+TREEQUERY_THREAD_LOCAL TreeResultStack_t* g_treeResultStack = nullptr;
+
+TreeResultStack_t* treeResultStackInit()
+{
+    // worker threads live as long as the game, so their stacks are never freed
+    g_treeResultStack = new TreeResultStack_t();
+    return g_treeResultStack;
+}
+
+void TreeResultStack_t::grow()
+{
+    m_vecs.emplace_back(new std::vector<BaseRef_t>());
+
+    // the two outermost queries are usually screen-sized, the nested ones are small
+    m_vecs.back()->reserve((m_vecs.size() <= 2) ? 400 : 50);
+}
 
 const double s_gridSize = 4;
 
@@ -104,29 +118,7 @@ TreeResult_Sentinel<ItemRef_t> treeWorldQuery(std::unique_ptr<table_t<ItemRef_t>
                                   (Right - Left) + s_gridSize * 2,
                                   (Bottom - Top) + s_gridSize * 2));
 
-    if(sort_mode == SORTMODE_ID)
-    {
-        std::sort(result.i_vec->begin(), result.i_vec->end(),
-            [](BaseRef_t a, BaseRef_t b) {
-                return a < b;
-            });
-    }
-    else if(sort_mode == SORTMODE_LOC)
-    {
-        std::sort(result.i_vec->begin(), result.i_vec->end(),
-            [](BaseRef_t a, BaseRef_t b) {
-                return (((ItemRef_t)a)->Location.X < ((ItemRef_t)b)->Location.X
-                    || (((ItemRef_t)a)->Location.X == ((ItemRef_t)b)->Location.X
-                        && ((ItemRef_t)a)->Location.Y < ((ItemRef_t)b)->Location.Y));
-            });
-    }
-    else if(sort_mode == SORTMODE_Z)
-    {
-        std::sort(result.i_vec->begin(), result.i_vec->end(),
-            [](BaseRef_t a, BaseRef_t b) {
-                return a < b;
-            });
-    }
+    sort_query_results<ItemRef_t>(*result.i_vec, 0, sort_mode);
 
     return result;
 }
@@ -425,11 +417,9 @@ void UpdatableQuery<BlockRef_t>::update(const Location_t& loc, const UpdatableQu
         }
     }
 
-    // sort all of the blocks after the current step (manually separating cases to maximize chances of successful inlining)
-    if(sort_mode_use == SORTMODE_Z)
-        std::sort(sent.i_vec->begin() + start_sort, sent.i_vec->end(), Comparisons::Z<BlockRef_t>);
-    else if(sort_mode_use == SORTMODE_LOC)
-        std::sort(sent.i_vec->begin() + start_sort, sent.i_vec->end(), Comparisons::Loc<BlockRef_t>);
-    else
-        std::sort(sent.i_vec->begin() + start_sort, sent.i_vec->end(), Comparisons::ID<BlockRef_t>);
+    // sort all of the blocks after the current step
+    if(sort_mode_use != SORTMODE_Z && sort_mode_use != SORTMODE_LOC)
+        sort_mode_use = SORTMODE_ID;
+
+    sort_query_results<BlockRef_t>(*sent.i_vec, start_sort, sort_mode_use);
 }
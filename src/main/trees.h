@@ -22,13 +22,66 @@
 #ifndef TREES_HHHH
 #define TREES_HHHH
 
+#include <memory>
+#include <vector>
+
 #include "sdl_proxy/sdl_assert.h"
 
 #include "globals.h"
 
-#define MAX_TREEQUERY_DEPTH 4
-extern std::vector<BaseRef_t> treeresult_vec[MAX_TREEQUERY_DEPTH];
-extern ptrdiff_t cur_treeresult_vec;
+// result and scratch buffers of the tree queries are per-thread where threading is available,
+//   so that queries are reentrant and may run on worker threads
+#ifndef PGE_NO_THREADING
+#   define TREEQUERY_THREAD_LOCAL thread_local
+#else
+#   define TREEQUERY_THREAD_LOCAL
+#endif
+
+//! stack of query result vectors used by TreeResult_Sentinel; released vectors keep their capacity for the next query at the same depth
+class TreeResultStack_t
+{
+    // held by pointer so that the vectors in use stay in place when the stack grows
+    std::vector<std::unique_ptr<std::vector<BaseRef_t>>> m_vecs;
+    size_t m_depth = 0;
+
+    void grow();
+
+public:
+    inline std::vector<BaseRef_t>* push()
+    {
+        if(m_depth == m_vecs.size())
+            grow();
+
+        std::vector<BaseRef_t>* ret = m_vecs[m_depth++].get();
+        ret->clear();
+
+        return ret;
+    }
+
+    inline void pop(std::vector<BaseRef_t>* vec)
+    {
+        SDL_assert(m_depth > 0); // invalid state
+        m_depth--;
+        SDL_assert(m_vecs[m_depth].get() == vec); // scopes have been switched
+        (void)vec;
+    }
+};
+
+// the per-thread stack is reached through a plain pointer, so that it needs no thread-local init guard at every query
+extern TREEQUERY_THREAD_LOCAL TreeResultStack_t* g_treeResultStack;
+
+//! creates the calling thread's result stack (kept until the program exits)
+TreeResultStack_t* treeResultStackInit();
+
+inline TreeResultStack_t& treeResultStack()
+{
+    TreeResultStack_t* stack = g_treeResultStack;
+
+    if(!stack)
+        stack = treeResultStackInit();
+
+    return *stack;
+}
 
 enum SortMode
 {
@@ -122,11 +175,7 @@ public:
 
     TreeResult_Sentinel()
     {
-        SDL_assert(cur_treeresult_vec >= 0); // invalid state
-        SDL_assert_release(cur_treeresult_vec < MAX_TREEQUERY_DEPTH); // insufficient sentinels: move recursive calls out of sentinel scope
-        i_vec = &treeresult_vec[cur_treeresult_vec];
-        i_vec->clear();
-        cur_treeresult_vec ++;
+        i_vec = treeResultStack().push();
     }
 
     TreeResult_Sentinel(const TreeResult_Sentinel& other) = delete;
@@ -160,8 +209,7 @@ public:
     {
         if(!i_vec)
             return;
-        cur_treeresult_vec --;
-        SDL_assert(cur_treeresult_vec == i_vec - &treeresult_vec[0]); // scopes have been switched
+        g_treeResultStack->pop(i_vec);
     }
 };
 
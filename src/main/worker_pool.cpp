@@ -0,0 +1,211 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PGE_NO_THREADING
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+#endif
+
+#include <Logger/logger.h>
+
+#include "main/worker_pool.h"
+
+namespace WorkerPool
+{
+
+#ifndef PGE_NO_THREADING
+
+static constexpr int c_numWorkers = c_maxParallelJobs - 1;
+
+static SDL_Thread* s_workers[c_numWorkers] = {nullptr};
+static int s_numWorkers = 0;
+
+static SDL_mutex* s_mutex = nullptr;
+static SDL_cond* s_startCond = nullptr;
+static SDL_cond* s_doneCond = nullptr;
+
+//! set if the workers failed to start, so that this isn't retried every frame
+static bool s_startFailed = false;
+
+// the current batch, protected by s_mutex
+static Job_t s_job = nullptr;
+static void* s_userdata = nullptr;
+static int s_count = 0;
+static int s_pending = 0;
+static unsigned s_batch = 0;
+static bool s_quit = false;
+
+static int s_workerMain(void* param)
+{
+    // worker N always runs job N + 1 of a batch
+    int index = (int)(intptr_t)param + 1;
+    unsigned seen_batch = 0;
+
+    SDL_LockMutex(s_mutex);
+
+    while(true)
+    {
+        while(!s_quit && s_batch == seen_batch)
+            SDL_CondWait(s_startCond, s_mutex);
+
+        if(s_quit)
+            break;
+
+        seen_batch = s_batch;
+
+        if(index >= s_count)
+            continue;
+
+        Job_t job = s_job;
+        void* userdata = s_userdata;
+
+        SDL_UnlockMutex(s_mutex);
+        job(userdata, index);
+        SDL_LockMutex(s_mutex);
+
+        s_pending--;
+        if(s_pending == 0)
+            SDL_CondSignal(s_doneCond);
+    }
+
+    SDL_UnlockMutex(s_mutex);
+
+    return 0;
+}
+
+static bool s_start()
+{
+    if(s_startFailed)
+        return false;
+
+    // no point in spreading the work over a single core
+    if(SDL_GetCPUCount() < 2)
+    {
+        s_startFailed = true;
+        return false;
+    }
+
+    s_mutex = SDL_CreateMutex();
+    s_startCond = SDL_CreateCond();
+    s_doneCond = SDL_CreateCond();
+
+    if(s_mutex && s_startCond && s_doneCond)
+    {
+        // workers start out having seen batch 0
+        s_quit = false;
+        s_batch = 0;
+
+        for(; s_numWorkers < c_numWorkers; s_numWorkers++)
+        {
+            s_workers[s_numWorkers] = SDL_CreateThread(s_workerMain, "Worker", (void*)(intptr_t)s_numWorkers);
+
+            if(!s_workers[s_numWorkers])
+                break;
+        }
+    }
+
+    if(s_numWorkers < c_numWorkers)
+    {
+        pLogWarning("WorkerPool: failed to start the worker threads (%s), running jobs serially", SDL_GetError());
+        Quit();
+        s_startFailed = true;
+        return false;
+    }
+
+    return true;
+}
+
+void Run(int count, Job_t job, void* userdata)
+{
+    if(count > 1 && (s_numWorkers || s_start()))
+    {
+        int parallel = (count < c_maxParallelJobs) ? count : c_maxParallelJobs;
+
+        SDL_LockMutex(s_mutex);
+        s_job = job;
+        s_userdata = userdata;
+        s_count = parallel;
+        s_pending = parallel - 1;
+        s_batch++;
+        SDL_UnlockMutex(s_mutex);
+        SDL_CondBroadcast(s_startCond);
+
+        job(userdata, 0);
+
+        for(int i = parallel; i < count; i++)
+            job(userdata, i);
+
+        SDL_LockMutex(s_mutex);
+
+        while(s_pending > 0)
+            SDL_CondWait(s_doneCond, s_mutex);
+
+        SDL_UnlockMutex(s_mutex);
+
+        return;
+    }
+
+    for(int i = 0; i < count; i++)
+        job(userdata, i);
+}
+
+void Quit()
+{
+    if(s_mutex)
+    {
+        SDL_LockMutex(s_mutex);
+        s_quit = true;
+        SDL_UnlockMutex(s_mutex);
+        SDL_CondBroadcast(s_startCond);
+    }
+
+    for(int i = 0; i < s_numWorkers; i++)
+        SDL_WaitThread(s_workers[i], nullptr);
+
+    s_numWorkers = 0;
+
+    if(s_doneCond)
+        SDL_DestroyCond(s_doneCond);
+    if(s_startCond)
+        SDL_DestroyCond(s_startCond);
+    if(s_mutex)
+        SDL_DestroyMutex(s_mutex);
+
+    s_doneCond = nullptr;
+    s_startCond = nullptr;
+    s_mutex = nullptr;
+}
+
+#else // #ifndef PGE_NO_THREADING
+
+void Run(int count, Job_t job, void* userdata)
+{
+    for(int i = 0; i < count; i++)
+        job(userdata, i);
+}
+
+void Quit()
+{
+}
+
+#endif // #ifndef PGE_NO_THREADING
+
+} // namespace WorkerPool
@@ -0,0 +1,49 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// this module runs small batches of independent jobs on a few persistent worker threads
+
+#pragma once
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+namespace WorkerPool
+{
+
+typedef void (*Job_t)(void* userdata, int index);
+
+//! number of jobs that may run at the same time (the calling thread plus the workers)
+static constexpr int c_maxParallelJobs = 4;
+
+/**
+ * @brief Calls job(userdata, i) for every i in [0, count) and returns when all calls are done
+ *
+ * Job 0 runs on the calling thread, and the others run on worker threads (started on first use).
+ * Without threading support, or if the workers can't be started, all jobs run on the calling thread.
+ * Jobs must not call Run() themselves.
+ */
+void Run(int count, Job_t job, void* userdata);
+
+//! stops the worker threads
+void Quit();
+
+} // namespace WorkerPool
+
+#endif // #ifndef WORKER_POOL_H
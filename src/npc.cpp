@@ -157,23 +157,9 @@ void CheckSectionNPC(int A)
         }
     }
 
-    for(int B = 0; B < numSections; B++)
-    {
-        if(NPC[A].Location.X >= level[B].X)
-        {
-            if(NPC[A].Location.X + NPC[A].Location.Width <= level[B].Width)
-            {
-                if(NPC[A].Location.Y >= level[B].Y)
-                {
-                    if(NPC[A].Location.Y + NPC[A].Location.Height <= level[B].Height)
-                    {
-                        NPC[A].Section = B;
-                        return;
-                    }
-                }
-            }
-        }
-    }
+    int found = FindContainingSection(NPC[A].Location.X, NPC[A].Location.Y, NPC[A].Location.Width, NPC[A].Location.Height);
+    if(found >= 0)
+        NPC[A].Section = found;
 }
 
 void Deactivate(int A)
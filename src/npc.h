@@ -68,6 +68,8 @@ void TurnNPCsIntoCoins();
 // Public Sub NPCFrames(A As Integer) 'updates the NPCs graphics
 // updates the NPCs graphics
 void NPCFrames(int A);
+// NEW: must be called after NPC traits change, so that NPCFrames() re-resolves which logic each NPC type uses
+void InvalidateNPCFrameTable();
 // Public Sub SkullRide(A As Integer)
 void SkullRide(int A, bool reEnable = false);
 void SkullRideDone(int A, const Location_t &alignAt);
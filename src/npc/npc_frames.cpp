@@ -30,11 +30,257 @@
 #include "main/trees.h"
 
 
+// branch of NPCFrames() for each NPC type, rebuilt after the NPC traits change
+static uint8_t s_frameBranch[maxNPCType + 1];
+static bool s_frameBranch_valid = false;
+
+// the only branch that depends on more than the type: a lit SMB2 bomb (Special2 == 1)
+static constexpr uint8_t s_frameBranchLitBomb = 80;
+static constexpr uint8_t s_frameBranchDefault = 255;
+
+// the branch of NPCFrames() that handles an NPC type, or s_frameBranchDefault
+// (the order matters: the first matching condition wins, as in the original chain of ifs)
+static uint8_t s_findFrameBranch(int Type)
+{
+    if(NPCTraits[Type].TFrames > 0)
+        return 0;
+    if(Type == NPCID_SQUID_S3 || Type == NPCID_SQUID_S1 || Type == NPCID_VILLAIN_S3 || Type == NPCID_SPIT_BOSS_BALL || Type == NPCID_FALL_BLOCK_RED ||
+       Type == NPCID_FALL_BLOCK_BROWN || Type == NPCID_SPIKY_THROWER || Type == NPCID_ITEM_THROWER || Type == NPCID_METALBARREL ||
+       Type == NPCID_HPIPE_SHORT || Type == NPCID_HPIPE_LONG || Type == NPCID_VPIPE_SHORT || Type == NPCID_VPIPE_LONG || Type == NPCID_BIG_SHELL ||
+       NPCIsVeggie(Type) || Type == NPCID_SHORT_WOOD || Type == NPCID_LONG_WOOD || Type == NPCID_SLANT_WOOD_R || Type == NPCID_SLANT_WOOD_M ||
+       Type == NPCID_PLATFORM_S3 || Type == NPCID_CHECKER_PLATFORM || Type == NPCID_PLATFORM_S1 || Type == NPCID_SPIT_GUY_BALL || Type == NPCID_SIGN ||
+       (Type >= NPCID_CARRY_BLOCK_A && Type <= NPCID_CARRY_BLOCK_D) || Type == NPCID_LIFT_SAND || Type == NPCID_CHECKPOINT || Type == NPCID_GOALTAPE ||
+       NPCTraits[Type].IsAVine || Type == NPCID_ICE_BLOCK || Type == NPCID_TNT || Type == NPCID_TIMER_S2 || Type == NPCID_POWER_S5 ||
+       Type == NPCID_MAGIC_DOOR || Type == NPCID_COCKPIT)
+        return 1;
+    if(Type == NPCID_STATUE_POWER || Type == NPCID_HEAVY_POWER)
+        return 2;
+    if(Type == NPCID_FLY_BLOCK || Type == NPCID_FLY_CANNON)
+        return 3;
+    if(Type == NPCID_QUAD_SPITTER)
+        return 4;
+    if(Type == NPCID_DOOR_MAKER)
+        return 5;
+    if(Type == NPCID_ITEM_BUBBLE)
+        return 6;
+    if(Type == NPCID_VINE_BUG)
+        return 7;
+    if(Type == NPCID_BAT)
+        return 8;
+    if(Type == NPCID_JUMP_PLANT)
+        return 9;
+    if(Type == NPCID_FIRE_BOSS)
+        return 10;
+    if(Type == NPCID_FIRE_BOSS_SHELL)
+        return 11;
+    if(Type == NPCID_FIRE_BOSS_FIRE)
+        return 12;
+    if(Type == NPCID_MAGIC_BOSS_BALL)
+        return 13;
+    if(Type == NPCID_MAGIC_BOSS_SHELL)
+        return 14;
+    if(Type == NPCID_MAGIC_BOSS)
+        return 15;
+    if(Type == NPCID_SWORDBEAM)
+        return 16;
+    if(Type == NPCID_BOMBER_BOSS)
+        return 17;
+    if(Type == NPCID_WALK_PLANT)
+        return 18;
+    if(Type == NPCID_FIRE_CHAIN)
+        return 19;
+    if(Type == NPCID_LOCK_DOOR)
+        return 20;
+    if(Type == NPCID_FIRE_DISK)
+        return 21;
+    if(Type == NPCID_GEM_1 || Type == NPCID_GEM_5 || Type == NPCID_GEM_20)
+        return 22;
+    if(Type == NPCID_TIME_SWITCH)
+        return 23;
+    if(Type == NPCID_STACKER)
+        return 24;
+    if(Type == NPCID_FIRE_PLANT)
+        return 25;
+    if(Type == NPCID_FLY_FODDER_S5)
+        return 26;
+    if(Type == NPCID_EARTHQUAKE_BLOCK)
+        return 27;
+    if(Type == NPCID_SLANT_WOOD_L)
+        return 28;
+    if(Type == NPCID_HOMING_BALL_GEN)
+        return 29;
+    if(Type == NPCID_HOMING_BALL)
+        return 30;
+    if(Type == NPCID_BOSS_FRAGILE)
+        return 31;
+    if(Type == NPCID_BOSS_CASE)
+        return 32;
+    if(Type == NPCID_WALL_TURTLE)
+        return 33;
+    if(Type == NPCID_WALL_BUG)
+        return 34;
+    if(Type == NPCID_FLIER || Type == NPCID_ROCKET_FLIER)
+        return 35;
+    if(Type == NPCID_SICK_BOSS)
+        return 36;
+    if(Type == NPCID_VILLAIN_S1)
+        return 37;
+    if(Type == NPCID_STAR_COLLECT)
+        return 38;
+    if(Type == NPCID_STONE_S4)
+        return 39;
+    if(Type == NPCID_CHAR4_HEAVY)
+        return 40;
+    if(Type == NPCID_PLR_HEAVY)
+        return 41;
+    if(Type == NPCID_FLY_CARRY_FODDER)
+        return 42;
+    if(Type == NPCID_RED_FLY_FODDER || Type == NPCID_FLY_FODDER_S3)
+        return 43;
+    if(Type == NPCID_BOMB)
+        return 44;
+    if(Type == NPCID_CHAR3_HEAVY)
+        return 45;
+    if(Type == NPCID_ITEM_BURIED)
+        return 46;
+    if(Type == NPCID_ITEM_POD)
+        return 47;
+    if(Type == NPCID_RAINBOW_SHELL || Type == NPCID_FLIPPED_RAINBOW_SHELL)
+        return 48;
+    if(NPCTraits[Type].IsAShell)
+        return 49;
+    if(Type == NPCID_JUMPER_S4)
+        return 50;
+    if(Type == NPCID_CONVEYOR)
+        return 51;
+    if(Type == NPCID_YEL_PLATFORM || Type == NPCID_BLU_PLATFORM || Type == NPCID_GRN_PLATFORM || Type == NPCID_RED_PLATFORM)
+        return 52;
+    if(Type == NPCID_BULLY)
+        return 53;
+    if(Type == NPCID_TANK_TREADS)
+        return 54;
+    if(Type == NPCID_EXT_TURTLE)
+        return 55;
+    if(Type >= NPCID_GRN_HIT_TURTLE_S4 && Type <= NPCID_YEL_HIT_TURTLE_S4)
+        return 56;
+    if(Type == NPCID_FLY)
+        return 57;
+    if(Type == NPCID_VEHICLE)
+        return 58;
+    if(Type == NPCID_SLIDE_BLOCK)
+        return 59;
+    if(Type == NPCID_VILLAIN_FIRE)
+        return 60;
+    if(Type == NPCID_STATUE_FIRE)
+        return 61;
+    if(Type == NPCID_GRN_FLY_TURTLE_S3 || Type == NPCID_RED_FLY_TURTLE_S3)
+        return 62;
+    if(Type == NPCID_LIT_BOMB_S3)
+        return 63;
+    if(Type == NPCID_ROCKET_WOOD)
+        return 64;
+    if(Type == NPCID_AXE)
+        return 65;
+    if(Type == NPCID_GRN_TURTLE_S3 || Type == NPCID_RED_TURTLE_S3 || Type == NPCID_GLASS_TURTLE || Type == NPCID_SPIKY_S3 || Type == NPCID_SPIKY_S4 ||
+       Type == NPCID_GHOST_FAST || Type == NPCID_SIDE_PLANT || Type == NPCID_BIG_TURTLE ||
+       (Type >= NPCID_GRN_TURTLE_S4 && Type <= NPCID_YEL_TURTLE_S4) || (Type >= NPCID_GRN_FLY_TURTLE_S4 && Type <= NPCID_YEL_FLY_TURTLE_S4) ||
+       Type == NPCID_WALK_BOMB_S3 || Type == NPCID_LIFT_SAND || Type == NPCID_BRUTE || Type == NPCID_BRUTE_SQUISHED || Type == NPCID_BIG_MOLE ||
+       Type == NPCID_CARRY_FODDER || Type == NPCID_HIT_CARRY_FODDER || Type == NPCID_GRN_TURTLE_S1 || Type == NPCID_RED_TURTLE_S1 ||
+       Type == NPCID_GRN_FLY_TURTLE_S1 || Type == NPCID_RED_FLY_TURTLE_S1 || Type == NPCID_LAVA_MONSTER || Type == NPCID_GRN_FISH_S3 ||
+       Type == NPCID_FISH_S4 || Type == NPCID_RED_FISH_S3 || Type == NPCID_GOGGLE_FISH || Type == NPCID_GRN_FISH_S1)
+        return 66;
+    if(Type == NPCID_BONE_FISH)
+        return 67;
+    if(Type == NPCID_SKELETON)
+        return 68;
+    if(Type == NPCID_MEDAL)
+        return 69;
+    if(NPCTraits[Type].IsACoin)
+        return 70;
+    if(Type == NPCID_ITEMGOAL)
+        return 71;
+    if(Type == NPCID_TOOTHY)
+        return 72;
+    if(Type == NPCID_TOOTHYPIPE)
+        return 73;
+    if(Type == NPCID_LAVABUBBLE)
+        return 74;
+    if(Type == NPCID_PLR_FIREBALL || Type == NPCID_HEAVY_THROWN || Type == NPCID_PLANT_FIRE || Type == NPCID_PLR_ICEBALL)
+        return 75;
+    if(Type == NPCID_MINIBOSS)
+        return 76;
+    if(Type == NPCID_STONE_S3 || Type == NPCID_STONE_S4)
+        return 77;
+    if(Type == NPCID_BULLET || Type == NPCID_BIG_BULLET || Type == NPCID_KEY || Type == NPCID_STATUE_S3 || Type == NPCID_CIVILIAN ||
+       Type == NPCID_CHAR3 || NPCIsYoshi(Type) || Type == NPCID_CHAR2 || Type == NPCID_CHAR5 || Type == NPCID_STATUE_S4)
+        return 78;
+    if(Type == NPCID_LEAF_POWER)
+        return 79;
+    if(Type == NPCID_BLU_GUY || Type == NPCID_RED_GUY || Type == NPCID_RED_FISH_S1 || (Type >= NPCID_BIRD && Type <= NPCID_GRY_SPIT_GUY) ||
+       Type == NPCID_WALK_BOMB_S2 || Type == NPCID_SATURN)
+        return 81;
+    if(Type == NPCID_JUMPER_S3)
+        return 82;
+    if(Type == NPCID_CANNONITEM)
+        return 83;
+    if(Type == NPCID_PINK_CIVILIAN)
+        return 84;
+    if(Type == NPCID_SPRING)
+        return 85;
+    if(Type == NPCID_SPIT_BOSS)
+        return 86;
+    if(Type == NPCID_KNIGHT)
+        return 87;
+    if(Type == NPCID_HEAVY_THROWER)
+        return 88;
+    if(Type == NPCID_PET_FIRE)
+        return 89;
+    if(Type == NPCID_GRN_BOOT || Type == NPCID_RED_BOOT || Type == NPCID_BLU_BOOT)
+        return 90;
+    if(Type == NPCID_GHOST_S3 || Type == NPCID_GHOST_S4 || Type == NPCID_BIG_GHOST)
+        return 91;
+    if(Type == NPCID_GOALORB_S2)
+        return 92;
+    if(Type == NPCID_STAR_EXIT)
+        return 93;
+    if(!(NPCTraits[Type].IsABonus || Type == NPCID_CANNONENEMY || Type == NPCID_COIN_SWITCH))
+        return 94;
+    if(Type == NPCID_FIRE_POWER_S4 || Type == NPCID_ICE_POWER_S4)
+        return 95;
+    if(Type == NPCID_FIRE_POWER_S1)
+        return 96;
+
+    return s_frameBranchDefault;
+}
+
+void InvalidateNPCFrameTable()
+{
+    s_frameBranch_valid = false;
+}
+
+static void s_buildFrameTable()
+{
+    for(int Type = 0; Type <= maxNPCType; Type++)
+        s_frameBranch[Type] = s_findFrameBranch(Type);
+
+    s_frameBranch_valid = true;
+}
+
 void NPCFrames(int A)
 {
     Location_t tempLocation;
 
-    if(NPC[A]->TFrames > 0) // custom frames
+    if(!s_frameBranch_valid)
+        s_buildFrameTable();
+
+    uint8_t branch = s_frameBranch[NPC[A].Type];
+
+    if(branch > s_frameBranchLitBomb && NPC[A].Type == NPCID_WALK_BOMB_S2 && NPC[A].Special2 == 1)
+        branch = s_frameBranchLitBomb;
+
+    switch(branch)
+    {
+    case 0: // custom frames
     {
         NPC[A].FrameCount += 1;
         if(NPC[A]->FrameStyle == 2 && (NPC[A].Projectile || NPC[A].HoldingPlayer > 0))
@@ -108,21 +354,17 @@ void NPCFrames(int A)
                 }
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_SQUID_S3 || NPC[A].Type == NPCID_SQUID_S1 || NPC[A].Type == NPCID_VILLAIN_S3 || NPC[A].Type == NPCID_SPIT_BOSS_BALL ||
-            NPC[A].Type == NPCID_FALL_BLOCK_RED || NPC[A].Type == NPCID_FALL_BLOCK_BROWN || NPC[A].Type == NPCID_SPIKY_THROWER || NPC[A].Type == NPCID_ITEM_THROWER ||
-            NPC[A].Type == NPCID_METALBARREL || NPC[A].Type == NPCID_HPIPE_SHORT || NPC[A].Type == NPCID_HPIPE_LONG || NPC[A].Type == NPCID_VPIPE_SHORT ||
-            NPC[A].Type == NPCID_VPIPE_LONG || NPC[A].Type == NPCID_BIG_SHELL || NPCIsVeggie(NPC[A]) || NPC[A].Type == NPCID_SHORT_WOOD ||
-            NPC[A].Type == NPCID_LONG_WOOD || NPC[A].Type == NPCID_SLANT_WOOD_R || NPC[A].Type == NPCID_SLANT_WOOD_M || NPC[A].Type == NPCID_PLATFORM_S3 ||
-            NPC[A].Type == NPCID_CHECKER_PLATFORM || NPC[A].Type == NPCID_PLATFORM_S1 || NPC[A].Type == NPCID_SPIT_GUY_BALL || NPC[A].Type == NPCID_SIGN ||
-            (NPC[A].Type >= NPCID_CARRY_BLOCK_A && NPC[A].Type <= NPCID_CARRY_BLOCK_D) || NPC[A].Type == NPCID_LIFT_SAND || NPC[A].Type == NPCID_CHECKPOINT ||
-            NPC[A].Type == NPCID_GOALTAPE || NPC[A]->IsAVine || NPC[A].Type == NPCID_ICE_BLOCK || NPC[A].Type == NPCID_TNT ||
-            NPC[A].Type == NPCID_TIMER_S2 || NPC[A].Type == NPCID_POWER_S5 || NPC[A].Type == NPCID_MAGIC_DOOR || NPC[A].Type == NPCID_COCKPIT) // no frames
+
+    case 1: // no frames
     {
         if(!(NPC[A].Type == NPCID_VILLAIN_S3 || NPC[A].Type == NPCID_ITEM_THROWER || NPC[A].Type == NPCID_SPIKY_THROWER) && A == 0) // Reset Frame to 0 unless a specific NPC type
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_STATUE_POWER || NPC[A].Type == NPCID_HEAVY_POWER)
+
+    case 2:
     {
         int new_frame = 0;
 
@@ -153,8 +395,10 @@ void NPCFrames(int A)
         }
 
         NPC[A].FrameCount = 1;
+        break;
     }
-    else if(NPC[A].Type == NPCID_FLY_BLOCK || NPC[A].Type == NPCID_FLY_CANNON) // fly block
+
+    case 3: // fly block
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].HoldingPlayer > 0)
@@ -180,8 +424,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Type == NPCID_FLY_CANNON && NPC[A].Direction == 1)
             NPC[A].Frame += 4;
+        break;
     }
-    else if(NPC[A].Type == NPCID_QUAD_SPITTER) // fire plant thing
+
+    case 4: // fire plant thing
     {
         if(NPC[A].Special == 0)
         {
@@ -211,8 +457,10 @@ void NPCFrames(int A)
         }
         else
             NPC[A].Frame = 3;
+        break;
     }
-    else if(NPC[A].Type == NPCID_DOOR_MAKER) // potion
+
+    case 5: // potion
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -222,8 +470,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Frame >= 4)
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_ITEM_BUBBLE) // bubble
+
+    case 6: // bubble
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 6)
@@ -239,8 +489,10 @@ void NPCFrames(int A)
             NPC[A].FrameCount = 0;
             NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_VINE_BUG) // spider
+
+    case 7: // spider
     {
         if(NPC[A].Projectile || NPC[A].Location.SpeedY >= 0 || NPC[A].HoldingPlayer > 0)
             NPC[A].Frame = 0;
@@ -251,8 +503,10 @@ void NPCFrames(int A)
             NPC[A].FrameCount = 0;
         else if(NPC[A].FrameCount >= 8)
             NPC[A].Frame += 1;
+        break;
     }
-    else if(NPC[A].Type == NPCID_BAT) // bat thing
+
+    case 8: // bat thing
     {
         if(NPC[A].Special == 0)
             NPC[A].Frame = 0;
@@ -269,8 +523,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 3;
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_JUMP_PLANT) // jumping plant
+
+    case 9: // jumping plant
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -281,8 +537,10 @@ void NPCFrames(int A)
         if(NPC[A].Frame >= 4)
             NPC[A].Frame = 0;
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_BOSS) // ludwig koopa
+
+    case 10: // ludwig koopa
     {
         if(NPC[A].Location.SpeedY != 0)
         {
@@ -326,8 +584,10 @@ void NPCFrames(int A)
 
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_BOSS_SHELL) // ludwig shell
+
+    case 11: // ludwig shell
     {
         if(NPC[A].Location.SpeedX == 0)
         {
@@ -348,8 +608,10 @@ void NPCFrames(int A)
                 NPC[A].Frame = 0;
         }
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_BOSS_FIRE) // ludwig fire
+
+    case 12: // ludwig fire
     {
         NPC[A].FrameCount += 1;
         NPC[A].Frame = 0;
@@ -360,8 +622,10 @@ void NPCFrames(int A)
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 2;
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_MAGIC_BOSS_BALL) // larry magic
+
+    case 13: // larry magic
     {
         if(NPC[A].Special == 0)
             NPC[A].Frame = 2;
@@ -369,8 +633,10 @@ void NPCFrames(int A)
             NPC[A].Frame = 1;
         else
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_MAGIC_BOSS_SHELL) // larry shell
+
+    case 14: // larry shell
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -382,8 +648,10 @@ void NPCFrames(int A)
             NPC[A].Frame = 5;
         if(NPC[A].Frame > 5)
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_MAGIC_BOSS) // larry koopa
+
+    case 15: // larry koopa
     {
 
         NPC[A].Frame = 0;
@@ -448,8 +716,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 10;
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_SWORDBEAM) // sword beam
+
+    case 16: // sword beam
     {
         NPC[A].Frame = 0;
         if(NPC[A].Direction == 1)
@@ -468,8 +738,10 @@ void NPCFrames(int A)
             NPC[A].FrameCount = 0;
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_BOMBER_BOSS) // mouser
+
+    case 17: // mouser
     {
         if(NPC[A].Immune > 0)
         {
@@ -512,8 +784,10 @@ void NPCFrames(int A)
                 NPC[A].Frame += 7;
         }
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_WALK_PLANT)
+
+    case 18:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 8)
@@ -530,27 +804,37 @@ void NPCFrames(int A)
         if(NPC[A].Special > 0 && NPC[A].Location.SpeedY <= 0)
             NPC[A].Frame += 2;
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_CHAIN)
+
+    case 19:
     {
         if(NPC[A].Direction == 1)
             NPC[A].Frame = SpecialFrame[2];
         else
             NPC[A].Frame = 3 - SpecialFrame[2];
+        break;
     }
-    else if(NPC[A].Type == NPCID_LOCK_DOOR)
+
+    case 20:
     {
         // NPC has no frames so do nothing
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_DISK)
+
+    case 21:
     {
         NPC[A].Frame += 1;
         if(NPC[A].Frame >= 5)
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_GEM_1 || NPC[A].Type == NPCID_GEM_5 || NPC[A].Type == NPCID_GEM_20)
+
+    case 22:
         NPC[A].Frame = SpecialFrame[8];
-    else if(NPC[A].Type == NPCID_TIME_SWITCH)
+        break;
+
+    case 23:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -560,8 +844,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Frame >= 3)
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_STACKER)
+
+    case 24:
     {
         // Special less than zero - body, zero - head
         if(NPC[A].Special < 0 && NPC[A].Location.SpeedY == 0)
@@ -585,16 +871,20 @@ void NPCFrames(int A)
             else
                 NPC[A].Frame += 2;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_PLANT)
+
+    case 25:
     {
         NPC[A].Frame = 0;
         if(Player[NPC[A].Special4].Location.X + Player[NPC[A].Special4].Location.Width / 2.0 > NPC[A].Location.X + NPC[A].Location.Width / 2.0)
             NPC[A].Frame = 2;
         if(Player[NPC[A].Special4].Location.Y + Player[NPC[A].Special4].Location.Height / 2.0 < NPC[A].Location.Y + 16)
             NPC[A].Frame += 1;
+        break;
     }
-    else if(NPC[A].Type == NPCID_FLY_FODDER_S5)
+
+    case 26:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -604,8 +894,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame >= 2)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_EARTHQUAKE_BLOCK) // POW block
+
+    case 27: // POW block
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -615,15 +907,19 @@ void NPCFrames(int A)
             if(NPC[A].Frame >= 7)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_SLANT_WOOD_L) // 1 frame left or right
+
+    case 28: // 1 frame left or right
     {
         if(NPC[A].Direction == 1)
             NPC[A].Frame = 1;
         else
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_HOMING_BALL_GEN)
+
+    case 29:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount <= 6)
@@ -648,8 +944,10 @@ void NPCFrames(int A)
             NPC[A].Frame = 1;
         else
             NPC[A].FrameCount = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_HOMING_BALL)
+
+    case 30:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount <= 8)
@@ -666,16 +964,20 @@ void NPCFrames(int A)
             NPC[A].Frame = 1;
         else
             NPC[A].FrameCount = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_BOSS_FRAGILE)
+
+    case 31:
     {
         NPC[A].Frame = 0;
         if(NPC[A].Special > 0 && NPC[A].Special < 15)
             NPC[A].Frame = 1;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 2;
+        break;
     }
-    else if(NPC[A].Type == NPCID_BOSS_CASE)
+
+    case 32:
     {
         if(NPC[A].Damage < 3)
             NPC[A].Frame = 0;
@@ -689,8 +991,10 @@ void NPCFrames(int A)
             NPC[A].Frame = 4;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 5;
+        break;
     }
-    else if(NPC[A].Type == NPCID_WALL_TURTLE)
+
+    case 33:
     {
         NPC[A].FrameCount += 1;
         NPC[A].Frame = 0;
@@ -708,8 +1012,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 2;
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_WALL_BUG)
+
+    case 34:
     {
         NPC[A].FrameCount += 1;
         NPC[A].Frame = 0;
@@ -733,8 +1039,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 15;
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_FLIER || NPC[A].Type == NPCID_ROCKET_FLIER)
+
+    case 35:
     {
         NPC[A].FrameCount += 1;
         NPC[A].Frame = 0;
@@ -750,8 +1058,10 @@ void NPCFrames(int A)
             NPC[A].FrameCount = 0;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 4;
+        break;
     }
-    else if(NPC[A].Type == NPCID_SICK_BOSS)
+
+    case 36:
     {
         NPC[A].Frame = 0;
         if(NPC[A].Special == 0)
@@ -802,8 +1112,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 8;
+        break;
     }
-    else if(NPC[A].Type == NPCID_VILLAIN_S1) // King Koopa
+
+    case 37: // King Koopa
     {
         NPC[A].Frame = 0;
         if(NPC[A].Special == 0)
@@ -832,8 +1144,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 5;
+        break;
     }
-    else if(NPC[A].Type == NPCID_STAR_COLLECT)
+
+    case 38:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -843,8 +1157,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame >= 2)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_STONE_S4)
+
+    case 39:
     {
         NPC[A].Frame = 0;
 
@@ -875,8 +1191,10 @@ void NPCFrames(int A)
                 }
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_CHAR4_HEAVY) // toad boomerang
+
+    case 40: // toad boomerang
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 6)
@@ -927,8 +1245,10 @@ void NPCFrames(int A)
 
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_PLR_HEAVY) // Mario Hammer
+
+    case 41: // Mario Hammer
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -970,8 +1290,10 @@ void NPCFrames(int A)
         treeNPCUpdate(A);
         if(NPC[A].tempBlock > 0)
             treeNPCSplitTempBlock(A);
+        break;
     }
-    else if(NPC[A].Type == NPCID_FLY_CARRY_FODDER) // smw paragoomba
+
+    case 42: // smw paragoomba
     {
         NPC[A].FrameCount += 1;
 
@@ -1001,8 +1323,10 @@ void NPCFrames(int A)
             else if(NPC[A].Special2 >= 8)
                 NPC[A].Frame += 2;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_RED_FLY_FODDER || NPC[A].Type == NPCID_FLY_FODDER_S3) // Flying Goomba
+
+    case 43: // Flying Goomba
     {
         if(NPC[A].Location.SpeedY == 0 || NPC[A].Slope > 0)
         {
@@ -1031,8 +1355,10 @@ void NPCFrames(int A)
                     NPC[A].Frame = 0;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_BOMB) // bomb
+
+    case 44: // bomb
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 4)
@@ -1058,8 +1384,10 @@ void NPCFrames(int A)
             else
                 NPC[A].Special3 = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_CHAR3_HEAVY) // heart bomb
+
+    case 45: // heart bomb
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 4)
@@ -1088,10 +1416,14 @@ void NPCFrames(int A)
             Effect[numEffects].Location.SpeedX = dRand() * 1 - 0.5;
             Effect[numEffects].Location.SpeedY = dRand() * 1 - 0.5;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_ITEM_BURIED)
+
+    case 46:
         NPC[A].Frame = SpecialFrame[5];
-    else if(NPC[A].Type == NPCID_ITEM_POD)
+        break;
+
+    case 47:
     {
         NPC[A].Frame = 0;
         if(NPC[A].Special == 98)
@@ -1108,8 +1440,10 @@ void NPCFrames(int A)
             NPC[A].Frame = 6;
         else if(NPC[A].Special == 228)
             NPC[A].Frame = 7;
+        break;
     }
-    else if(NPC[A].Type == NPCID_RAINBOW_SHELL || NPC[A].Type == NPCID_FLIPPED_RAINBOW_SHELL) // Glowy Shell
+
+    case 48: // Glowy Shell
     {
         NPC[A].Special5 += 1;
         if(NPC[A].Special5 >= 16)
@@ -1156,8 +1490,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 8;
         else if(NPC[A].Special5 < 16)
             NPC[A].Frame += 12;
+        break;
     }
-    else if(NPC[A]->IsAShell) // Turtle shell
+
+    case 49: // Turtle shell
     {
         if(NPC[A].Location.SpeedX == 0)
             NPC[A].Frame = 0;
@@ -1172,8 +1508,10 @@ void NPCFrames(int A)
                     NPC[A].Frame = 0;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_JUMPER_S4) // black ninja
+
+    case 50: // black ninja
     {
         if(NPC[A].Location.SpeedY == 0 || NPC[A].Slope > 0)
         {
@@ -1196,21 +1534,27 @@ void NPCFrames(int A)
         }
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 2;
+        break;
     }
-    else if(NPC[A].Type == NPCID_CONVEYOR) // smb3 belt
+
+    case 51: // smb3 belt
     {
         if(NPC[A].Direction == -1)
             NPC[A].Frame = SpecialFrame[4];
         else
             NPC[A].Frame = 3 - SpecialFrame[4];
+        break;
     }
-    else if(NPC[A].Type == NPCID_YEL_PLATFORM || NPC[A].Type == NPCID_BLU_PLATFORM || NPC[A].Type == NPCID_GRN_PLATFORM || NPC[A].Type == NPCID_RED_PLATFORM)
+
+    case 52:
     {
         NPC[A].Frame = 1;
         if(NPC[A].Direction == 1)
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_BULLY) // Bully
+
+    case 53: // Bully
     {
         NPC[A].Frame = 0;
         if(NPC[A].Direction == 1)
@@ -1231,8 +1575,10 @@ void NPCFrames(int A)
         }
 
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_TANK_TREADS) // tank treads
+
+    case 54: // tank treads
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -1245,8 +1591,10 @@ void NPCFrames(int A)
             NPC[A].FrameCount = 0;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 3;
+        break;
     }
-    else if(NPC[A].Type == NPCID_EXT_TURTLE) // nekkid koopa
+
+    case 55: // nekkid koopa
     {
         if(NPC[A].Special == 0)
         {
@@ -1266,8 +1614,10 @@ void NPCFrames(int A)
             else
                 NPC[A].Frame = 5;
         }
+        break;
     }
-    else if(NPC[A].Type >= NPCID_GRN_HIT_TURTLE_S4 && NPC[A].Type <= NPCID_YEL_HIT_TURTLE_S4) // beach koopa
+
+    case 56: // beach koopa
     {
         if(NPC[A].Projectile)
         {
@@ -1299,8 +1649,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 5;
+        break;
     }
-    else if(NPC[A].Type == NPCID_FLY) // bouncy bee
+
+    case 57: // bouncy bee
     {
         if(NPC[A].Location.SpeedY == 0 || NPC[A].Slope > 0)
         {
@@ -1318,14 +1670,18 @@ void NPCFrames(int A)
                 NPC[A].FrameCount = 0;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_VEHICLE)
+
+    case 58:
     {
         NPC[A].Frame = SpecialFrame[2];
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 4;
+        break;
     }
-    else if(NPC[A].Type == NPCID_SLIDE_BLOCK) // ice block
+
+    case 59: // ice block
     {
         if(NPC[A].Special == 0)
             NPC[A].Frame = BlockFrame[4];
@@ -1343,8 +1699,10 @@ void NPCFrames(int A)
             }
         }
         // bowser fireball
+        break;
     }
-    else if(NPC[A].Type == NPCID_VILLAIN_FIRE)
+
+    case 60:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 20)
@@ -1355,8 +1713,10 @@ void NPCFrames(int A)
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 4;
         // statue fireball
+        break;
     }
-    else if(NPC[A].Type == NPCID_STATUE_FIRE)
+
+    case 61:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -1367,8 +1727,10 @@ void NPCFrames(int A)
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 4;
         // winged koopa
+        break;
     }
-    else if(NPC[A].Type == NPCID_GRN_FLY_TURTLE_S3 || NPC[A].Type == NPCID_RED_FLY_TURTLE_S3)
+
+    case 62:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].Direction == -1 && NPC[A].Frame >= 4)
@@ -1391,8 +1753,10 @@ void NPCFrames(int A)
                     NPC[A].Frame = 4;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_LIT_BOMB_S3) // SMB3 Bomb
+
+    case 63: // SMB3 Bomb
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 8)
@@ -1422,8 +1786,10 @@ void NPCFrames(int A)
                 NPC[A].Special3 = 0;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_ROCKET_WOOD) // Airship Jet
+
+    case 64: // Airship Jet
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].Direction == -1 && NPC[A].Frame >= 4)
@@ -1446,8 +1812,10 @@ void NPCFrames(int A)
                     NPC[A].Frame = 4;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_AXE)
+
+    case 65:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -1457,8 +1825,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame >= 3)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_GRN_TURTLE_S3 || NPC[A].Type == NPCID_RED_TURTLE_S3 || NPC[A].Type == NPCID_GLASS_TURTLE || NPC[A].Type == NPCID_SPIKY_S3 || NPC[A].Type == NPCID_SPIKY_S4 || NPC[A].Type == NPCID_GHOST_FAST || NPC[A].Type == NPCID_SIDE_PLANT || NPC[A].Type == NPCID_BIG_TURTLE || (NPC[A].Type >= NPCID_GRN_TURTLE_S4 && NPC[A].Type <= NPCID_YEL_TURTLE_S4) || (NPC[A].Type >= NPCID_GRN_FLY_TURTLE_S4 && NPC[A].Type <= NPCID_YEL_FLY_TURTLE_S4) || NPC[A].Type == NPCID_WALK_BOMB_S3 || NPC[A].Type == NPCID_LIFT_SAND || NPC[A].Type == NPCID_BRUTE || NPC[A].Type == NPCID_BRUTE_SQUISHED || NPC[A].Type == NPCID_BIG_MOLE || NPC[A].Type == NPCID_CARRY_FODDER || NPC[A].Type == NPCID_HIT_CARRY_FODDER || NPC[A].Type == NPCID_GRN_TURTLE_S1 || NPC[A].Type == NPCID_RED_TURTLE_S1 || NPC[A].Type == NPCID_GRN_FLY_TURTLE_S1 || NPC[A].Type == NPCID_RED_FLY_TURTLE_S1 || NPC[A].Type == NPCID_LAVA_MONSTER || NPC[A].Type == NPCID_GRN_FISH_S3 || NPC[A].Type == NPCID_FISH_S4 || NPC[A].Type == NPCID_RED_FISH_S3 || NPC[A].Type == NPCID_GOGGLE_FISH || NPC[A].Type == NPCID_GRN_FISH_S1) // Walking koopa troopa / hard thing / spiney
+
+    case 66: // Walking koopa troopa / hard thing / spiney
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].Type == NPCID_HIT_CARRY_FODDER && NPC[A].Special > 360)
@@ -1484,8 +1854,10 @@ void NPCFrames(int A)
             }
         }
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_BONE_FISH)
+
+    case 67:
     {
         NPC[A].FrameCount += 1;
         NPC[A].Frame = 0;
@@ -1502,8 +1874,10 @@ void NPCFrames(int A)
         if(NPC[A].FrameCount > 32)
             NPC[A].FrameCount = 0;
 
+        break;
     }
-    else if(NPC[A].Type == NPCID_SKELETON) // dry bones
+
+    case 68: // dry bones
     {
         if(NPC[A].Special == 0)
         {
@@ -1541,8 +1915,10 @@ void NPCFrames(int A)
             if(NPC[A].Direction == 1)
                 NPC[A].Frame += 2;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_MEDAL) // dragon coin
+
+    case 69: // dragon coin
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 6)
@@ -1562,16 +1938,20 @@ void NPCFrames(int A)
             NPC[A].FrameCount = 0;
             NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A]->IsACoin) // Coin
+
+    case 70: // Coin
     {
         NPC[A].Frame = CoinFrame[3];
         if(NPC[A].Type == NPCID_COIN_S2)
             NPC[A].Frame = CoinFrame[2];
         if(NPC[A].Type == NPCID_RING)
             NPC[A].Frame = CoinFrame[3];
+        break;
     }
-    else if(NPC[A].Type == NPCID_ITEMGOAL) // Frame finder for Star/Flower/Mushroom Exit
+
+    case 71: // Frame finder for Star/Flower/Mushroom Exit
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -1581,8 +1961,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame == 3)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_TOOTHY) // killer plant
+
+    case 72: // killer plant
     {
         // .vehiclePlr = A
         NPC[A].Frame = 0;
@@ -1593,8 +1975,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 1;
         if(NPC[A].FrameCount >= 16)
             NPC[A].FrameCount = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_TOOTHYPIPE) // killer pipe
+
+    case 73: // killer pipe
     {
         if(NPC[A].HoldingPlayer == 0 && !Player[NPC[A].vehiclePlr].Controls.Run && !NPC[A].Projectile)
         {
@@ -1632,8 +2016,10 @@ void NPCFrames(int A)
                     NPC[A].Frame = 10;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_LAVABUBBLE) // Frame finder for big fireball
+
+    case 74: // Frame finder for big fireball
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -1651,8 +2037,10 @@ void NPCFrames(int A)
                     NPC[A].Frame = 2;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_PLR_FIREBALL || NPC[A].Type == NPCID_HEAVY_THROWN || NPC[A].Type == NPCID_PLANT_FIRE || NPC[A].Type == NPCID_PLR_ICEBALL) // Frame finder for Fireball / Hammer
+
+    case 75: // Frame finder for Fireball / Hammer
     {
         if((NPC[A].Type == NPCID_PLR_FIREBALL || NPC[A].Type == NPCID_PLR_ICEBALL) && NPC[A].Quicksand == 0)
         {
@@ -1758,8 +2146,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame < 16)
                 NPC[A].Frame = 18;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_MINIBOSS) // Frame finder for Big Koopa
+
+    case 76: // Frame finder for Big Koopa
     {
         if(NPC[A].Special == 0)
         {
@@ -1814,27 +2204,35 @@ void NPCFrames(int A)
         }
         else
             NPC[A].Frame = 5;
+        break;
     }
-    else if(NPC[A].Type == NPCID_STONE_S3 || NPC[A].Type == NPCID_STONE_S4) // Thwomp
+
+    case 77: // Thwomp
     {
         // Bullet Bills / Key / ONLY DIRECTION FRAMES
+        break;
     }
-    else if(NPC[A].Type == NPCID_BULLET || NPC[A].Type == NPCID_BIG_BULLET || NPC[A].Type == NPCID_KEY || NPC[A].Type == NPCID_STATUE_S3 || NPC[A].Type == NPCID_CIVILIAN || NPC[A].Type == NPCID_CHAR3 || NPCIsYoshi(NPC[A]) || NPC[A].Type == NPCID_CHAR2 || NPC[A].Type == NPCID_CHAR5 || NPC[A].Type == NPCID_STATUE_S4)
+
+    case 78:
     {
         if(NPC[A].Direction == -1)
             NPC[A].Frame = 0;
         else
             NPC[A].Frame = 1;
         // Leaf
+        break;
     }
-    else if(NPC[A].Type == NPCID_LEAF_POWER)
+
+    case 79:
     {
         if(NPC[A].Direction == -1)
             NPC[A].Frame = 1;
         else
             NPC[A].Frame = 0;
+        break;
     }
-    else if(NPC[A].Type == NPCID_WALK_BOMB_S2 && NPC[A].Special2 == 1)
+
+    case 80: // lit SMB2 bomb
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount < 4)
@@ -1852,8 +2250,10 @@ void NPCFrames(int A)
             NPC[A].Frame += 6;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 3;
+        break;
     }
-    else if(NPC[A].Type == NPCID_BLU_GUY || NPC[A].Type == NPCID_RED_GUY || NPC[A].Type == NPCID_RED_FISH_S1 || (NPC[A].Type >= NPCID_BIRD && NPC[A].Type <= NPCID_GRY_SPIT_GUY) || NPC[A].Type == NPCID_WALK_BOMB_S2 || NPC[A].Type == NPCID_SATURN) // Shy guys / Jumping Fish
+
+    case 81: // Shy guys / Jumping Fish
     {
         if(NPC[A].HoldingPlayer == 0 && !NPC[A].Projectile)
         {
@@ -1905,8 +2305,10 @@ void NPCFrames(int A)
                 }
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_JUMPER_S3) // Bouncy Star things
+
+    case 82: // Bouncy Star things
     {
         if(NPC[A].HoldingPlayer == 0 && !NPC[A].Projectile)
         {
@@ -1949,8 +2351,10 @@ void NPCFrames(int A)
                 }
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_CANNONITEM) // Bullet bill Gun
+
+    case 83: // Bullet bill Gun
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -1960,8 +2364,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame == 5)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_PINK_CIVILIAN)
+
+    case 84:
     {
         if(NPC[A].Location.SpeedX == 0)
         {
@@ -1995,8 +2401,10 @@ void NPCFrames(int A)
         }
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 4;
+        break;
     }
-    else if(NPC[A].Type == NPCID_SPRING) // Spring thing
+
+    case 85: // Spring thing
     {
         if(!LevelEditor)
         {
@@ -2038,8 +2446,10 @@ void NPCFrames(int A)
                 NPC[A].Frame = C;
             }
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_SPIT_BOSS) // birdo
+
+    case 86: // birdo
     {
         NPC[A].Frame = 0;
         if(NPC[A].Direction == 1)
@@ -2066,14 +2476,18 @@ void NPCFrames(int A)
         }
         else
             NPC[A].Frame += 2;
+        break;
     }
-    else if(NPC[A].Type == NPCID_KNIGHT) // Rat Head
+
+    case 87: // Rat Head
     {
         NPC[A].Frame = NPC[A].FrameCount;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 2;
+        break;
     }
-    else if(NPC[A].Type == NPCID_HEAVY_THROWER) // SMB Hammer Bro
+
+    case 88: // SMB Hammer Bro
     {
         // the throw counter was previously Special3, and it has been moved to SpecialX
         if(NPC[A].SpecialX >= 0)
@@ -2117,8 +2531,10 @@ void NPCFrames(int A)
             else
                 NPC[A].Frame = 5;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_PET_FIRE) // Yoshi Fireball
+
+    case 89: // Yoshi Fireball
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -2132,23 +2548,29 @@ void NPCFrames(int A)
             NPC[A].Frame = 0;
         if(NPC[A].Direction == 1)
             NPC[A].Frame += 2;
+        break;
     }
-    else if(NPC[A].Type == NPCID_GRN_BOOT || NPC[A].Type == NPCID_RED_BOOT || NPC[A].Type == NPCID_BLU_BOOT) // Goombas Shoe
+
+    case 90: // Goombas Shoe
     {
         if(NPC[A].Direction == 1)
             NPC[A].Frame = 2 + SpecialFrame[1];
         else
             NPC[A].Frame = 0 + SpecialFrame[1];
+        break;
     }
-    else if(NPC[A].Type == NPCID_GHOST_S3 || NPC[A].Type == NPCID_GHOST_S4 || NPC[A].Type == NPCID_BIG_GHOST) // Boo
+
+    case 91: // Boo
     {
         NPC[A].Frame = 0;
         if(NPC[A].Direction == 1)
             NPC[A].Frame = 2;
         if(NPC[A].Special == 1 || NPC[A].HoldingPlayer > 0)
             NPC[A].Frame += 1;
+        break;
     }
-    else if(NPC[A].Type == NPCID_GOALORB_S2) // smb2 birdo exit
+
+    case 92: // smb2 birdo exit
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 8)
@@ -2158,8 +2580,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame == 8)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_STAR_EXIT) // SMB3 Star
+
+    case 93: // SMB3 Star
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].Special == 0)
@@ -2184,8 +2608,10 @@ void NPCFrames(int A)
             else
                 NPC[A].FrameCount = 0;
         }
+        break;
     }
-    else if(!(NPC[A]->IsABonus || NPC[A].Type == NPCID_CANNONENEMY || NPC[A].Type == NPCID_COIN_SWITCH)) // Frame finder for everything else
+
+    case 94: // Frame finder for everything else
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].Type == NPCID_SPIKY_BALL_S3 || NPC[A].Type == NPCID_WALL_SPARK)
@@ -2197,8 +2623,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame == 2)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_POWER_S4 || NPC[A].Type == NPCID_ICE_POWER_S4)
+
+    case 95:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 12)
@@ -2208,8 +2636,10 @@ void NPCFrames(int A)
             if(NPC[A].Frame == 2)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else if(NPC[A].Type == NPCID_FIRE_POWER_S1)
+
+    case 96:
     {
         NPC[A].FrameCount += 1;
         if(NPC[A].FrameCount >= 4)
@@ -2219,10 +2649,14 @@ void NPCFrames(int A)
             if(NPC[A].Frame == 4)
                 NPC[A].Frame = 0;
         }
+        break;
     }
-    else
+
+    default:
     {
         if(A == 0)
             NPC[A].Frame = 0;
+        break;
+    }
     }
 }
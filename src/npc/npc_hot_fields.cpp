@@ -0,0 +1,75 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screen.h"
+
+#include "npc/npc_hot_fields.h"
+
+void NPC_HotFields_t::gather(const std::vector<BaseRef_t>& npcs)
+{
+    size_t n = npcs.size();
+
+    left.resize(n);
+    top.resize(n);
+    right.resize(n);
+    bottom.resize(n);
+    hidden.resize(n);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        const NPC_t& npc = NPC[(int16_t)npcs[i]];
+
+        // same expressions as in vScreenCollision, so that the results are bit-identical
+        left[i] = npc.Location.X;
+        top[i] = npc.Location.Y;
+        right[i] = npc.Location.X + npc.Location.Width;
+        bottom[i] = npc.Location.Y + npc.Location.Height;
+        hidden[i] = npc.Hidden;
+    }
+}
+
+void NPC_HotFields_t::collide(double l, double t, double r, double b, std::vector<uint8_t>& out) const
+{
+    size_t n = size();
+    out.resize(n);
+
+    const double* L = left.data();
+    const double* T = top.data();
+    const double* R = right.data();
+    const double* B = bottom.data();
+    uint8_t* o = out.data();
+
+    // branch-free so that the compiler can vectorize it
+    for(size_t i = 0; i < n; i++)
+        o[i] = (uint8_t)((l <= R[i]) & (r >= L[i]) & (t <= B[i]) & (b >= T[i]));
+}
+
+void NPC_HotFields_t::onscreen(int Z, std::vector<uint8_t>& out) const
+{
+    if(Z == 0)
+    {
+        out.assign(size(), 1);
+        return;
+    }
+
+    collide(-vScreen[Z].X, -vScreen[Z].Y,
+        -vScreen[Z].X + vScreen[Z].Width, -vScreen[Z].Y + vScreen[Z].Height,
+        out);
+}
@@ -0,0 +1,64 @@
+/*
+ * TheXTech - A platform game engine ported from old source code for VB6
+ *
+ * Copyright (c) 2009-2011 Andrew Spinks, original VB6 code
+ * Copyright (c) 2020-2025 Vitaly Novichkov <admin@wohlnet.ru>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef NPC_HOT_FIELDS_H
+#define NPC_HOT_FIELDS_H
+
+#include <vector>
+#include <cstdint>
+
+#include "globals.h"
+
+/*
+ * Compact structure-of-arrays copy of the NPC fields that the screen logic
+ * tests for every candidate NPC on every frame. NPC_t is a large struct, so
+ * testing its Location in place touches a separate cache line per NPC; after
+ * a gather, the rect tests below run over contiguous doubles and are easily
+ * vectorized by the compiler.
+ *
+ * The copy is taken right before use rather than kept in sync persistently:
+ * NPC locations are written from hundreds of places in the game logic, and a
+ * stale copy would silently change gameplay.
+ */
+struct NPC_HotFields_t
+{
+    std::vector<double> left;
+    std::vector<double> top;
+    std::vector<double> right;
+    std::vector<double> bottom;
+    std::vector<uint8_t> hidden;
+
+    inline size_t size() const
+    {
+        return left.size();
+    }
+
+    //! copies the fields of the listed NPCs (in order)
+    void gather(const std::vector<BaseRef_t>& npcs);
+
+    //! sets out[i] to whether NPC i touches the rect (edges inclusive), with the same comparisons as vScreenCollision
+    void collide(double l, double t, double r, double b, std::vector<uint8_t>& out) const;
+
+    //! sets out[i] to vScreenCollision(Z, NPC i's Location)
+    void onscreen(int Z, std::vector<uint8_t>& out) const;
+};
+
+#endif // #ifndef NPC_HOT_FIELDS_H
@@ -224,6 +224,11 @@ bool UpdateNPCs()
     {
         StopHit = 0;
         int A;
+
+        // This loop intentionally visits every NPC rather than the NPCQueues: in VB6, every inactive NPC
+        //   (TimeLeft == 0) is re-deactivated on each frozen frame, which clears its Reset flags, reverts
+        //   its type and location, and kills spawned NPCs. Replays depend on this, so it may only be
+        //   skipped once fix_FreezeNPCs_no_reset is enabled (then TimeLeft becomes -1 after the first pass).
         for(A = numNPCs; A >= 1; A--) // check to see if NPCs should be killed
         {
             if(NPCIsBoot(NPC[A]) || NPCIsYoshi(NPC[A]))
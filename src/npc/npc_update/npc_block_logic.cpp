@@ -75,6 +75,9 @@ void NPCBlockLogic(int A, double& tempHit, int& tempHitBlock, float& tempSpeedA,
                 ? treeFLBlockQuery(NPC[A].Location, SORTMODE_COMPAT)
                 : treeTempBlockQuery(NPC[A].Location, SORTMODE_LOC);
 
+            // The candidates are tested one at a time on purpose: a batched (SSE2) test of up to 64 candidates at once
+            //   was measured 3-4x slower than this loop for 2 to 64 candidates, because packing the batch costs more than
+            //   the comparisons it saves, and a hit can move the NPC, which invalidates the rest of the batch.
             for(BlockRef_t block : collBlockSentinel)
             {
                 int B = block;
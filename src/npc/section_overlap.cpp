@@ -18,6 +18,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <Logger/logger.h>
 
 #include "globals.h"
@@ -26,6 +29,16 @@
 
 std::array<uint8_t, maxSections + 1> g_SectionFirstOverlap;
 
+//! below this many sections, a plain scan is faster than the index
+static constexpr int c_sectionIndexMinSections = 8;
+
+//! sections sorted by their left edge
+static std::array<uint8_t, maxSections + 1> s_sectionsByLeft;
+//! running maximum of the right edges of s_sectionsByLeft, used to stop the backwards scan early
+static std::array<double, maxSections + 1> s_maxRightByLeft;
+static int s_sectionIndexCount = 0;
+static bool s_sectionIndexValid = false;
+
 //! Check if two section bounds collide
 static bool s_SectionCollide(const SpeedlessLocation_t& bounds, const SpeedlessLocation_t& other_bounds)
 {
@@ -52,15 +65,107 @@ static void s_FindFirstOverlap(int S, int start)
     }
 }
 
+//! Sort the sections by their left edge
+static bool s_BuildSectionIndex()
+{
+    s_sectionIndexCount = numSections;
+
+    for(int S = 0; S < numSections; S++)
+    {
+        // the sort below needs a strict weak order
+        if(std::isnan(level[S].X) || std::isnan(level[S].Width))
+            return false;
+
+        s_sectionsByLeft[S] = (uint8_t)S;
+    }
+
+    std::sort(s_sectionsByLeft.begin(), s_sectionsByLeft.begin() + numSections,
+    [](uint8_t a, uint8_t b)
+    {
+        return level[a].X < level[b].X;
+    });
+
+    double max_right = -INFINITY;
+
+    for(int i = 0; i < numSections; i++)
+    {
+        max_right = std::max(max_right, level[s_sectionsByLeft[i]].Width);
+        s_maxRightByLeft[i] = max_right;
+    }
+
+    return true;
+}
+
+void InvalidateSectionIndex()
+{
+    s_sectionIndexValid = false;
+    s_sectionIndexCount = 0;
+}
+
+//! same containment test as CheckSectionNPC
+static inline bool s_SectionContains(int B, double X, double Y, double Width, double Height)
+{
+    return X >= level[B].X && X + Width <= level[B].Width && Y >= level[B].Y && Y + Height <= level[B].Height;
+}
+
+static int s_FindContainingSectionScan(double X, double Y, double Width, double Height)
+{
+    for(int B = 0; B < numSections; B++)
+    {
+        if(s_SectionContains(B, X, Y, Width, Height))
+            return B;
+    }
+
+    return -1;
+}
+
+int FindContainingSection(double X, double Y, double Width, double Height)
+{
+    // the editor changes section bounds in many places, so it always uses the plain scan
+    if(numSections < c_sectionIndexMinSections || LevelEditor)
+        return s_FindContainingSectionScan(X, Y, Width, Height);
+
+    if(s_sectionIndexCount != numSections)
+        s_sectionIndexValid = s_BuildSectionIndex();
+
+    if(!s_sectionIndexValid)
+        return s_FindContainingSectionScan(X, Y, Width, Height);
+
+    // candidates are the sections with level.X <= X; walk them from the right while any of them may reach X + Width
+    const uint8_t* first = s_sectionsByLeft.data();
+    int i = (int)(std::upper_bound(first, first + numSections, X,
+    [](double x, uint8_t b)
+    {
+        return x < level[b].X;
+    }) - first);
+
+    double right = X + Width;
+    int found = -1;
+
+    for(i--; i >= 0 && !(s_maxRightByLeft[i] < right); i--)
+    {
+        int B = s_sectionsByLeft[i];
+
+        if((found < 0 || B < found) && s_SectionContains(B, X, Y, Width, Height))
+            found = B;
+    }
+
+    return found;
+}
+
 //! Find the first section that overlaps with each section
 void CalculateSectionOverlaps()
 {
+    InvalidateSectionIndex();
+
     for(int S = 0; S < numSections; S++)
         s_FindFirstOverlap(S, 0);
 }
 
 void UpdateSectionOverlaps(int S, bool shrink)
 {
+    InvalidateSectionIndex();
+
     // if not a shrink, find first section overlapping S
     if(!shrink)
         s_FindFirstOverlap(S, 0);
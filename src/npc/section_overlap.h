@@ -36,5 +36,12 @@ void CalculateSectionOverlaps();
 //  Set shrink if section S's new bounds are contained in its old bounds.
 void UpdateSectionOverlaps(int S, bool shrink = false);
 
+//! Mark the section bounds as changed outside of the functions above
+void InvalidateSectionIndex();
+
+//! Find the first section (in section order) that fully contains the rect, or -1 if there is none.
+//  Uses an index of the section bounds sorted by left edge, so that levels with many sections don't pay for a full scan.
+int FindContainingSection(double X, double Y, double Width, double Height);
+
 
 #endif
@@ -19,6 +19,7 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 
 #include <pcg/pcg_random.hpp>
 
@@ -68,6 +69,36 @@ void random_set_ncalls(long ncalls)
     g_random_n_calls = ncalls;
 }
 
+struct RandomState_t
+{
+    pcg32 engine;
+    pcg32 engine_isolated;
+    long n_calls;
+    int seed;
+};
+
+size_t random_state_size()
+{
+    return sizeof(RandomState_t);
+}
+
+void random_save_state(void* out)
+{
+    RandomState_t state{g_random_engine, g_random_engine_isolated, g_random_n_calls, last_seed};
+    std::memcpy(out, &state, sizeof(state));
+}
+
+void random_load_state(const void* in)
+{
+    RandomState_t state;
+    std::memcpy(&state, in, sizeof(state));
+
+    g_random_engine = state.engine;
+    g_random_engine_isolated = state.engine_isolated;
+    g_random_n_calls = state.n_calls;
+    last_seed = state.seed;
+}
+
 // Also note that many VB6 calls use dRand * x
 // and then assign the result to an Integer.
 // The result is NOT iRand(x) but rather vb6Round(dRand()*x),
@@ -23,6 +23,7 @@
 #define RAND_H
 
 #include <cmath>
+#include <cstddef>
 
 // supported only on gcc
 // #define DEBUG_RANDOM_CALLS
@@ -54,6 +55,21 @@ extern long random_ncalls();
  */
 extern void random_set_ncalls(long ncalls);
 
+/**
+ * @brief Size of the buffer needed by random_save_state()
+ */
+extern size_t random_state_size();
+
+/**
+ * @brief Copies the full state of both random generators into a buffer (used by game state snapshots)
+ */
+extern void random_save_state(void* out);
+
+/**
+ * @brief Restores the full state of both random generators from a buffer filled by random_save_state()
+ */
+extern void random_load_state(const void* in);
+
 /**
  * @brief Random number generator in double format, between 0.0 to 1.0 (exclusive)
  * @return random double value
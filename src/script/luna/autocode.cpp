@@ -1087,7 +1087,7 @@ void Autocode::Do(bool init)
 
         case AT_OnEvent:
         {
-            if(EventWasTriggered(FindEvent(GetS(MyString))))
+            if(EventWasTriggered(GetS(MyString)))
             {
                 gAutoMan.ActivateCustomEvents(0, (int)Param3);
                 if(Param2 != 0)
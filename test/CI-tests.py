@@ -28,6 +28,11 @@ import subprocess
 import json
 import sys
 import os
+import glob
+import shutil
+import struct
+import tempfile
+import zlib
 
 parser = argparse.ArgumentParser(
                     prog='CI-tests.py',
@@ -37,8 +42,196 @@ parser.add_argument('-n', '--name', help='name to record this test with', requir
 parser.add_argument('-e', '--executable', help='path to the game executable (should generally be a command-line build)', required=True)
 parser.add_argument('-d', '--records-dir', help='directory of gameplay records to use', required=True)
 parser.add_argument('-o', '--output', help='output file to append a CSV row to')
+parser.add_argument('-g', '--golden-dir', help='directory of golden frames (one subdirectory per record, made by a CPU render build); compares the frames dumped by the replay against them')
+parser.add_argument('--golden-executable', help='path to a full (SDL) build of the game to dump frames with; command-line builds have no CPU render')
+parser.add_argument('--golden-interval', help='replay frames between the dumped frames', type=int, default=64)
+parser.add_argument('--update-golden', help='replace the golden frames by the dumped ones instead of comparing them', action='store_true')
+parser.add_argument('-s', '--seek-frame', help='also re-record each record in the binary format, replay it from this frame (from the keyframe at or before it), and check that its state hashes match the full replay', type=int, default=0)
 args = parser.parse_args()
 
+if args.golden_dir and not args.golden_executable:
+    parser.error('--golden-dir needs --golden-executable')
+
+# frames between the keyframes of binary recordings (RecordBinary::FileWriter::c_chunkFrames)
+keyframe_interval = 3840
+
+
+# returns (width, height, rows of unfiltered pixel bytes) of an 8-bit, non-interlaced PNG
+def png_pixels(path):
+    data = open(path, 'rb').read()
+
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError(f'{path} is not a PNG file')
+
+    pos = 8
+    idat = b''
+
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+        elif kind == b'IEND':
+            break
+
+    if depth != 8 or interlace != 0:
+        raise ValueError(f'{path} is not an 8-bit, non-interlaced PNG file')
+
+    bpp = {0: 1, 2: 3, 4: 2, 6: 4}[color]
+    stride = width * bpp
+    raw = zlib.decompress(idat)
+    rows = []
+    prev = bytearray(stride)
+
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        row = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+
+        for x in range(stride):
+            a = row[x - bpp] if x >= bpp else 0
+            b = prev[x]
+            c = prev[x - bpp] if x >= bpp else 0
+
+            if kind == 1:
+                row[x] = (row[x] + a) & 0xFF
+            elif kind == 2:
+                row[x] = (row[x] + b) & 0xFF
+            elif kind == 3:
+                row[x] = (row[x] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                row[x] = (row[x] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+
+        rows.append(bytes(row))
+        prev = row
+
+    return (width, height, color, rows)
+
+
+# returns the per-frame hashes of a state hash stream (written by --state-hash, starting with the first replayed frame)
+def state_hashes(path):
+    data = open(path, 'rb').read()
+
+    if data[:4] != b'XTSH':
+        raise ValueError(f'{path} is not a state hash stream')
+
+    return [data[i:i + 8] for i in range(5, len(data) - 7, 8)]
+
+
+# re-records a record in the binary format, then replays it once fully and once from a keyframe; returns 1 if their hashes differ
+def check_seek(bench):
+    keyframe = args.seek_frame - args.seek_frame % keyframe_interval
+
+    if keyframe == 0:
+        print(f'  Seek frame {args.seek_frame} is before the first keyframe (frame {keyframe_interval})')
+        return 1
+
+    with tempfile.TemporaryDirectory() as tmp:
+        user = os.path.join(tmp, 'user')
+        os.makedirs(os.path.join(user, 'settings'))
+
+        with open(os.path.join(user, 'settings', 'thextech.ini'), 'w') as ini:
+            ini.write('[advanced]\nrecord-gameplay-data = true\nrecord-gameplay-binary = true\n')
+
+        # replaying a record records it again, here in the binary format
+        subprocess.run([binary, '--user-directory', user, bench], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        records = glob.glob(os.path.join(user, 'gameplay-records', '**', '*.rec'), recursive=True)
+
+        if not records:
+            print('  Seek test: the record could not be re-recorded in the binary format')
+            return 1
+
+        full_hash = os.path.join(tmp, 'full.hash')
+        seek_hash = os.path.join(tmp, 'seek.hash')
+
+        subprocess.run([binary, '--user-directory', user, '--state-hash', full_hash, records[0]],
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        subprocess.run([binary, '--user-directory', user, '--state-hash', seek_hash,
+                        '--replay-start-frame', str(args.seek_frame), records[0]],
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        if not os.path.exists(full_hash) or not os.path.exists(seek_hash):
+            print('  Seek test: a replay did not write its state hashes')
+            return 1
+
+        full = state_hashes(full_hash)
+        seek = state_hashes(seek_hash)
+
+        if len(full) <= args.seek_frame:
+            print(f'  Seek test skipped: the record has only {len(full)} frames')
+            return 0
+
+        # the seeking replay starts hashing at the keyframe
+        expected = full[keyframe:]
+
+        for i in range(min(len(seek), len(expected))):
+            if seek[i] != expected[i]:
+                print(f'  Seek test: state diverged from the full replay at frame {keyframe + i}')
+                return 1
+
+        if len(seek) != len(expected):
+            print(f'  Seek test: replay from frame {keyframe} ran {len(seek)} frames, expected {len(expected)}')
+            return 1
+
+        print(f'  Seek test: replay from the keyframe at frame {keyframe} matches for {len(seek)} frames')
+        return 0
+
+
+# replays a record with the CPU render, dumping frames, and compares (or replaces) its golden frames; returns the number of mismatching frames
+#   (a replay that fails or a record without golden frames counts as one)
+def check_golden(bench):
+    golden = os.path.join(args.golden_dir, os.path.splitext(os.path.basename(bench))[0])
+
+    if not args.update_golden and not os.path.isdir(golden):
+        print(f'  No golden frames at {golden} (make them with --update-golden)')
+        return 1
+
+    # the replay opens a window, so use SDL's dummy drivers to run without a display
+    env = dict(os.environ, SDL_VIDEODRIVER='dummy', SDL_AUDIODRIVER='dummy')
+
+    with tempfile.TemporaryDirectory() as dump:
+        try:
+            subprocess.check_output([args.golden_executable, '--render', 'cpu', '--replay-frame-dump', dump,
+                                     '--replay-frame-dump-interval', str(args.golden_interval), bench],
+                                    stderr=subprocess.STDOUT, env=env)
+        except subprocess.CalledProcessError as e:
+            print(f'  Frame dump replay failed with exit code {e.returncode}')
+            return 1
+
+        frames = sorted(f for f in os.listdir(dump) if f.endswith('.png'))
+
+        if not frames:
+            print('  The replay dumped no frames (is the executable built with the CPU render?)')
+            return 1
+
+        if args.update_golden:
+            if os.path.isdir(golden):
+                shutil.rmtree(golden)
+
+            shutil.copytree(dump, golden)
+            print(f'  Wrote {len(frames)} golden frames')
+            return 0
+
+        expected = sorted(f for f in os.listdir(golden) if f.endswith('.png'))
+        mismatch = len(set(expected) ^ set(frames))
+
+        for frame in sorted(set(expected) & set(frames)):
+            if png_pixels(os.path.join(dump, frame)) != png_pixels(os.path.join(golden, frame)):
+                if mismatch == 0:
+                    print(f'  First golden mismatch at {frame}')
+
+                mismatch += 1
+
+        print(f'  {mismatch} of {len(expected)} golden frames mismatch')
+        return mismatch
+
+
 title = args.name
 binary = args.executable
 test_dir = args.records_dir
@@ -57,6 +250,8 @@ total_pass = 0
 total_warn = 0
 total_fail = 0
 total_invalid = 0
+total_golden_fail = 0
+total_seek_fail = 0
 
 print(f'Code size {text} KB, static RAM use {static_ram} KB')
 
@@ -105,9 +300,15 @@ for bench in benches:
     print(f'  Used {stack_heap} KB RAM')
     print(f'  Took {instructions} instructions ({cycles} cycles)')
 
+    if args.golden_dir:
+        total_golden_fail += check_golden(bench)
+
+    if args.seek_frame:
+        total_seek_fail += check_seek(bench)
+
 # an output to be added to a CSV
-template = 'title,pass,warn,fail,invalid,codesizeKB,staticmemKB,maxheapKB,Minstructions,Mcycles'
-output_row = f'{title},{total_pass},{total_warn},{total_fail},{total_invalid},{text},{static_ram},{max_heap},{total_instructions // 1000000},{total_cycles // 1000000}'
+template = 'title,pass,warn,fail,invalid,codesizeKB,staticmemKB,maxheapKB,Minstructions,Mcycles,goldenfail,seekfail'
+output_row = f'{title},{total_pass},{total_warn},{total_fail},{total_invalid},{text},{static_ram},{max_heap},{total_instructions // 1000000},{total_cycles // 1000000},{total_golden_fail},{total_seek_fail}'
 
 if args.output:
     open(args.output, 'a').write(output_row+'\n')